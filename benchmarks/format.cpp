@@ -0,0 +1,61 @@
+#include <fallible/error/format.hpp>
+#include <fallible/result/make.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+#include <string>
+
+using fallible::Error;
+
+using namespace std::chrono_literals;
+
+//////////////////////////////////////////////////////////////////////
+
+static Error MakeError() {
+  Error cause = fallible::errors::Unavailable()
+                    .Domain("Rpc")
+                    .Reason("peer {} down", "10.0.0.17")
+                    .Attr("elapsed", 150ms)
+                    .Done();
+  return fallible::Wrap(cause)
+      .Domain("Storage")
+      .Reason("Replication failed")
+      .Attr("shard", 17)
+      .Done();
+}
+
+static void BM_Describe(benchmark::State& state) {
+  Error error = MakeError();
+  for (auto _ : state) {
+    std::string description = error.Describe();
+    benchmark::DoNotOptimize(description);
+  }
+}
+
+BENCHMARK(BM_Describe);
+
+// Buffer is reused across log lines
+static void BM_WriteJson(benchmark::State& state) {
+  Error error = MakeError();
+  fmt::memory_buffer out;
+  for (auto _ : state) {
+    out.clear();
+    fallible::WriteJson(out, error);
+    benchmark::DoNotOptimize(out.data());
+  }
+}
+
+BENCHMARK(BM_WriteJson);
+
+static void BM_WriteLogfmt(benchmark::State& state) {
+  Error error = MakeError();
+  fmt::memory_buffer out;
+  for (auto _ : state) {
+    out.clear();
+    fallible::WriteLogfmt(out, error);
+    benchmark::DoNotOptimize(out.data());
+  }
+}
+
+BENCHMARK(BM_WriteLogfmt);
@@ -0,0 +1,128 @@
+#include <fallible/result/result.hpp>
+#include <fallible/result/make.hpp>
+#include <fallible/support/confined.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <cerrno>
+
+using fallible::Error;
+using fallible::Result;
+
+//////////////////////////////////////////////////////////////////////
+
+static const size_t kDepth = 10;
+
+// Leaf copies a prebuilt error: propagation cost only
+
+[[gnu::noinline]] static Result<int> Call(size_t depth, const Error& error) {
+  if (depth == 0) {
+    return fallible::Fail(error);
+  }
+  auto result = Call(depth - 1, error);
+  if (result.Failed()) {
+    return fallible::PropagateError(result);
+  }
+  return fallible::Ok(*result + 1);
+}
+
+static void Propagate(benchmark::State& state, const Error& error) {
+  for (auto _ : state) {
+    auto result = Call(kDepth, error);
+    benchmark::DoNotOptimize(result);
+  }
+  state.SetItemsProcessed(state.iterations() * kDepth);
+}
+
+//////////////////////////////////////////////////////////////////////
+
+// Code-only error: no reference counting at all
+static void BM_PropagateCodeOnly(benchmark::State& state) {
+  Error error = fallible::errors::Unavailable();
+  Propagate(state, error);
+}
+
+BENCHMARK(BM_PropagateCodeOnly);
+
+// Payload with atomic reference counting
+static void BM_PropagateShared(benchmark::State& state) {
+  Error error = fallible::errors::Unavailable()
+                    .Domain("Rpc")
+                    .Reason("peer down")
+                    .Done();
+  Propagate(state, error);
+}
+
+BENCHMARK(BM_PropagateShared);
+BENCHMARK(BM_PropagateShared)->Threads(4);
+
+// Payload with thread-local reference counting
+static void BM_PropagateThreadLocal(benchmark::State& state) {
+  fallible::ThreadConfinedScope confined;
+
+  Error error = fallible::errors::Unavailable()
+                    .Domain("Rpc")
+                    .Reason("peer down")
+                    .Done();
+  Propagate(state, error);
+}
+
+BENCHMARK(BM_PropagateThreadLocal);
+BENCHMARK(BM_PropagateThreadLocal)->Threads(4);
+
+// Single error shared by all threads: cache-line bouncing
+static void BM_PropagateSingleton(benchmark::State& state) {
+  static const Error kError = fallible::errors::Unavailable()
+                                  .Domain("Rpc")
+                                  .Reason("peer down")
+                                  .Done();
+  Propagate(state, kError);
+}
+
+BENCHMARK(BM_PropagateSingleton)->Threads(4);
+
+// Immortal flyweight shared by all threads: no reference counting
+static void BM_PropagateStatic(benchmark::State& state) {
+  static const auto kError = fallible::StaticError(
+      fallible::ErrorCodes::Unavailable, "Rpc", "peer down");
+  Propagate(state, kError);
+}
+
+BENCHMARK(BM_PropagateStatic)->Threads(4);
+
+// Payload wrapped with a frame at every layer
+[[gnu::noinline]] static Result<int> WrappingCall(size_t depth, const Error& error) {
+  if (depth == 0) {
+    return fallible::Fail(error);
+  }
+  auto result = WrappingCall(depth - 1, error);
+  if (result.Failed()) {
+    return fallible::Fail(fallible::WrapError(result).Reason("Layer"));
+  }
+  return fallible::Ok(*result + 1);
+}
+
+static void BM_PropagateWrapped(benchmark::State& state) {
+  Error error = fallible::errors::Unavailable()
+                    .Domain("Rpc")
+                    .Reason("peer down")
+                    .Done();
+
+  for (auto _ : state) {
+    auto result = WrappingCall(kDepth, error);
+    benchmark::DoNotOptimize(result);
+  }
+  state.SetItemsProcessed(state.iterations() * kDepth);
+}
+
+BENCHMARK(BM_PropagateWrapped);
+
+// I/O failure path: message() is not rendered unless asked for
+static void BM_ErrnoError(benchmark::State& state) {
+  for (auto _ : state) {
+    Error error = fallible::Err(fallible::FromErrno{EAGAIN}).Done();
+    benchmark::DoNotOptimize(error);
+  }
+}
+
+BENCHMARK(BM_ErrnoError);
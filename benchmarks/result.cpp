@@ -0,0 +1,158 @@
+#include <fallible/result/result.hpp>
+#include <fallible/result/make.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+using fallible::Result;
+
+//////////////////////////////////////////////////////////////////////
+
+static const std::string kPayload = "Long enough to avoid small string optimization";
+
+static Result<std::string> MakeResult(size_t i) {
+  if (i % 8 == 0) {
+    return fallible::Fail(fallible::errors::Unavailable());
+  } else {
+    return fallible::Ok(kPayload);
+  }
+}
+
+// Result with potentially throwing move:
+// std::vector copies such elements on reallocation
+
+struct ThrowingMove {
+  explicit ThrowingMove(Result<std::string> r)
+      : result(std::move(r)) {
+  }
+
+  ThrowingMove(const ThrowingMove&) = default;
+
+  ThrowingMove(ThrowingMove&& that) noexcept(false)
+      : result(std::move(that.result)) {
+  }
+
+  Result<std::string> result;
+};
+
+//////////////////////////////////////////////////////////////////////
+
+static void BM_VectorGrowth(benchmark::State& state) {
+  const size_t count = state.range(0);
+
+  for (auto _ : state) {
+    std::vector<Result<std::string>> results;
+    for (size_t i = 0; i < count; ++i) {
+      results.push_back(MakeResult(i));
+    }
+    benchmark::DoNotOptimize(results.data());
+  }
+
+  state.SetItemsProcessed(state.iterations() * count);
+}
+
+BENCHMARK(BM_VectorGrowth)->Range(1 << 6, 1 << 14);
+
+static void BM_VectorGrowthThrowingMove(benchmark::State& state) {
+  const size_t count = state.range(0);
+
+  for (auto _ : state) {
+    std::vector<ThrowingMove> results;
+    for (size_t i = 0; i < count; ++i) {
+      results.emplace_back(MakeResult(i));
+    }
+    benchmark::DoNotOptimize(results.data());
+  }
+
+  state.SetItemsProcessed(state.iterations() * count);
+}
+
+BENCHMARK(BM_VectorGrowthThrowingMove)->Range(1 << 6, 1 << 14);
+
+//////////////////////////////////////////////////////////////////////
+
+// Growable buffer that relocates elements with fallible::Relocate
+
+template <typename T>
+class RelocatingBuffer {
+ public:
+  ~RelocatingBuffer() {
+    for (size_t i = 0; i < size_; ++i) {
+      data_[i].~T();
+    }
+    std::free(data_);
+  }
+
+  void PushBack(T value) {
+    if (size_ == capacity_) {
+      Grow();
+    }
+    new (data_ + size_) T(std::move(value));
+    ++size_;
+  }
+
+  T* Data() {
+    return data_;
+  }
+
+ private:
+  void Grow() {
+    size_t capacity = capacity_ == 0 ? 4 : capacity_ * 2;
+    T* data = static_cast<T*>(std::malloc(capacity * sizeof(T)));
+    fallible::Relocate(data_, size_, data);
+    std::free(data_);
+    data_ = data;
+    capacity_ = capacity;
+  }
+
+ private:
+  T* data_ = nullptr;
+  size_t size_ = 0;
+  size_t capacity_ = 0;
+};
+
+// Trivially relocatable, but not trivially copyable
+using PtrResult = Result<std::unique_ptr<int>>;
+
+static_assert(fallible::IsTriviallyRelocatable<PtrResult>::value);
+
+// Same type with relocation disabled
+struct MovedPtrResult {
+  PtrResult result;
+};
+
+static void BM_RelocatingGrowth(benchmark::State& state) {
+  const size_t count = state.range(0);
+
+  for (auto _ : state) {
+    RelocatingBuffer<PtrResult> results;
+    for (size_t i = 0; i < count; ++i) {
+      results.PushBack(fallible::Ok(std::unique_ptr<int>{}));
+    }
+    benchmark::DoNotOptimize(results.Data());
+  }
+
+  state.SetItemsProcessed(state.iterations() * count);
+}
+
+BENCHMARK(BM_RelocatingGrowth)->Range(1 << 6, 1 << 14);
+
+static void BM_MovingGrowth(benchmark::State& state) {
+  const size_t count = state.range(0);
+
+  for (auto _ : state) {
+    RelocatingBuffer<MovedPtrResult> results;
+    for (size_t i = 0; i < count; ++i) {
+      results.PushBack({fallible::Ok(std::unique_ptr<int>{})});
+    }
+    benchmark::DoNotOptimize(results.Data());
+  }
+
+  state.SetItemsProcessed(state.iterations() * count);
+}
+
+BENCHMARK(BM_MovingGrowth)->Range(1 << 6, 1 << 14);
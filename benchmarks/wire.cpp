@@ -0,0 +1,99 @@
+#include <fallible/wire/batch.hpp>
+#include <fallible/wire/codec.hpp>
+#include <fallible/result/make.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+#include <string>
+
+using fallible::Error;
+
+using namespace std::chrono_literals;
+
+//////////////////////////////////////////////////////////////////////
+
+static Error MakeError() {
+  Error cause = fallible::errors::Unavailable()
+                    .Domain("Rpc")
+                    .Reason("peer down")
+                    .Attr("peer", "10.0.0.17:8080")
+                    .Attr("elapsed", 150ms)
+                    .Done();
+  return fallible::Wrap(cause)
+      .Domain("Storage")
+      .Reason("Replication failed")
+      .Attr("shard", 17)
+      .Done();
+}
+
+static void BM_EncodeError(benchmark::State& state) {
+  Error error = MakeError();
+
+  std::string out;
+  for (auto _ : state) {
+    out.clear();
+    fallible::EncodeError(error, out);
+    benchmark::DoNotOptimize(out.data());
+  }
+  state.SetBytesProcessed(state.iterations() * out.size());
+}
+
+BENCHMARK(BM_EncodeError);
+
+// Zero-copy: strings share the buffer
+static void BM_DecodeError(benchmark::State& state) {
+  std::string bytes = fallible::EncodeError(MakeError());
+  auto buffer = fallible::SharedString::Copy(bytes);
+
+  for (auto _ : state) {
+    auto error = fallible::DecodeError(buffer);
+    benchmark::DoNotOptimize(error);
+  }
+  state.SetBytesProcessed(state.iterations() * bytes.size());
+}
+
+BENCHMARK(BM_DecodeError);
+
+// Batch of similar errors: dictionary-encoded strings and sites
+static void BM_EncodeBatch(benchmark::State& state) {
+  Error error = MakeError();
+
+  size_t bytes = 0;
+  for (auto _ : state) {
+    fallible::BatchEncoder encoder;
+    for (int64_t i = 0; i < state.range(0); ++i) {
+      encoder.Append(error);
+    }
+    bytes = encoder.TakeBytes().size();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  state.counters["bytes_per_error"] = static_cast<double>(bytes) / state.range(0);
+}
+
+BENCHMARK(BM_EncodeBatch)->Arg(1000);
+
+static void BM_DecodeBatch(benchmark::State& state) {
+  Error error = MakeError();
+
+  fallible::BatchEncoder encoder;
+  for (int64_t i = 0; i < state.range(0); ++i) {
+    encoder.Append(error);
+  }
+  std::string bytes = encoder.TakeBytes();
+
+  for (auto _ : state) {
+    fallible::BatchDecoder decoder;
+    decoder.Feed(bytes);
+    while (true) {
+      auto item = decoder.Next();
+      if (item.Failed() || !*item) {
+        break;
+      }
+      benchmark::DoNotOptimize(item);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_DecodeBatch)->Arg(1000);
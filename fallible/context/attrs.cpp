@@ -0,0 +1,177 @@
+#include <fallible/context/attrs.hpp>
+
+#include <fmt/format.h>
+
+#include <ostream>
+#include <string>
+
+namespace fallible {
+
+//////////////////////////////////////////////////////////////////////
+
+std::optional<std::string_view> AttrValue::AsString() const {
+  if (auto* str = std::get_if<SharedString>(&value_)) {
+    return str->View();
+  }
+  return std::nullopt;
+}
+
+std::optional<int64_t> AttrValue::AsInt() const {
+  if (auto* value = std::get_if<int64_t>(&value_)) {
+    return *value;
+  }
+  if (auto* value = std::get_if<uint64_t>(&value_)) {
+    if (*value <= static_cast<uint64_t>(INT64_MAX)) {
+      return static_cast<int64_t>(*value);
+    }
+  }
+  return std::nullopt;
+}
+
+std::optional<uint64_t> AttrValue::AsUInt() const {
+  if (auto* value = std::get_if<uint64_t>(&value_)) {
+    return *value;
+  }
+  return std::nullopt;
+}
+
+std::optional<double> AttrValue::AsDouble() const {
+  if (auto* value = std::get_if<double>(&value_)) {
+    return *value;
+  }
+  return std::nullopt;
+}
+
+std::optional<std::chrono::nanoseconds> AttrValue::AsDuration() const {
+  if (auto* value = std::get_if<std::chrono::nanoseconds>(&value_)) {
+    return *value;
+  }
+  return std::nullopt;
+}
+
+std::optional<std::string_view> AttrValue::AsBlob() const {
+  if (auto* blob = std::get_if<BlobBytes>(&value_)) {
+    return blob->bytes.View();
+  }
+  return std::nullopt;
+}
+
+std::optional<bool> AttrValue::AsBool() const {
+  if (auto* value = std::get_if<bool>(&value_)) {
+    return *value;
+  }
+  return std::nullopt;
+}
+
+static void FormatDuration(std::chrono::nanoseconds value, fmt::memory_buffer& out) {
+  int64_t ns = value.count();
+  // Largest unit without losing precision
+  if (ns != 0 && ns % 1'000'000'000 == 0) {
+    fmt::format_to(fmt::appender(out), "{}s", ns / 1'000'000'000);
+  } else if (ns != 0 && ns % 1'000'000 == 0) {
+    fmt::format_to(fmt::appender(out), "{}ms", ns / 1'000'000);
+  } else if (ns != 0 && ns % 1'000 == 0) {
+    fmt::format_to(fmt::appender(out), "{}us", ns / 1'000);
+  } else {
+    fmt::format_to(fmt::appender(out), "{}ns", ns);
+  }
+}
+
+static void FormatBlob(std::string_view bytes, fmt::memory_buffer& out) {
+  static constexpr size_t kMaxBytes = 32;
+
+  out.append(std::string_view{"0x"});
+  for (size_t i = 0; i < bytes.size() && i < kMaxBytes; ++i) {
+    fmt::format_to(fmt::appender(out), "{:02x}", static_cast<uint8_t>(bytes[i]));
+  }
+  if (bytes.size() > kMaxBytes) {
+    fmt::format_to(fmt::appender(out), "... ({} bytes)", bytes.size());
+  }
+}
+
+std::string AttrValue::Format() const {
+  if (auto* str = std::get_if<SharedString>(&value_)) {
+    return str->ToString();
+  }
+  fmt::memory_buffer out;
+  FormatTo(out);
+  return fmt::to_string(out);
+}
+
+void AttrValue::FormatTo(fmt::memory_buffer& out) const {
+  switch (Kind()) {
+    case AttrKind::String:
+      out.append(std::get<SharedString>(value_).View());
+      break;
+    case AttrKind::Int:
+      fmt::format_to(fmt::appender(out), "{}", std::get<int64_t>(value_));
+      break;
+    case AttrKind::UInt:
+      fmt::format_to(fmt::appender(out), "{}", std::get<uint64_t>(value_));
+      break;
+    case AttrKind::Double:
+      fmt::format_to(fmt::appender(out), "{}", std::get<double>(value_));
+      break;
+    case AttrKind::Duration:
+      FormatDuration(std::get<std::chrono::nanoseconds>(value_), out);
+      break;
+    case AttrKind::Blob:
+      FormatBlob(std::get<BlobBytes>(value_).bytes.View(), out);
+      break;
+    case AttrKind::Bool:
+      out.append(std::string_view{std::get<bool>(value_) ? "true" : "false"});
+      break;
+  }
+}
+
+AttrValue AttrValue::Detach() const {
+  AttrValue copy{*this};
+  if (auto* str = std::get_if<SharedString>(&copy.value_)) {
+    *str = str->Detach();
+  } else if (auto* blob = std::get_if<BlobBytes>(&copy.value_)) {
+    blob->bytes = blob->bytes.Detach();
+  }
+  return copy;
+}
+
+std::ostream& operator<<(std::ostream& out, const AttrValue& value) {
+  return out << value.Format();
+}
+
+//////////////////////////////////////////////////////////////////////
+
+const Attr* Attrs::LowerBound(std::string_view name) const {
+  // Linear scan beats binary search for a handful of attributes
+  const Attr* it = begin();
+  while (it != end() && it->key.Name() < name) {
+    ++it;
+  }
+  return it;
+}
+
+const AttrValue* Attrs::Find(std::string_view name) const {
+  const Attr* it = LowerBound(name);
+  if (it != end() && it->key.Name() == name) {
+    return &it->value;
+  }
+  return nullptr;
+}
+
+void Attrs::Set(AttrKey key, AttrValue value) {
+  const Attr* it = LowerBound(key.Name());
+  if (it != end() && it->key == key) {
+    attrs_[it - begin()].value = std::move(value);
+  } else {
+    attrs_.Insert(it, Attr{std::move(key), std::move(value)});
+  }
+}
+
+Attrs Attrs::Detach() const {
+  Attrs copy;
+  for (const auto& attr : attrs_) {
+    copy.attrs_.Insert(copy.attrs_.end(), Attr{attr.key.Detach(), attr.value.Detach()});
+  }
+  return copy;
+}
+
+}  // namespace fallible
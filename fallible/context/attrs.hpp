@@ -1,10 +1,247 @@
 #pragma once
 
-#include <map>
+#include <fallible/support/small_vector.hpp>
+#include <fallible/support/string.hpp>
+
+#include <fmt/format.h>
+
+#include <chrono>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <variant>
 
 namespace fallible {
 
-using Attrs = std::map<std::string, std::string>;
+//////////////////////////////////////////////////////////////////////
+
+// Attribute name
+// Literal names are borrowed, dynamic names are owned copies
+// released with the last error that refers to them
+
+class AttrKey {
+ public:
+  // Borrows literals, copies everything else
+  static AttrKey Intern(StringArg name) {
+    return AttrKey{name.ToShared()};
+  }
+
+  // Not interned: shares `name`, e.g. a view into a received buffer
+  static AttrKey Shared(SharedString name) {
+    return AttrKey{std::move(name)};
+  }
+
+  std::string_view Name() const {
+    return name_.View();
+  }
+
+  bool operator==(const AttrKey& that) const {
+    return Name() == that.Name();
+  }
+
+  // Copies arena-allocated names to the global heap
+  AttrKey Detach() const {
+    return AttrKey{name_.Detach()};
+  }
+
+ private:
+  explicit AttrKey(SharedString name)
+      : name_(std::move(name)) {
+  }
+
+ private:
+  SharedString name_;
+};
+
+//////////////////////////////////////////////////////////////////////
+
+// Small binary attribute value, copied into the context
+struct Blob {
+  std::string_view bytes;
+
+  static Blob Of(const void* data, size_t size) {
+    return {{static_cast<const char*>(data), size}};
+  }
+};
+
+enum class AttrKind {
+  String,
+  Int,
+  UInt,
+  Double,
+  Duration,
+  Blob,
+  Bool,
+};
+
+namespace detail {
+
+// Integers stored as Int / UInt: bool and character types are not numbers
+template <typename T>
+concept CharType = std::same_as<T, char> || std::same_as<T, wchar_t> ||
+                   std::same_as<T, char8_t> || std::same_as<T, char16_t> ||
+                   std::same_as<T, char32_t>;
+
+template <typename T>
+concept AttrInteger = std::integral<T> && !std::same_as<T, bool> && !CharType<T>;
+
+}  // namespace detail
+
+// Typed attribute value
+// Stored as is and formatted only on demand (Describe, exporters)
+
+class AttrValue {
+  struct BlobBytes {
+    SharedString bytes;
+  };
+
+ public:
+  AttrValue() = default;
+
+  explicit AttrValue(StringArg str)
+      : value_(str.ToShared()) {
+  }
+
+  // Shares `str`, e.g. a view into a received buffer
+  explicit AttrValue(SharedString str)
+      : value_(std::move(str)) {
+  }
+
+  static AttrValue SharedBlob(SharedString bytes) {
+    AttrValue blob;
+    blob.value_ = BlobBytes{std::move(bytes)};
+    return blob;
+  }
+
+  template <detail::AttrInteger I>
+  requires std::is_signed_v<I>
+  AttrValue(I value)  // NOLINT
+      : value_(static_cast<int64_t>(value)) {
+  }
+
+  template <detail::AttrInteger U>
+  requires std::is_unsigned_v<U>
+  AttrValue(U value)  // NOLINT
+      : value_(static_cast<uint64_t>(value)) {
+  }
+
+  // Template: pointers do not decay to bool
+  template <std::same_as<bool> B>
+  AttrValue(B value)  // NOLINT
+      : value_(static_cast<bool>(value)) {
+  }
+
+  template <std::floating_point F>
+  AttrValue(F value)  // NOLINT
+      : value_(static_cast<double>(value)) {
+  }
+
+  template <typename Rep, typename Period>
+  AttrValue(std::chrono::duration<Rep, Period> value)  // NOLINT
+      : value_(std::chrono::duration_cast<std::chrono::nanoseconds>(value)) {
+  }
+
+  AttrValue(Blob blob)  // NOLINT
+      : value_(BlobBytes{SharedString::Copy(blob.bytes)}) {
+  }
+
+  AttrKind Kind() const {
+    return static_cast<AttrKind>(value_.index());
+  }
+
+  // Typed accessors: std::nullopt if kind does not match
+
+  std::optional<std::string_view> AsString() const;
+  // Also accepts unsigned values that fit
+  std::optional<int64_t> AsInt() const;
+  std::optional<uint64_t> AsUInt() const;
+  std::optional<double> AsDouble() const;
+  std::optional<std::chrono::nanoseconds> AsDuration() const;
+  std::optional<std::string_view> AsBlob() const;
+  std::optional<bool> AsBool() const;
+
+  // Human-readable text, e.g. `17`, `0.5`, `150ms`, `0x0a1b`, `true`
+  std::string Format() const;
+  void FormatTo(fmt::memory_buffer& out) const;
+
+  // Copies arena-allocated strings to the global heap
+  AttrValue Detach() const;
+
+ private:
+  // Alternatives follow the order of AttrKind
+  std::variant<SharedString, int64_t, uint64_t, double,
+               std::chrono::nanoseconds, BlobBytes, bool>
+      value_;
+};
+
+std::ostream& operator<<(std::ostream& out, const AttrValue& value);
+
+//////////////////////////////////////////////////////////////////////
+
+struct Attr {
+  AttrKey key;
+  AttrValue value;
+};
+
+// Flat map: attributes sorted by name, first two are stored inline
+// Every context carries the inline slots, so they are kept few: most
+// errors carry one or two attributes, more spill to the heap
+
+class Attrs {
+  static constexpr size_t kInlineCapacity = 2;
+
+ public:
+  using Iterator = const Attr*;
+
+  size_t size() const {
+    return attrs_.size();
+  }
+
+  bool empty() const {
+    return attrs_.empty();
+  }
+
+  // Sorted by name
+  Iterator begin() const {
+    return attrs_.begin();
+  }
+
+  Iterator end() const {
+    return attrs_.end();
+  }
+
+  // nullptr if not found
+  const AttrValue* Find(std::string_view name) const;
+
+  bool Contains(std::string_view name) const {
+    return Find(name) != nullptr;
+  }
+
+  void Set(AttrKey key, AttrValue value);
+
+  void Set(StringArg name, AttrValue value) {
+    Set(AttrKey::Intern(name), std::move(value));
+  }
+
+  void Set(StringArg name, StringArg value) {
+    Set(AttrKey::Intern(name), AttrValue{value});
+  }
+
+  // Copies arena-allocated values to the global heap
+  Attrs Detach() const;
+
+ private:
+  // First attribute with name >= `name`
+  const Attr* LowerBound(std::string_view name) const;
+
+ private:
+  detail::SmallVector<Attr, kInlineCapacity> attrs_;
+};
 
 }  // namespace fallible
@@ -1,43 +1,180 @@
 #include <fallible/context/context.hpp>
 
+#include <fallible/context/data.hpp>
 #include <fallible/context/make.hpp>
 
+#include <memory>
+#include <utility>
+
 namespace fallible {
 
-struct Context::Data {
-  std::string reason;
-  std::string domain;
-  fallible::SourceLocation location;
-  fallible::Attrs attrs;
-};
+namespace detail {
+
+RemoteSite::RemoteSite(SharedString file_name, SharedString function_name, int line)
+    : file(std::move(file_name)),
+      function(std::move(function_name)),
+      info{0, file.View(), function.View(), line, "", CallSite::kNoCode,
+           SiteFingerprint(file.View(), function.View(), line), 0} {
+}
+
+ContextBuilder& ContextBuilder::Location(const SourceLocation& loc) {
+  remote_site_ = std::make_shared<const RemoteSite>(loc.SharedFile(), loc.SharedFunction(),
+                                                    loc.Line());
+  site_ = 0;
+  return *this;
+}
+
+void ContextBuilder::Fill(ContextData& data) {
+  data.reason = std::move(reason_);
+  data.domain = std::move(domain_);
+  data.domain_id = domain_id_;
+  data.site = Site();
+  data.remote_site = std::move(remote_site_);
+  data.attrs = std::move(attrs_);
+}
+
+void ContextData::CopyInto(ContextData& to) const {
+  to.reason = reason;
+  to.domain = domain;
+  to.domain_id = domain_id;
+  to.site = site;
+  to.remote_site = remote_site;
+  to.attrs = attrs;
+}
+
+void ContextData::DetachInto(ContextData& to) const {
+  to.reason = reason.Detach();
+  to.domain = domain.Detach();
+  to.domain_id = domain_id;
+  to.site = site;
+  if (remote_site) {
+    // Strings may live in the arena of the decoded buffer
+    to.remote_site = std::make_shared<const RemoteSite>(
+        remote_site->file.Detach(), remote_site->function.Detach(), remote_site->info.line);
+  }
+  to.attrs = attrs.Detach();
+}
+
+const SiteInfo* ContextData::Origin() const {
+  if (remote_site) {
+    return &remote_site->info;
+  }
+  return site != 0 ? &GetCallSite(site) : nullptr;
+}
+
+}  // namespace detail
+
+//////////////////////////////////////////////////////////////////////
 
 Context::Context(detail::ContextBuilder& builder) {
-  Data data{builder.reason_, builder.domain_, builder.location_, builder.attrs_};
-  data_ = std::make_shared<Data>(std::move(data));
+  data_ = detail::NewNode<detail::ContextData>();
+  builder.Fill(*data_);
+}
+
+Context::Context(detail::ContextData* data)
+    : data_(data) {
+  if (data_ != nullptr) {
+    data_->Ref();
+  }
+}
+
+Context::Context(const Context& that)
+    : Context(that.data_) {
+  site_ = that.site_;
+}
+
+Context::Context(Context&& that) noexcept
+    : data_(std::exchange(that.data_, nullptr)),
+      site_(that.site_) {
+}
+
+Context& Context::operator=(Context that) noexcept {
+  std::swap(data_, that.data_);
+  std::swap(site_, that.site_);
+  return *this;
+}
+
+Context::~Context() {
+  if (data_ != nullptr) {
+    Release(data_);
+  }
+}
+
+void Context::Release(detail::ContextData* data) {
+  if (data->Unref()) {
+    detail::DeleteNode(data);
+  }
 }
 
 std::string Context::Domain() const {
-  return data_->domain;
+  if (!data_) {
+    return std::string{GetCallSite(site_).domain};
+  }
+  if (!data_->domain.Empty()) {
+    return data_->domain.ToString();
+  }
+  return std::string{GetCallSite(data_->site).domain};
+}
+
+DomainId Context::DomainId() const {
+  if (!data_) {
+    return GetCallSite(site_).domain_id;
+  }
+  if (data_->domain_id != 0) {
+    return data_->domain_id;
+  }
+  return GetCallSite(data_->site).domain_id;
 }
 
 std::string Context::Reason() const {
-  return data_->reason;
+  return data_ ? data_->reason.ToString() : std::string{};
 }
 
 SourceLocation Context::SourceLocation() const {
-  return data_->location;
+  if (data_ && data_->remote_site) {
+    return data_->remote_site->Location();
+  }
+  return fallible::SourceLocation{GetCallSite(Site())};
+}
+
+SiteId Context::Site() const {
+  return data_ ? data_->site : site_;
 }
 
 const Attrs& Context::Attrs() const {
-  return data_->attrs;
+  static const fallible::Attrs kNoAttrs{};
+  return data_ ? data_->attrs : kNoAttrs;
+}
+
+void Context::Share() const {
+  if (data_ != nullptr) {
+    data_->Share();
+  }
+}
+
+bool Context::HasAttr(std::string_view key) const {
+  return data_ && data_->attrs.Contains(key);
+}
+
+void Context::AddAttr(StringArg key, StringArg value) {
+  AddAttr(key, AttrValue{value});
 }
 
-bool Context::HasAttr(const std::string& key) const {
-  return data_->attrs.contains(key);
+void Context::AddAttr(StringArg key, AttrValue value) {
+  MutableData().attrs.Set(key, std::move(value));
 }
 
-void Context::AddAttr(std::string key, std::string value) {
-  data_->attrs.insert_or_assign(std::move(key), std::move(value));
+detail::ContextData& Context::MutableData() {
+  if (data_ == nullptr) {
+    data_ = detail::NewNode<detail::ContextData>();
+    data_->site = site_;
+  } else if (!data_->IsUnique()) {
+    // Copy-on-write, other holders keep the original
+    auto* copy = detail::NewNode<detail::ContextData>();
+    data_->CopyInto(*copy);
+    Release(std::exchange(data_, copy));
+  }
+  return *data_;
 }
 
 }  // namespace fallible
@@ -1,33 +1,73 @@
 #pragma once
 
 #include <fallible/context/fwd.hpp>
+#include <fallible/context/domain.hpp>
 #include <fallible/context/location.hpp>
+#include <fallible/context/site.hpp>
 #include <fallible/context/attrs.hpp>
 
 #include <string>
-#include <memory>
+#include <string_view>
 
 namespace fallible {
 
+namespace detail {
+struct ContextData;
+struct ErrorWriter;
+}  // namespace detail
+
 class Context {
   friend class detail::ContextBuilder;
-
-  struct Data;
+  friend class Error;
+  friend struct detail::ErrorWriter;
 
  public:
+  Context(const Context& that);
+  Context(Context&& that) noexcept;
+  Context& operator=(Context that) noexcept;
+  ~Context();
+
+  // Explicit domain or default domain of the call site
   std::string Domain() const;
+  // See Error::DomainId
+  fallible::DomainId DomainId() const;
   std::string Reason() const;
   SourceLocation SourceLocation() const;
+  SiteId Site() const;
   const Attrs& Attrs() const;
 
-  bool HasAttr(const std::string& key) const;
-  void AddAttr(std::string key, std::string value);
+  // See Error::Share
+  void Share() const;
+
+  bool HasAttr(std::string_view key) const;
+  void AddAttr(StringArg key, StringArg value);
+  void AddAttr(StringArg key, AttrValue value);
 
  private:
   Context(detail::ContextBuilder&);
 
+  // Empty context of a code-only error
+  Context() = default;
+
+  // Code-only error with an origin: the site is resolved on demand,
+  // nothing is allocated until the first mutation
+  explicit Context(SiteId site)
+      : site_(site) {
+  }
+
+  // Shares payload of an error
+  explicit Context(detail::ContextData* data);
+
+  // Copy-on-write: copies shared data before the first mutation
+  detail::ContextData& MutableData();
+
+  static void Release(detail::ContextData* data);
+
  private:
-  std::shared_ptr<Data> data_;
+  // Intrusive, copy-on-write, see data.hpp
+  detail::ContextData* data_ = nullptr;
+  // Origin of a context without data
+  SiteId site_ = 0;
 };
 
 }  // namespace fallible
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <fallible/context/site.hpp>
+#include <fallible/context/attrs.hpp>
+#include <fallible/context/location.hpp>
+
+#include <fallible/support/arena.hpp>
+#include <fallible/support/lazy_string.hpp>
+#include <fallible/support/ref_counted.hpp>
+#include <fallible/support/string.hpp>
+
+#include <memory>
+
+namespace fallible {
+
+namespace detail {
+
+// Origin outside of the site registry, e.g. a decoded remote location
+// (see wire/codec.hpp): shares its strings instead of interning them
+struct RemoteSite {
+  RemoteSite(SharedString file, SharedString function, int line);
+
+  SharedString file;
+  SharedString function;
+  // Views `file` and `function`, id = 0
+  SiteInfo info;
+
+  fallible::SourceLocation Location() const {
+    return fallible::SourceLocation::Shared(file, function, info.line);
+  }
+};
+
+// Shared state of Context
+// Error payload extends it, so an error with context is a single allocation
+// Copy-on-write: shared data is immutable, mutators copy it unless unique
+
+struct ContextData : RefCounted {
+  // Rendered on demand, see ContextBuilder::Reason
+  LazyString reason;
+  SharedString domain;
+  // DomainIdOf(domain), 0 if empty
+  DomainId domain_id = 0;
+  // Origin, see site.hpp
+  SiteId site = 0;
+  // Set instead of `site` for origins outside of the registry
+  std::shared_ptr<const RemoteSite> remote_site;
+  fallible::Attrs attrs;
+
+  // nullptr = global heap, see support/arena.hpp
+  ErrorArena* arena = nullptr;
+
+  virtual ~ContextData() = default;
+
+  // Registered site or remote origin, nullptr if unknown
+  const SiteInfo* Origin() const;
+
+  // Shallow copy of the fields, strings are immutable and shared
+  void CopyInto(ContextData& to) const;
+
+  // Deep copy of the fields to the global heap
+  void DetachInto(ContextData& to) const;
+};
+
+}  // namespace detail
+
+}  // namespace fallible
@@ -0,0 +1,55 @@
+#include <fallible/context/domain.hpp>
+
+#include <wheels/core/panic.hpp>
+#include <wheels/core/singleton.hpp>
+
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+namespace fallible {
+
+//////////////////////////////////////////////////////////////////////
+
+class DomainRegistry {
+ public:
+  void Register(const ErrorDomain& domain) {
+    std::unique_lock guard(mutex_);
+
+    auto [it, inserted] = names_.try_emplace(domain.id, domain.name);
+    if (!inserted && it->second != domain.name) {
+      WHEELS_PANIC("Domain id collision: '" << it->second << "' and '"
+                                            << domain.name << "'");
+    }
+  }
+
+  std::optional<std::string_view> Find(DomainId id) const {
+    std::shared_lock guard(mutex_);
+
+    if (auto it = names_.find(id); it != names_.end()) {
+      return it->second;
+    }
+    return std::nullopt;
+  }
+
+ private:
+  mutable std::shared_mutex mutex_;
+  // Names of declared domains have static storage
+  std::unordered_map<DomainId, std::string_view> names_;
+};
+
+static DomainRegistry& Registry() {
+  return LeakySingleton<DomainRegistry>();
+}
+
+//////////////////////////////////////////////////////////////////////
+
+void RegisterDomain(const ErrorDomain& domain) {
+  Registry().Register(domain);
+}
+
+std::optional<std::string_view> FindDomainName(DomainId id) {
+  return Registry().Find(id);
+}
+
+}  // namespace fallible
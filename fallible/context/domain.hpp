@@ -0,0 +1,87 @@
+#pragma once
+
+#include <fallible/support/preprocessor.hpp>
+#include <fallible/support/string.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+namespace fallible {
+
+//////////////////////////////////////////////////////////////////////
+
+// Domain identifier: hash of the name, 0 = no domain
+// Computed at compile time for declared domains, so hot filters compare
+// integers instead of strings:
+//   if (error.DomainId() == kRpcDomain.id) { ... }
+
+using DomainId = uint32_t;
+
+// 32-bit FNV-1a, stable across processes and builds
+constexpr DomainId DomainIdOf(std::string_view name) {
+  if (name.empty()) {
+    return 0;
+  }
+  uint32_t hash = 2166136261u;
+  for (char c : name) {
+    hash ^= static_cast<uint8_t>(c);
+    hash *= 16777619u;
+  }
+  // 0 is reserved for "no domain"
+  return hash + (hash == 0);
+}
+
+//////////////////////////////////////////////////////////////////////
+
+// Compile-time domain declaration
+// Usage:
+//   inline constexpr fallible::ErrorDomain kRpcDomain{"Rpc"};
+//   FALLIBLE_REGISTER_DOMAIN(kRpcDomain);
+//
+//   Err(ErrorCodes::TimedOut).Domain(kRpcDomain)
+
+struct ErrorDomain {
+  std::string_view name;
+  DomainId id;
+
+  consteval ErrorDomain(Literal literal)  // NOLINT
+      : name(literal.View()), id(DomainIdOf(literal.View())) {
+  }
+
+  // .Domain("Rpc") hashes the literal at compile time
+  template <size_t N>
+  consteval ErrorDomain(const char (&str)[N])  // NOLINT
+      : ErrorDomain(Literal{str}) {
+  }
+};
+
+//////////////////////////////////////////////////////////////////////
+
+// Registered domains are resolvable by id
+// Registering a different name with the same id panics, so distinct
+// registered domains never compare equal
+// Unregistered (dynamic) domain names are not checked for collisions
+void RegisterDomain(const ErrorDomain& domain);
+
+// O(1)
+std::optional<std::string_view> FindDomainName(DomainId id);
+
+namespace detail {
+
+inline bool RegisterDomainAtStartup(const ErrorDomain& domain) {
+  RegisterDomain(domain);
+  return true;
+}
+
+}  // namespace detail
+
+}  // namespace fallible
+
+// At namespace scope, in a header or a source file
+// Any constant expression, e.g. a qualified name: rpc::kDomain
+// Registered by every translation unit that includes the header
+#define FALLIBLE_REGISTER_DOMAIN(domain)                                   \
+  [[maybe_unused]] static const bool FALLIBLE_UNIQUE_NAME(fallible_domain_) = \
+      ::fallible::detail::RegisterDomainAtStartup(domain)
@@ -1,47 +1,85 @@
 #pragma once
 
+#include <fallible/context/site.hpp>
+
+#include <fallible/support/string.hpp>
+
 #include <wheels/core/source_location.hpp>
 
+#include <string_view>
+#include <utility>
+
 namespace fallible {
 
 // NB: Can represent source location for another program
-// on remote server => Allocates memory for file and function names
+// on remote server => Owns file and function names in that case,
+// borrows static storage of compile-time locations otherwise
 
 //////////////////////////////////////////////////////////////////////
 
 class SourceLocation {
  public:
+  // Unknown location
+  SourceLocation()
+      : line_(0) {
+  }
+
   SourceLocation(wheels::SourceLocation loc)
-      : file_(loc.File()),
-        function_(loc.Function()),
+      : file_(SharedString::Borrow(loc.File())),
+        function_(SharedString::Borrow(loc.Function())),
         line_(loc.Line()) {
   }
 
-  SourceLocation(std::string file, std::string function, int line)
-      : file_(std::move(file)),
-        function_(std::move(function)),
-        line_(std::move(line)) {
+  SourceLocation(std::string_view file, std::string_view function, int line)
+      : file_(SharedString::Copy(file)),
+        function_(SharedString::Copy(function)),
+        line_(line) {
+  }
+
+  // Shares the strings, e.g. views into a received buffer
+  static SourceLocation Shared(SharedString file, SharedString function, int line) {
+    SourceLocation where;
+    where.file_ = std::move(file);
+    where.function_ = std::move(function);
+    where.line_ = line;
+    return where;
+  }
+
+  // Registered sites are immortal, strings are borrowed
+  explicit SourceLocation(const SiteInfo& site)
+      : file_(SharedString::Borrow(site.file)),
+        function_(SharedString::Borrow(site.function)),
+        line_(site.line) {
   }
 
   static SourceLocation Current() {
     return wheels::Here();
   }
 
-  const std::string& File() const {
-    return file_;
+  std::string_view File() const {
+    return file_.View();
   }
 
-  const std::string& Function() const {
-    return function_;
+  std::string_view Function() const {
+    return function_.View();
   }
 
   int Line() const {
     return line_;
   }
 
+  // Shares the strings, see detail::RemoteSite
+  const SharedString& SharedFile() const {
+    return file_;
+  }
+
+  const SharedString& SharedFunction() const {
+    return function_;
+  }
+
  private:
-  std::string file_;
-  std::string function_;
+  SharedString file_;
+  SharedString function_;
   int line_;
 };
 
@@ -1,11 +1,63 @@
 #pragma once
 
 #include <fallible/context/context.hpp>
+#include <fallible/context/domain.hpp>
+#include <fallible/context/site.hpp>
+
+#include <fallible/support/lazy_string.hpp>
+#include <fallible/support/string.hpp>
+
+#include <fmt/compile.h>
+#include <fmt/format.h>
+
+#include <concepts>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <type_traits>
+
 
 namespace fallible {
 
 namespace detail {
 
+struct ContextData;
+struct RemoteSite;
+
+//////////////////////////////////////////////////////////////////////
+
+// Deferred formatting
+
+// String-like arguments may not outlive the builder, they are copied
+template <typename T>
+using CapturedArg = std::conditional_t<
+    std::is_convertible_v<const std::decay_t<T>&, std::string_view> &&
+        !std::is_same_v<std::decay_t<T>, std::string>,
+    std::string, std::decay_t<T>>;
+
+// Format compiled with FMT_COMPILE
+template <typename S>
+concept CompiledFormat = !DynamicString<S> &&
+                         std::is_empty_v<S> &&
+                         std::is_constructible_v<fmt::string_view, S>;
+
+template <typename S, typename... Args>
+LazyString DeferFormat(S format, Args&&... args) {
+  fmt::string_view templ{format};
+  return LazyString::Deferred(
+      [format, args = std::tuple<CapturedArg<Args>...>(std::forward<Args>(args)...)](
+          fmt::memory_buffer& out) {
+        std::apply([&format, &out](const auto&... captured) {
+          if constexpr (CompiledFormat<S>) {
+            fmt::format_to(fmt::appender(out), format, captured...);
+          } else {
+            fmt::vformat_to(fmt::appender(out), format, fmt::make_format_args(captured...));
+          }
+        }, args);
+      },
+      std::string_view{templ.data(), templ.size()});
+}
+
 //////////////////////////////////////////////////////////////////////
 
 class ContextBuilder {
@@ -14,21 +66,92 @@ class ContextBuilder {
   using Builder = ContextBuilder;
  public:
   ContextBuilder(wheels::SourceLocation loc)
-      : location_(loc) {
+      : source_(loc) {
+  }
+
+  // Registered static site, see FALLIBLE_CTX
+  ContextBuilder(AtSite at, wheels::SourceLocation loc = wheels::Here())
+      : source_(loc), site_(at.id) {
   }
 
-  Builder& Reason(std::string descr) {
-    reason_ = descr;
+  Builder& Reason(Literal descr) {
+    reason_ = SharedString{descr};
     return *this;
   }
 
-  Builder& Domain(std::string name) {
-    domain_ = name;
+  // Rendered only if Reason() / Describe() is called
+  // Usage: .Reason(FMT_COMPILE("shard {} lag {}ms"), id, lag)
+  template <CompiledFormat S, typename... Args>
+  Builder& Reason(const S& format, Args&&... args) {
+    reason_ = DeferFormat(format, std::forward<Args>(args)...);
     return *this;
   }
 
-  Builder& Location(SourceLocation loc) {
-    location_ = std::move(loc);
+  // Format string is checked at compile time by fmt
+  // Usage: .Reason("shard {} lag {}ms", id, lag)
+  template <typename... Args>
+  requires (sizeof...(Args) > 0)
+  Builder& Reason(fmt::format_string<Args...> format, Args&&... args) {
+    fmt::string_view view = format;
+    reason_ = DeferFormat(std::string_view{view.data(), view.size()},
+                          std::forward<Args>(args)...);
+    return *this;
+  }
+
+  template <DynamicString S>
+  Builder& Reason(S&& descr) {
+    reason_ = SharedString::Copy(std::string_view(descr));
+    return *this;
+  }
+
+  // Shared without copying, see wire/codec.hpp
+  Builder& Reason(SharedString descr) {
+    reason_ = std::move(descr);
+    return *this;
+  }
+
+  // Custom renderer, see LazyString::Deferred
+  Builder& Reason(LazyString descr) {
+    reason_ = std::move(descr);
+    return *this;
+  }
+
+  // Declared domains and string literals: the id is computed at
+  // compile time, see context/domain.hpp
+  Builder& Domain(const ErrorDomain& domain) {
+    domain_ = SharedString::Borrow(domain.name);
+    domain_id_ = domain.id;
+    return *this;
+  }
+
+  template <DynamicString S>
+  Builder& Domain(S&& name) {
+    domain_ = SharedString::Copy(std::string_view(name));
+    domain_id_ = DomainIdOf(domain_.View());
+    return *this;
+  }
+
+  Builder& Domain(SharedString name) {
+    domain_ = std::move(name);
+    domain_id_ = DomainIdOf(domain_.View());
+    return *this;
+  }
+
+  Builder& Location(wheels::SourceLocation source) {
+    source_ = source;
+    site_ = 0;
+    remote_site_.reset();
+    return *this;
+  }
+
+  // Arbitrary (e.g. remote) location: kept on the context with shared
+  // strings, not interned, see RemoteSite in data.hpp
+  Builder& Location(const SourceLocation& loc);
+
+  // Registered or interned site
+  Builder& Location(AtSite at) {
+    site_ = at.id;
+    remote_site_.reset();
     return *this;
   }
 
@@ -36,11 +159,34 @@ class ContextBuilder {
     return Location(source);
   }
 
-  Builder& Attr(std::string key, std::string value) {
-    attrs_.insert_or_assign(std::move(key), std::move(value));
+  Builder& Attr(StringArg key, StringArg value) {
+    attrs_.Set(key, value);
+    return *this;
+  }
+
+  // Typed value: integer, floating point, duration or Blob
+  Builder& Attr(StringArg key, AttrValue value) {
+    attrs_.Set(key, std::move(value));
     return *this;
   }
 
+  // Only a registered or compile-time source location is set
+  bool IsBare() const {
+    return reason_.Empty() && domain_.Empty() && attrs_.empty() &&
+           !remote_site_;
+  }
+
+  // Registered or interned origin, 0 for a dynamic location
+  SiteId Site() const {
+    if (remote_site_) {
+      return 0;
+    }
+    return site_ != 0 ? site_ : InternCallSite(source_);
+  }
+
+  // Moves collected fields into `data`
+  void Fill(ContextData& data);
+
   Context Done() {
     return Context{*this};
   }
@@ -50,9 +196,15 @@ class ContextBuilder {
   }
 
  private:
-  std::string reason_;
-  std::string domain_;
-  SourceLocation location_;
+  LazyString reason_;
+  SharedString domain_;
+  DomainId domain_id_ = 0;
+
+  // Compile-time location is interned lazily, unless site is already known
+  wheels::SourceLocation source_;
+  SiteId site_ = 0;
+  // Dynamic location, overrides `source_` and `site_`
+  std::shared_ptr<const RemoteSite> remote_site_;
 
   Attrs attrs_;
 };
@@ -66,3 +218,13 @@ inline detail::ContextBuilder Ctx(wheels::SourceLocation loc = wheels::Here()) {
 }
 
 }  // namespace fallible
+
+//////////////////////////////////////////////////////////////////////
+
+// Ctx() with a call site registered at startup
+// Usage: Context ctx = FALLIBLE_CTX().Reason("...");
+
+#define FALLIBLE_CTX()                   \
+  ::fallible::detail::ContextBuilder(    \
+      ::fallible::detail::AtSite{        \
+          FALLIBLE_SITE("", ::fallible::CallSite::kNoCode)})
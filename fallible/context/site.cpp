@@ -0,0 +1,185 @@
+#include <fallible/context/site.hpp>
+
+#include <fallible/support/hash.hpp>
+
+#include <wheels/core/singleton.hpp>
+
+#include <array>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+
+namespace fallible {
+
+//////////////////////////////////////////////////////////////////////
+
+class SiteRegistry {
+  // Two-level table: lock-free reads, ids are never reused
+  static constexpr size_t kChunkSize = 4096;
+  static constexpr size_t kMaxChunks = 4096;
+
+  using Chunk = std::array<SiteInfo, kChunkSize>;
+
+  // file, function, line
+  using Key = std::tuple<std::string_view, std::string_view, int>;
+
+ public:
+  SiteId Register(CallSite& site) {
+    std::lock_guard guard(mutex_);
+
+    if (SiteId id = site.id.load(std::memory_order_relaxed); id != 0) {
+      return id;  // Lost the race
+    }
+
+    SiteId id = Append(site.file, site.function, site.line, site.domain, site.code);
+    site.id.store(id, std::memory_order_release);
+    return id;
+  }
+
+  // Precondition: file and function have static storage duration
+  // or `copy` is set
+  SiteId Intern(std::string_view file, std::string_view function, int line,
+                bool copy) {
+    std::lock_guard guard(mutex_);
+
+    if (auto it = dynamic_.find(Key{file, function, line}); it != dynamic_.end()) {
+      return it->second;
+    }
+
+    if (copy) {
+      file = strings_.emplace_back(file);
+      function = strings_.emplace_back(function);
+    }
+
+    SiteId id = Append(file, function, line, /*domain=*/"", CallSite::kNoCode);
+    if (id != 0) {
+      dynamic_.emplace(Key{file, function, line}, id);
+    }
+    return id;
+  }
+
+  const SiteInfo& Get(SiteId id) const {
+    size_t chunk = id / kChunkSize;
+    if (chunk >= kMaxChunks) {
+      return kUnknown;
+    }
+    Chunk* entries = chunks_[chunk].load(std::memory_order_acquire);
+    if (entries == nullptr) {
+      return kUnknown;
+    }
+    // Not yet published entries have id = 0
+    return (*entries)[id % kChunkSize];
+  }
+
+  std::vector<SiteInfo> List() const {
+    std::lock_guard guard(mutex_);
+
+    std::vector<SiteInfo> sites;
+    sites.reserve(next_id_ - 1);
+    for (SiteId id = 1; id < next_id_; ++id) {
+      sites.push_back(Get(id));
+    }
+    return sites;
+  }
+
+ private:
+  // Guarded by mutex_
+  SiteId Append(std::string_view file, std::string_view function, int line,
+                std::string_view domain, int32_t code) {
+    SiteId id = next_id_;
+
+    size_t chunk = id / kChunkSize;
+    if (chunk >= kMaxChunks || id >= (SiteId{1} << 30)) {
+      return 0;  // Registry is full
+    }
+
+    Chunk* entries = chunks_[chunk].load(std::memory_order_relaxed);
+    if (entries == nullptr) {
+      entries = new Chunk{};
+      chunks_[chunk].store(entries, std::memory_order_release);
+    }
+
+    (*entries)[id % kChunkSize] = SiteInfo{
+        id, file, function, line, domain, code,
+        detail::SiteFingerprint(file, function, line), DomainIdOf(domain)};
+    ++next_id_;
+
+    return id;
+  }
+
+ private:
+  static inline const SiteInfo kUnknown{0, "", "", 0, "", CallSite::kNoCode, 0};
+
+  std::array<std::atomic<Chunk*>, kMaxChunks> chunks_{};
+
+  mutable std::mutex mutex_;
+  SiteId next_id_ = 1;
+  std::map<Key, SiteId> dynamic_;
+  // Copies of dynamic file and function names, never freed
+  std::deque<std::string> strings_;
+};
+
+static SiteRegistry& Registry() {
+  return LeakySingleton<SiteRegistry>();
+}
+
+//////////////////////////////////////////////////////////////////////
+
+namespace detail {
+
+SiteId RegisterCallSiteSlow(CallSite& site) {
+  return Registry().Register(site);
+}
+
+uint64_t SiteFingerprint(std::string_view file, std::string_view function, int line) {
+  return HashCombine(HashBytes(function, HashBytes(file)), line);
+}
+
+}  // namespace detail
+
+SiteId InternCallSite(wheels::SourceLocation loc) {
+  // Direct-mapped per-thread cache keyed by addresses of literals
+  struct CacheEntry {
+    const char* file = nullptr;
+    const char* function = nullptr;
+    int line = 0;
+    SiteId id = 0;
+  };
+
+  static constexpr size_t kCacheSize = 64;
+  static thread_local std::array<CacheEntry, kCacheSize> cache;
+
+  std::string_view file = loc.File();
+  std::string_view function = loc.Function();
+  int line = loc.Line();
+
+  size_t hash = std::hash<const void*>{}(file.data()) ^ (size_t(line) * 0x9E3779B97F4A7C15);
+  CacheEntry& entry = cache[hash % kCacheSize];
+
+  if (entry.file == file.data() && entry.function == function.data() && entry.line == line) {
+    return entry.id;
+  }
+
+  SiteId id = Registry().Intern(file, function, line, /*copy=*/false);
+  entry = {file.data(), function.data(), line, id};
+  return id;
+}
+
+SiteId InternCallSite(std::string_view file, std::string_view function,
+                      int line) {
+  return Registry().Intern(file, function, line, /*copy=*/true);
+}
+
+const SiteInfo& GetCallSite(SiteId id) {
+  return Registry().Get(id);
+}
+
+std::vector<SiteInfo> ListCallSites() {
+  return Registry().List();
+}
+
+}  // namespace fallible
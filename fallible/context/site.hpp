@@ -0,0 +1,124 @@
+#pragma once
+
+#include <fallible/context/domain.hpp>
+
+#include <wheels/core/source_location.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace fallible {
+
+//////////////////////////////////////////////////////////////////////
+
+// Call site identifier, 0 = unknown site
+// Fits into 30 bits, see error/error.hpp
+
+using SiteId = uint32_t;
+
+//////////////////////////////////////////////////////////////////////
+
+// Compile-time descriptor of an Err / Ctx call site
+// Emitted by FALLIBLE_ERR / FALLIBLE_CTX macros (see error/make.hpp)
+
+struct CallSite {
+  // Ctx sites do not have a code
+  static constexpr int32_t kNoCode = -1;
+
+  const char* file;
+  const char* function;
+  int line;
+  // Default domain, empty if none
+  const char* domain;
+  int32_t code;
+
+  // Assigned at registration
+  std::atomic<SiteId> id{0};
+};
+
+// Registered call site
+struct SiteInfo {
+  SiteId id;
+  std::string_view file;
+  std::string_view function;
+  int line;
+  std::string_view domain;
+  int32_t code;
+  // Hash of file, function and line, unlike id stable across processes
+  uint64_t fingerprint = 0;
+  // DomainIdOf(domain)
+  DomainId domain_id = 0;
+};
+
+//////////////////////////////////////////////////////////////////////
+
+namespace detail {
+
+SiteId RegisterCallSiteSlow(CallSite& site);
+
+// SiteInfo::fingerprint
+uint64_t SiteFingerprint(std::string_view file, std::string_view function, int line);
+
+}  // namespace detail
+
+// Static sites: registered at startup, idempotent
+inline SiteId RegisterCallSite(CallSite& site) {
+  SiteId id = site.id.load(std::memory_order_acquire);
+  return id != 0 ? id : detail::RegisterCallSiteSlow(site);
+}
+
+// Dynamic sites: interned by file, function and line
+
+// Compile-time location, cached per thread
+SiteId InternCallSite(wheels::SourceLocation loc);
+
+// Arbitrary (e.g. remote) location, strings are copied once per site
+SiteId InternCallSite(std::string_view file, std::string_view function,
+                      int line);
+
+// O(1), lock-free
+// Unknown or invalid id -> empty SiteInfo with id = 0
+const SiteInfo& GetCallSite(SiteId id);
+
+// All sites registered so far
+// Static sites are registered before main
+std::vector<SiteInfo> ListCallSites();
+
+//////////////////////////////////////////////////////////////////////
+
+namespace detail {
+
+// Builders constructed at a registered site
+struct AtSite {
+  SiteId id;
+};
+
+struct SiteRegistrar {
+  explicit SiteRegistrar(CallSite* site) {
+    RegisterCallSite(*site);
+  }
+};
+
+// Instantiated (and initialized at startup) for each FALLIBLE_SITE expansion
+template <CallSite* Site>
+inline SiteRegistrar kSiteRegistrar{Site};
+
+}  // namespace detail
+
+}  // namespace fallible
+
+//////////////////////////////////////////////////////////////////////
+
+// Registers static descriptor of the current call site, yields its SiteId
+// GNU statement expression, supported by GCC and Clang
+
+#define FALLIBLE_SITE(domain, code)                                       \
+  (__extension__({                                                        \
+    static constinit ::fallible::CallSite fallible_call_site{             \
+        __builtin_FILE(), __builtin_FUNCTION(), __builtin_LINE(), domain, \
+        code};                                                            \
+    (void)&::fallible::detail::kSiteRegistrar<&fallible_call_site>;       \
+    ::fallible::RegisterCallSite(fallible_call_site);                     \
+  }))
@@ -1,29 +1,274 @@
 #include <fallible/error/codes.hpp>
-#include "wheels/core/panic.hpp"
+
+#include <wheels/core/panic.hpp>
+#include <wheels/core/singleton.hpp>
+
+#include <fmt/format.h>
+
+#include <array>
+#include <cerrno>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
 
 namespace fallible {
 
-#define CASE(code) case ErrorCodes::code: return #code;
+//////////////////////////////////////////////////////////////////////
+
+#define NAME(code) std::string_view{#code},
+
+// Indexed by code
+static constexpr std::array kCanonicalNames = {
+  NAME(Ok)
+  NAME(Unknown)
+  NAME(Disconnected)
+  NAME(Invalid)
+  NAME(Cancelled)
+  NAME(Aborted)
+  NAME(TimedOut)
+  NAME(NotFound)
+  NAME(AlreadyExists)
+  NAME(Unauthorized)
+  NAME(Unavailable)
+  NAME(ResourceExhausted)
+  NAME(Internal)
+  NAME(NotSupported)
+};
+
+#undef NAME
+
+static_assert(kCanonicalNames.size() == ErrorCodes::NotSupported + 1);
+
+static bool IsCanonical(int32_t code) {
+  return code >= 0 && static_cast<size_t>(code) < kCanonicalNames.size();
+}
+
+//////////////////////////////////////////////////////////////////////
+
+class ErrorCodeRegistry {
+ public:
+  ErrorCodeRegistry() {
+    for (size_t code = 0; code < kCanonicalNames.size(); ++code) {
+      codes_.emplace(kCanonicalNames[code], static_cast<int32_t>(code));
+    }
+  }
+
+  void Register(const ErrorCode& code) {
+    std::unique_lock guard(mutex_);
+
+    if (auto it = codes_.find(code.name); it != codes_.end() && it->second != code.value) {
+      WHEELS_PANIC("Error code name '" << code.name << "' is taken by code " << it->second);
+    }
+
+    std::string_view name = IsCanonical(code.value)
+                                ? kCanonicalNames[code.value]
+                                : names_.try_emplace(code.value, code.name).first->second;
+    if (name != code.name) {
+      WHEELS_PANIC("Error code " << code.value << " is taken by '" << name << "'");
+    }
+
+    codes_.emplace(code.name, code.value);
+  }
+
+  std::optional<std::string_view> FindName(int32_t code) const {
+    std::shared_lock guard(mutex_);
+
+    if (auto it = names_.find(code); it != names_.end()) {
+      return it->second;
+    }
+    return std::nullopt;
+  }
+
+  std::optional<int32_t> FindCode(std::string_view name) const {
+    std::shared_lock guard(mutex_);
+
+    if (auto it = codes_.find(name); it != codes_.end()) {
+      return it->second;
+    }
+    return std::nullopt;
+  }
+
+ private:
+  mutable std::shared_mutex mutex_;
+  // Custom codes only, names of declared codes have static storage
+  std::unordered_map<int32_t, std::string_view> names_;
+  std::unordered_map<std::string_view, int32_t> codes_;
+};
+
+static ErrorCodeRegistry& Registry() {
+  return LeakySingleton<ErrorCodeRegistry>();
+}
+
+//////////////////////////////////////////////////////////////////////
+
+void RegisterErrorCode(const ErrorCode& code) {
+  Registry().Register(code);
+}
+
+std::optional<std::string_view> FindErrorCodeName(int32_t code) {
+  if (IsCanonical(code)) {
+    return kCanonicalNames[code];  // Lock-free
+  }
+  return Registry().FindName(code);
+}
+
+std::optional<int32_t> FindErrorCode(std::string_view name) {
+  return Registry().FindCode(name);
+}
 
 std::string ErrorCodeName(int code) {
-  switch (code) {
-    CASE(Ok)
-    CASE(Unknown)
-    CASE(Disconnected)
-    CASE(Invalid)
-    CASE(Cancelled)
-    CASE(Aborted)
-    CASE(TimedOut)
-    CASE(NotFound)
-    CASE(AlreadyExists)
-    CASE(Unauthorized)
-    CASE(Unavailable)
-    CASE(ResourceExhausted)
-    CASE(Internal)
-    CASE(NotSupported)
-    default:
-      WHEELS_PANIC("unreachable");
+  if (auto name = FindErrorCodeName(code)) {
+    return std::string{*name};
   }
+  return fmt::format("Code({})", code);
 }
 
+//////////////////////////////////////////////////////////////////////
+
+namespace {
+
+struct ErrnoEntry {
+  int err;
+  int32_t code;
+  std::string_view name;
+};
+
+#define ERRNO(err, code) ErrnoEntry{err, ErrorCodes::code, #err},
+
+// Following absl::ErrnoToStatusCode, adapted to ErrorCodes:
+// broken connections are Disconnected, failed preconditions are Invalid
+constexpr ErrnoEntry kErrnoCodes[] = {
+  ERRNO(EINVAL, Invalid)
+  ERRNO(E2BIG, Invalid)
+  ERRNO(EBADF, Invalid)
+  ERRNO(EDESTADDRREQ, Invalid)
+  ERRNO(EDOM, Invalid)
+  ERRNO(EFAULT, Invalid)
+  ERRNO(EILSEQ, Invalid)
+  ERRNO(EISDIR, Invalid)
+  ERRNO(ENAMETOOLONG, Invalid)
+  ERRNO(ENOEXEC, Invalid)
+  ERRNO(ENOPROTOOPT, Invalid)
+  ERRNO(ENOTDIR, Invalid)
+  ERRNO(ENOTEMPTY, Invalid)
+  ERRNO(ENOTSOCK, Invalid)
+  ERRNO(ENOTTY, Invalid)
+  ERRNO(EOVERFLOW, Invalid)
+  ERRNO(EPROTOTYPE, Invalid)
+  ERRNO(ERANGE, Invalid)
+  ERRNO(ESPIPE, Invalid)
+  ERRNO(EXDEV, Invalid)
+
+  ERRNO(ETIMEDOUT, TimedOut)
+  ERRNO(ETIME, TimedOut)
+
+  ERRNO(ENOENT, NotFound)
+  ERRNO(ENODEV, NotFound)
+  ERRNO(ENXIO, NotFound)
+  ERRNO(ESRCH, NotFound)
+
+  ERRNO(EEXIST, AlreadyExists)
+  ERRNO(EADDRINUSE, AlreadyExists)
+  ERRNO(EALREADY, AlreadyExists)
+
+  ERRNO(EPERM, Unauthorized)
+  ERRNO(EACCES, Unauthorized)
+  ERRNO(EROFS, Unauthorized)
+
+  ERRNO(EAGAIN, Unavailable)
+  ERRNO(EBUSY, Unavailable)
+  ERRNO(EINPROGRESS, Unavailable)
+  ERRNO(EINTR, Unavailable)
+  ERRNO(EIO, Unavailable)
+  ERRNO(EADDRNOTAVAIL, Unavailable)
+  ERRNO(EHOSTDOWN, Unavailable)
+  ERRNO(EHOSTUNREACH, Unavailable)
+  ERRNO(ENETDOWN, Unavailable)
+  ERRNO(ENETUNREACH, Unavailable)
+  ERRNO(ETXTBSY, Unavailable)
+
+  ERRNO(ECONNABORTED, Disconnected)
+  ERRNO(ECONNREFUSED, Disconnected)
+  ERRNO(ECONNRESET, Disconnected)
+  ERRNO(ENETRESET, Disconnected)
+  ERRNO(ENOTCONN, Disconnected)
+  ERRNO(EPIPE, Disconnected)
+  ERRNO(ESHUTDOWN, Disconnected)
+
+  ERRNO(ENOSPC, ResourceExhausted)
+  ERRNO(EDQUOT, ResourceExhausted)
+  ERRNO(EFBIG, ResourceExhausted)
+  ERRNO(EMFILE, ResourceExhausted)
+  ERRNO(EMLINK, ResourceExhausted)
+  ERRNO(ENFILE, ResourceExhausted)
+  ERRNO(ENOBUFS, ResourceExhausted)
+  ERRNO(ENOMEM, ResourceExhausted)
+
+  ERRNO(ENOSYS, NotSupported)
+  ERRNO(ENOTSUP, NotSupported)
+  ERRNO(EAFNOSUPPORT, NotSupported)
+  ERRNO(EPFNOSUPPORT, NotSupported)
+  ERRNO(EPROTONOSUPPORT, NotSupported)
+  ERRNO(ESOCKTNOSUPPORT, NotSupported)
+
+  ERRNO(ECANCELED, Cancelled)
+  ERRNO(EDEADLK, Aborted)
+};
+
+#undef ERRNO
+
+// Errno values are small, larger ones are unmapped
+constexpr size_t kErrnoTableSize = 256;
+
+struct ErrnoTable {
+  std::array<int8_t, kErrnoTableSize> codes{};
+  std::array<std::string_view, kErrnoTableSize> names{};
+
+  constexpr ErrnoTable() {
+    codes.fill(ErrorCodes::Unknown);
+    for (const auto& entry : kErrnoCodes) {
+      // Aliases (EWOULDBLOCK, EOPNOTSUPP) share entries
+      if (entry.err >= 0 && static_cast<size_t>(entry.err) < kErrnoTableSize) {
+        codes[entry.err] = static_cast<int8_t>(entry.code);
+        names[entry.err] = entry.name;
+      }
+    }
+  }
+};
+
+constexpr ErrnoTable kErrnoTable;
+
+bool InTable(int err) {
+  return err >= 0 && static_cast<size_t>(err) < kErrnoTableSize;
+}
+
+}  // namespace
+
+int32_t CanonicalErrorCode(std::error_code code) {
+  if (!code) {
+    return ErrorCodes::Ok;
+  }
+
+  int err = code.value();
+  if (code.category() != std::generic_category() &&
+      code.category() != std::system_category()) {
+    // Virtual call, only for foreign categories
+    std::error_condition condition = code.default_error_condition();
+    if (condition.category() != std::generic_category()) {
+      return ErrorCodes::Unknown;
+    }
+    err = condition.value();
+  }
+
+  return InTable(err) ? kErrnoTable.codes[err] : int32_t{ErrorCodes::Unknown};
+}
+
+namespace detail {
+
+std::string_view ErrnoName(int err) {
+  return InTable(err) ? kErrnoTable.names[err] : std::string_view{};
+}
+
+}  // namespace detail
+
 }  // namespace fallible
@@ -1,6 +1,13 @@
 #pragma once
 
+#include <fallible/support/preprocessor.hpp>
+#include <fallible/support/string.hpp>
+
+#include <cstdint>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <system_error>
 
 namespace fallible {
 
@@ -34,8 +41,64 @@ struct ErrorCodes {
 
 //////////////////////////////////////////////////////////////////////
 
+// Custom codes: declared by subsystems without touching ErrorCodes
+// Usage:
+//   inline constexpr fallible::ErrorCode kQuotaExceeded{1001, "QuotaExceeded"};
+//   FALLIBLE_REGISTER_ERROR_CODE(kQuotaExceeded);
+//
+//   Err(kQuotaExceeded).Reason("Daily quota exceeded")
+
+struct ErrorCode {
+  int32_t value;
+  std::string_view name;
+
+  consteval ErrorCode(int32_t code, Literal literal)
+      : value(code), name(literal.View()) {
+  }
+
+  constexpr operator int32_t() const {  // NOLINT
+    return value;
+  }
+};
+
+// Registering a taken code or name with a different counterpart panics,
+// canonical codes are registered implicitly
+void RegisterErrorCode(const ErrorCode& code);
+
+// O(1), canonical and registered codes
+std::optional<std::string_view> FindErrorCodeName(int32_t code);
+std::optional<int32_t> FindErrorCode(std::string_view name);
+
+// Never fails: unknown codes are rendered as `Code(N)`
 std::string ErrorCodeName(int code);
 
 //////////////////////////////////////////////////////////////////////
 
+// Canonical code of a system error: errno values (generic and system
+// categories) and codes with a generic default_error_condition
+// Usage: CanonicalErrorCode(std::errc::timed_out) == ErrorCodes::TimedOut
+// O(1) table lookup, unmapped values -> ErrorCodes::Unknown
+int32_t CanonicalErrorCode(std::error_code code);
+
+//////////////////////////////////////////////////////////////////////
+
+namespace detail {
+
+inline bool RegisterErrorCodeAtStartup(const ErrorCode& code) {
+  RegisterErrorCode(code);
+  return true;
+}
+
+// Symbolic name of a mapped errno value (`ENOENT`), empty if unmapped
+std::string_view ErrnoName(int err);
+
+}  // namespace detail
+
 }  // namespace fallible
+
+// At namespace scope, in a header or a source file
+// Any constant expression, e.g. a qualified name: rpc::kQuotaExceeded
+// Registered by every translation unit that includes the header
+#define FALLIBLE_REGISTER_ERROR_CODE(code)                                      \
+  [[maybe_unused]] static const bool FALLIBLE_UNIQUE_NAME(fallible_error_code_) = \
+      ::fallible::detail::RegisterErrorCodeAtStartup(code)
@@ -1,59 +1,465 @@
 #include <fallible/error/error.hpp>
 
 #include <fallible/error/codes.hpp>
+#include <fallible/error/format.hpp>
 #include <fallible/error/make.hpp>
+#include <fallible/error/stack.hpp>
+#include <fallible/error/trace.hpp>
+
+#include <fallible/context/data.hpp>
+
+#include <fallible/support/hash.hpp>
 
 #include <wheels/core/assert.hpp>
 
-#include <sstream>
+#include <atomic>
+#include <iterator>
+#include <memory_resource>
+#include <optional>
+#include <vector>
 
 namespace fallible {
 
 //////////////////////////////////////////////////////////////////////
 
-Error::Error(detail::ErrorBuilder& builder)
-    : code_(builder.code_),
-      context_(builder.context_.Done()),
-      sub_errors_(std::move(builder.sub_errors_)) {
-  //
+// Context fields and the code share a single allocation
+// Fields of root errors (sub-errors, payload, stack) live out of line,
+// so Wrap frames do not pay for them
+struct Error::Rep : detail::ContextData {
+  struct Extras {
+    explicit Extras(std::pmr::memory_resource* resource)
+        : sub_errors(resource) {
+    }
+
+    std::pmr::vector<Error> sub_errors;
+    detail::SmallAny payload;
+    StackTrace stack;
+  };
+
+  ~Rep() override {
+    if (extras != nullptr) {
+      std::pmr::polymorphic_allocator<Extras>{extras->sub_errors.get_allocator().resource()}
+          .delete_object(extras);
+    }
+  }
+
+  // Allocated from the arena of the node, if any, on first use
+  Extras& MutableExtras() {
+    if (extras == nullptr) {
+      std::pmr::polymorphic_allocator<Extras> alloc{detail::ArenaResource(arena)};
+      extras = alloc.new_object<Extras>(alloc.resource());
+    }
+    return *extras;
+  }
+
+  int32_t code = 0;
+  // Wrapped error, see Wrap
+  std::optional<Error> cause;
+  // nullptr = no sub-errors, payload or stack
+  Extras* extras = nullptr;
+  // Cached Fingerprint, 0 = not computed yet
+  mutable std::atomic<uint64_t> fingerprint{0};
+};
+
+//////////////////////////////////////////////////////////////////////
+
+Error::Error(detail::ErrorBuilder& builder) {
+  StackTrace stack;
+  if (!builder.cause_ &&
+      detail::ShouldCaptureStack(builder.code_, [&builder] {
+        return builder.context_.Site();
+      })) {
+    // Skip this constructor
+    stack = StackTrace::Capture(/*skip=*/1);
+  }
+
+  if (builder.context_.IsBare() && builder.sub_errors_.empty() &&
+      !builder.payload_.HasValue() && !builder.cause_ && stack.IsEmpty()) {
+    word_ = InlineWord(builder.code_, builder.context_.Site());
+  } else {
+    auto* rep = detail::NewNode<Rep>();
+    rep->code = builder.code_;
+    builder.context_.Fill(*rep);
+    if (!builder.sub_errors_.empty() || builder.payload_.HasValue() || !stack.IsEmpty()) {
+      Rep::Extras& extras = rep->MutableExtras();
+      extras.sub_errors.assign(std::make_move_iterator(builder.sub_errors_.begin()),
+                               std::make_move_iterator(builder.sub_errors_.end()));
+      extras.payload = std::move(builder.payload_);
+      extras.stack = std::move(stack);
+    }
+    rep->cause = std::move(builder.cause_);
+    word_ = reinterpret_cast<uintptr_t>(rep) | kSharedTag;
+  }
+
+  if (const Error* cause = Cause()) {
+    detail::ReturnTraces::Continue(*cause, *this);
+  } else {
+    detail::ReturnTraces::Start(*this);
+  }
 }
 
-Error Error::SubError() const {
-  WHEELS_VERIFY(sub_errors_.size() == 1, "Unexpected number of sub-errors: " << sub_errors_.size());
-  return sub_errors_.front();
+Error::Error(Rep* rep)
+    : word_(reinterpret_cast<uintptr_t>(rep) | kSharedTag) {
+  // A Wrap frame is its context plus a few words
+  static_assert(sizeof(Rep) <= sizeof(detail::ContextData) + 40);
 }
 
-bool Error::IsCancelled() const {
-  return Code() == ErrorCodes::Cancelled;
+Error Error::Assemble(int32_t code, detail::ContextData& context,
+                      std::vector<Error> sub_errors, std::optional<Error> cause) {
+  if (context.reason.Empty() && context.domain.Empty() && context.attrs.empty() &&
+      !context.remote_site && sub_errors.empty() && !cause) {
+    // Code-only, as built by Err(code).Done()
+    Error error{static_cast<Rep*>(nullptr)};
+    error.word_ = InlineWord(code, context.site);
+    return error;
+  }
+
+  auto* rep = detail::NewNode<Rep>();
+  rep->code = code;
+  context.CopyInto(*rep);
+  if (!sub_errors.empty()) {
+    rep->MutableExtras().sub_errors.assign(std::make_move_iterator(sub_errors.begin()),
+                                           std::make_move_iterator(sub_errors.end()));
+  }
+  rep->cause = std::move(cause);
+  return Error{rep};
 }
 
-std::string Error::Describe() const {
-  std::stringstream out;
-  auto loc = SourceLocation();
+int32_t Error::SharedCode() const {
+  return GetRep()->code;
+}
 
-  out << "\n" "code = " << Code()
-      << " (" << ErrorCodeName(Code()) << ")\n"
-      << "domain = " << Domain() << "\n"
-      << "reason = '" << Reason() << "'\n"
-      << "origin = " << loc.File() << ":" << loc.Line() << "\n"
-      << "         " << loc.Function();
+void Error::Ref() noexcept {
+  GetRep()->Ref();
+}
 
-  const auto& attrs = Attrs();
+void Error::Unref() noexcept {
+  Rep* rep = GetRep();
+  if (rep->Unref()) {
+    detail::DeleteNode(rep);
+  }
+}
 
-  if (!attrs.empty()) {
-    out << ", attrs = {";
-    size_t index = 0;
-    for (const auto& [k, v] : attrs) {
-      if (index > 0) {
-        out << ", ";
-      }
-      out << k << " = " << v;
-      ++index;
+Error::Rep& Error::MutableRep() {
+  if (IsInline()) {
+    auto* rep = detail::NewNode<Rep>();
+    rep->code = InlineCode();
+    rep->site = InlineSite();
+    word_ = reinterpret_cast<uintptr_t>(rep) | kSharedTag;
+  } else if (!GetRep()->IsUnique()) {
+    // Copy-on-write, other holders keep the original
+    const Rep* from = GetRep();
+    auto* rep = detail::NewNode<Rep>();
+    rep->code = from->code;
+    from->CopyInto(*rep);
+    if (from->extras != nullptr) {
+      Rep::Extras& extras = rep->MutableExtras();
+      extras.sub_errors.assign(from->extras->sub_errors.begin(), from->extras->sub_errors.end());
+      extras.payload = from->extras->payload;
+      extras.stack = from->extras->stack;
     }
-    out << "}" << std::endl;
+    rep->cause = from->cause;
+    Unref();
+    word_ = reinterpret_cast<uintptr_t>(rep) | kSharedTag;
   }
+  return *GetRep();
+}
 
-  return out.str();
+bool Error::IsImmortal() const {
+  return IsShared() && GetRep()->IsImmortal();
+}
+
+void Error::MakeImmortal() const {
+  if (IsShared()) {
+    GetRep()->MakeImmortal();
+  }
+}
+
+void Error::Share() const {
+  if (IsShared()) {
+    const Rep* rep = GetRep();
+    rep->Share();
+    for (const auto& sub_error : FrameSubErrors()) {
+      sub_error.Share();
+    }
+    if (rep->cause) {
+      rep->cause->Share();
+    }
+  }
+}
+
+Error Error::Detach() const {
+  if (!IsShared()) {
+    return *this;
+  }
+
+  detail::HeapScope heap;
+
+  const Rep* from = GetRep();
+  auto* rep = detail::NewNode<Rep>();
+  rep->code = from->code;
+  from->DetachInto(*rep);
+  if (from->extras != nullptr) {
+    Rep::Extras& extras = rep->MutableExtras();
+    for (const auto& sub_error : from->extras->sub_errors) {
+      extras.sub_errors.push_back(sub_error.Detach());
+    }
+    extras.payload = from->extras->payload;
+    // Stacks live on the global heap
+    extras.stack = from->extras->stack;
+  }
+  if (from->cause) {
+    rep->cause = from->cause->Detach();
+  }
+
+  return Error{rep};
+}
+
+const detail::SmallAny* Error::GetPayload() const {
+  if (IsShared() && GetRep()->extras != nullptr) {
+    return &GetRep()->extras->payload;
+  }
+  return nullptr;
+}
+
+detail::SmallAny& Error::MutablePayload() {
+  return MutableRep().MutableExtras().payload;
+}
+
+//////////////////////////////////////////////////////////////////////
+
+Context Error::Context() const {
+  if (IsShared()) {
+    return fallible::Context{GetRep()};
+  }
+  // Same location as SourceLocation(), no allocation
+  return fallible::Context{InlineSite()};
+}
+
+const Error* Error::Cause() const {
+  if (IsShared() && GetRep()->cause) {
+    return &*GetRep()->cause;
+  }
+  return nullptr;
+}
+
+StackTrace Error::Stack() const {
+  for (const Error* frame = this; frame != nullptr; frame = frame->Cause()) {
+    if (const StackTrace* stack = frame->FrameStack()) {
+      return *stack;
+    }
+  }
+  return {};
+}
+
+const SiteInfo* Error::FrameOrigin() const {
+  if (IsShared()) {
+    return GetRep()->Origin();
+  }
+  SiteId site = InlineSite();
+  return site != 0 ? &GetCallSite(site) : nullptr;
+}
+
+std::string Error::FrameDomain() const {
+  if (IsShared() && !GetRep()->domain.Empty()) {
+    return GetRep()->domain.ToString();
+  }
+  return std::string{GetCallSite(Site()).domain};
+}
+
+std::string Error::FrameReason() const {
+  return IsShared() ? GetRep()->reason.ToString() : std::string{};
+}
+
+std::string_view Error::FrameDomainView() const {
+  if (IsShared() && !GetRep()->domain.Empty()) {
+    return GetRep()->domain.View();
+  }
+  return GetCallSite(Site()).domain;
+}
+
+DomainId Error::FrameDomainId() const {
+  if (IsShared() && GetRep()->domain_id != 0) {
+    return GetRep()->domain_id;
+  }
+  return GetCallSite(Site()).domain_id;
+}
+
+const StackTrace* Error::FrameStack() const {
+  if (IsShared() && GetRep()->extras != nullptr && !GetRep()->extras->stack.IsEmpty()) {
+    return &GetRep()->extras->stack;
+  }
+  return nullptr;
+}
+
+void Error::AppendFrameReason(fmt::memory_buffer& out) const {
+  if (IsShared()) {
+    GetRep()->reason.AppendTo(out);
+  }
+}
+
+std::string_view Error::FrameReasonTemplate() const {
+  return IsShared() ? GetRep()->reason.Template() : std::string_view{};
+}
+
+uint64_t Error::FrameFingerprint() const {
+  uint64_t hash = detail::HashCombine(detail::kHashSeed, static_cast<uint32_t>(Code()));
+  const SiteInfo* origin = FrameOrigin();
+  hash = detail::HashCombine(hash, origin != nullptr ? origin->fingerprint : 0);
+  hash = detail::HashBytes(FrameDomainView(), hash);
+  return detail::HashBytes(FrameReasonTemplate(), hash);
+}
+
+uint64_t Error::Fingerprint() const {
+  if (!IsShared()) {
+    return FrameFingerprint();
+  }
+
+  const Rep* rep = GetRep();
+  if (uint64_t cached = rep->fingerprint.load(std::memory_order_relaxed); cached != 0) {
+    return cached;
+  }
+
+  uint64_t hash = FrameFingerprint();
+  if (rep->cause) {
+    hash = detail::HashCombine(hash, rep->cause->Fingerprint());
+  }
+  // 0 is reserved for "not computed"
+  hash += (hash == 0);
+
+  rep->fingerprint.store(hash, std::memory_order_relaxed);
+  return hash;
+}
+
+static bool SameOrigin(const SiteInfo* lhs, const SiteInfo* rhs) {
+  if (lhs == rhs) {
+    return true;
+  }
+  if (lhs == nullptr || rhs == nullptr) {
+    return false;
+  }
+  // Static, interned and remote sites may share a location
+  return lhs->line == rhs->line && lhs->file == rhs->file && lhs->function == rhs->function;
+}
+
+bool operator==(const Error& lhs, const Error& rhs) {
+  const Error* l = &lhs;
+  const Error* r = &rhs;
+
+  while (l != nullptr && r != nullptr) {
+    if (l->word_ == r->word_) {
+      return true;  // Same payload or same code-only error
+    }
+    if (l->Code() != r->Code() || l->Fingerprint() != r->Fingerprint()) {
+      return false;
+    }
+    if (!SameOrigin(l->FrameOrigin(), r->FrameOrigin()) ||
+        l->FrameDomainView() != r->FrameDomainView() ||
+        l->FrameReasonTemplate() != r->FrameReasonTemplate()) {
+      return false;
+    }
+    l = l->Cause();
+    r = r->Cause();
+  }
+
+  return l == r;  // Both chains ended
+}
+
+std::string Error::Domain() const {
+  std::string domain = FrameDomain();
+  if (domain.empty() && Cause() != nullptr) {
+    return Cause()->Domain();
+  }
+  return domain;
+}
+
+DomainId Error::DomainId() const {
+  for (const Error* frame = this; frame != nullptr; frame = frame->Cause()) {
+    if (fallible::DomainId id = frame->FrameDomainId(); id != 0) {
+      return id;
+    }
+  }
+  return 0;
+}
+
+std::string Error::Reason() const {
+  std::string reason = FrameReason();
+  if (const Error* cause = Cause()) {
+    std::string cause_reason = cause->Reason();
+    if (reason.empty()) {
+      return cause_reason;
+    } else if (!cause_reason.empty()) {
+      return reason + ": " + cause_reason;
+    }
+  }
+  return reason;
+}
+
+SourceLocation Error::SourceLocation() const {
+  if (IsShared() && GetRep()->remote_site) {
+    return GetRep()->remote_site->Location();
+  }
+  return fallible::SourceLocation{GetCallSite(Site())};
+}
+
+SiteId Error::Site() const {
+  return IsShared() ? GetRep()->site : InlineSite();
+}
+
+const Attrs& Error::Attrs() const {
+  static const fallible::Attrs kNoAttrs{};
+  return IsShared() ? GetRep()->attrs : kNoAttrs;
+}
+
+const AttrValue* Error::FindAttr(std::string_view name) const {
+  for (const Error* frame = this; frame != nullptr; frame = frame->Cause()) {
+    if (const AttrValue* value = frame->Attrs().Find(name)) {
+      return value;
+    }
+  }
+  return nullptr;
+}
+
+std::span<const Error> Error::FrameSubErrors() const {
+  if (IsShared() && GetRep()->extras != nullptr) {
+    return GetRep()->extras->sub_errors;
+  }
+  return {};
+}
+
+std::vector<Error> Error::SubErrors() const {
+  if (IsShared()) {
+    std::span<const Error> sub_errors = FrameSubErrors();
+    if (sub_errors.empty() && GetRep()->cause) {
+      return GetRep()->cause->SubErrors();
+    }
+    return {sub_errors.begin(), sub_errors.end()};
+  }
+  return {};
+}
+
+Error Error::SubError() const {
+  auto sub_errors = SubErrors();
+  WHEELS_VERIFY(sub_errors.size() == 1, "Unexpected number of sub-errors: " << sub_errors.size());
+  return sub_errors.front();
+}
+
+void Error::AddAttr(StringArg key, StringArg value) {
+  MutableRep().attrs.Set(key, value);
+}
+
+void Error::AddAttr(StringArg key, AttrValue value) {
+  MutableRep().attrs.Set(key, std::move(value));
+}
+
+bool Error::IsCancelled() const {
+  return Code() == ErrorCodes::Cancelled;
+}
+
+std::string Error::Describe() const {
+  fmt::memory_buffer out;
+  DescribeTo(out, *this);
+  return fmt::to_string(out);
 }
 
 }  // namespace fallible
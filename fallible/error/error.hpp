@@ -3,60 +3,264 @@
 #include <fallible/error/fwd.hpp>
 #include <fallible/context/context.hpp>
 
+#include <fallible/support/relocatable.hpp>
+#include <fallible/support/small_any.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <utility>
 #include <vector>
 
 namespace fallible {
 
+// Error = code + optional payload (Context + sub-errors) in a single tagged word
+//
+// Code-only errors (no domain, reason, attrs or sub-errors) are stored inline
+// together with the id of their call site and never allocate,
+// everything else lives behind one ref-counted pointer
+
 class Error {
   friend class detail::ErrorBuilder;
+  friend struct detail::ReturnTraces;
+  friend struct detail::ErrorCounters;
+  friend struct detail::FlightRecorders;
+  friend struct detail::ErrorCodec;
+  friend struct detail::ErrorWriter;
+  friend Error StaticError(int32_t code, Literal domain, Literal reason,
+                           wheels::SourceLocation loc);
+
+  struct Rep;
 
  public:
-  int32_t Code() const {
-    return code_;
+  Error(const Error& that) noexcept : word_(that.word_) {
+    if (IsShared()) {
+      Ref();
+    }
   }
 
-  const Context& Context() const {
-    return context_;
+  Error(Error&& that) noexcept : word_(that.word_) {
+    that.word_ = kMovedFrom;
   }
 
-  std::string Domain() const {
-    return context_.Domain();
+  Error& operator=(const Error& that) noexcept {
+    Error copy{that};
+    std::swap(word_, copy.word_);
+    return *this;
   }
 
-  std::string Reason() const {
-    return context_.Reason();
+  Error& operator=(Error&& that) noexcept {
+    std::swap(word_, that.word_);
+    return *this;
   }
 
-  SourceLocation SourceLocation() const {
-    return context_.SourceLocation();
+  ~Error() {
+    if (IsShared()) {
+      Unref();
+    }
   }
 
-  std::vector<Error> SubErrors() const {
-    return sub_errors_;
+  int32_t Code() const {
+    if (IsInline()) {
+      return InlineCode();
+    }
+    return SharedCode();
   }
 
+  // Shares payload with this error
+  // Code-only errors get a fresh context with their call site
+  class Context Context() const;
+
+  // Wrapped errors (see Wrap in make.hpp) fall back to the domain of
+  // the cause and chain reasons: "outer: inner"
+  std::string Domain() const;
+
+  // Integer counterpart of Domain() for hot filters, no allocations:
+  //   error.DomainId() == kRpcDomain.id
+  // 0 if none, see context/domain.hpp
+  fallible::DomainId DomainId() const;
+
+  bool InDomain(const ErrorDomain& domain) const {
+    return DomainId() == domain.id;
+  }
+
+  std::string Reason() const;
+
+  SourceLocation SourceLocation() const;
+
+  // Origin, see context/site.hpp
+  // 0 for decoded remote locations: not registered, see SourceLocation()
+  SiteId Site() const;
+
+  std::vector<Error> SubErrors() const;
+
   Error SubError() const;
 
-  const Attrs& Attrs() const {
-    return context_.Attrs();
+  // Attributes of this frame
+  const Attrs& Attrs() const;
+
+  // Walks the chain of wrapped errors, outermost first
+  const AttrValue* FindAttr(std::string_view name) const;
+
+  // Error wrapped by this one, nullptr if none
+  const Error* Cause() const;
+
+  // Captured at creation if enabled for the code or the call site,
+  // see error/stack.hpp. Walks the chain of wrapped errors.
+  // Empty if none
+  StackTrace Stack() const;
+
+  // Copy-on-write: other copies of this error are not affected,
+  // uniquely owned payload is updated in place
+  void AddAttr(StringArg key, StringArg value);
+  void AddAttr(StringArg key, AttrValue value);
+
+  // Typed payload, e.g. error.Payload<RetryInfo>()
+  // nullptr if error has no payload of type T
+  // Walks the chain of wrapped errors, outermost first
+  template <typename T>
+  const T* Payload() const {
+    for (const Error* frame = this; frame != nullptr; frame = frame->Cause()) {
+      if (const detail::SmallAny* payload = frame->GetPayload()) {
+        if (const T* value = payload->Get<T>()) {
+          return value;
+        }
+      }
+    }
+    return nullptr;
   }
 
-  void AddAttr(std::string key, std::string value) {
-    context_.AddAttr(std::move(key), std::move(value));
+  template <typename T>
+  void SetPayload(T value) {
+    MutablePayload() = detail::SmallAny{std::move(value)};
   }
 
   std::string Describe() const;
 
+  // Fast 64-bit hash of code, domain, call site and reason template
+  // (format string, not the rendered arguments) of each frame in the
+  // chain of wrapped errors. Attributes, payload and sub-errors are
+  // ignored. Stable across processes, cached by shared errors
+  // Usage: dedup and aggregation keys
+  uint64_t Fingerprint() const;
+
+  // Compares the fields covered by Fingerprint
+  friend bool operator==(const Error& lhs, const Error& rhs);
+
+  // Upgrades reference counting of a thread-confined error (and its
+  // sub-errors) to atomic, call before sending it to another thread,
+  // see support/confined.hpp
+  void Share() const;
+
+  // Deep copy on the global heap, for errors escaping an ErrorArenaScope
+  // (see support/arena.hpp)
+  Error Detach() const;
+
   // TODO: Cancellation / errors
   bool IsCancelled() const;
 
+  // Flyweight built by StaticError: never freed, shared by all failures
+  bool IsImmortal() const;
+
+  // Tag bits of the underlying word are never zero,
+  // Result<T> keeps its value in these patterns (see result/niche.hpp)
+  static constexpr uintptr_t kNicheTagMask = 0b11;
+
  private:
-  Error(detail::ErrorBuilder&);
+  explicit Error(detail::ErrorBuilder&);
+
+  // Adopts the reference
+  explicit Error(Rep* rep);
+
+  // Decoded frame (see wire/codec.hpp), fields as is: not a failure of
+  // this process, so no stack, return trace, telemetry or flight record
+  static Error Assemble(int32_t code, detail::ContextData& context,
+                        std::vector<Error> sub_errors, std::optional<Error> cause);
+
+  // See StaticError
+  void MakeImmortal() const;
+
+  // Word layout:
+  //   [code:32][site:30][01] - code-only error, no payload
+  //   [Rep* aligned   ][10] - ref-counted payload
+  static_assert(sizeof(uintptr_t) == sizeof(uint64_t),
+                "Error packs the code into the upper half of a 64-bit word");
+
+  static constexpr uintptr_t kTagMask = kNicheTagMask;
+  static constexpr uintptr_t kInlineTag = 0b01;
+  static constexpr uintptr_t kSharedTag = 0b10;
+
+  // Moved-from errors are code-only Unknown errors
+  static constexpr uintptr_t kMovedFrom = (uintptr_t{1} << 32) | kInlineTag;
+
+  static constexpr uintptr_t kSiteMask = (uintptr_t{1} << 30) - 1;
+
+  static uintptr_t InlineWord(int32_t code, SiteId site) {
+    return (uintptr_t{static_cast<uint32_t>(code)} << 32) |
+           ((site & kSiteMask) << 2) | kInlineTag;
+  }
+
+  bool IsInline() const {
+    return (word_ & kTagMask) == kInlineTag;
+  }
+
+  bool IsShared() const {
+    return (word_ & kTagMask) == kSharedTag;
+  }
+
+  int32_t InlineCode() const {
+    return static_cast<int32_t>(word_ >> 32);
+  }
+
+  SiteId InlineSite() const {
+    return static_cast<SiteId>((word_ >> 2) & kSiteMask);
+  }
+
+  Rep* GetRep() const {
+    return reinterpret_cast<Rep*>(word_ & ~kTagMask);
+  }
+
+  // Out-of-line slow paths
+  int32_t SharedCode() const;
+  void Ref() noexcept;
+  void Unref() noexcept;
+
+  // Materializes payload of a code-only error,
+  // copies shared payload before the first mutation (copy-on-write)
+  Rep& MutableRep();
+
+  const detail::SmallAny* GetPayload() const;
+
+  // Fields of this frame only
+  // Registered site or remote origin, nullptr if unknown
+  const SiteInfo* FrameOrigin() const;
+  std::string FrameDomain() const;
+  std::string FrameReason() const;
+  std::string_view FrameDomainView() const;
+  fallible::DomainId FrameDomainId() const;
+  std::string_view FrameReasonTemplate() const;
+  uint64_t FrameFingerprint() const;
+  std::span<const Error> FrameSubErrors() const;
+  void AppendFrameReason(fmt::memory_buffer& out) const;
+  // nullptr if not captured
+  const StackTrace* FrameStack() const;
+  detail::SmallAny& MutablePayload();
 
  private:
-  int32_t code_;
-  class Context context_;
-  std::vector<Error> sub_errors_;
+  uintptr_t word_;
 };
 
+// Just a word
+template <>
+struct IsTriviallyRelocatable<Error> : std::true_type {};
+
 }  // namespace fallible
+
+template <>
+struct std::hash<fallible::Error> {
+  size_t operator()(const fallible::Error& error) const {
+    return error.Fingerprint();
+  }
+};
@@ -0,0 +1,434 @@
+#include <fallible/error/format.hpp>
+
+#include <fallible/error/codes.hpp>
+#include <fallible/error/stack.hpp>
+#include <fallible/error/trace.hpp>
+
+#include <fallible/context/data.hpp>
+
+#include <cmath>
+#include <string_view>
+
+namespace fallible {
+
+//////////////////////////////////////////////////////////////////////
+
+namespace {
+
+void Append(fmt::memory_buffer& out, std::string_view str) {
+  out.append(str);
+}
+
+void AppendJsonString(fmt::memory_buffer& out, std::string_view str) {
+  out.push_back('"');
+  for (char c : str) {
+    switch (c) {
+      case '"':
+        Append(out, "\\\"");
+        break;
+      case '\\':
+        Append(out, "\\\\");
+        break;
+      case '\n':
+        Append(out, "\\n");
+        break;
+      case '\r':
+        Append(out, "\\r");
+        break;
+      case '\t':
+        Append(out, "\\t");
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          fmt::format_to(fmt::appender(out), "\\u{:04x}", static_cast<unsigned>(c));
+        } else {
+          out.push_back(c);
+        }
+    }
+  }
+  out.push_back('"');
+}
+
+// Escapes the tail of `out` starting at `start` in place
+void EscapeJsonTail(fmt::memory_buffer& out, size_t start, fmt::memory_buffer& scratch) {
+  scratch.clear();
+  AppendJsonString(scratch, {out.data() + start, out.size() - start});
+  out.resize(start);
+  out.append(scratch);
+}
+
+bool NeedsLogfmtQuotes(std::string_view str) {
+  if (str.empty()) {
+    return true;
+  }
+  for (char c : str) {
+    if (c == ' ' || c == '=' || c == '"' || c == '\\' ||
+        static_cast<unsigned char>(c) < 0x20) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void AppendLogfmtValue(fmt::memory_buffer& out, std::string_view str) {
+  if (!NeedsLogfmtQuotes(str)) {
+    Append(out, str);
+    return;
+  }
+  // Same escapes as JSON strings
+  AppendJsonString(out, str);
+}
+
+// Escapes the tail of `out` starting at `start` as a logfmt value
+void EscapeLogfmtTail(fmt::memory_buffer& out, size_t start, fmt::memory_buffer& scratch) {
+  std::string_view value{out.data() + start, out.size() - start};
+  if (!NeedsLogfmtQuotes(value)) {
+    return;
+  }
+  scratch.clear();
+  AppendJsonString(scratch, value);
+  out.resize(start);
+  out.append(scratch);
+}
+
+void AppendJsonAttrValue(fmt::memory_buffer& out, const AttrValue& value,
+                         fmt::memory_buffer& scratch) {
+  switch (value.Kind()) {
+    case AttrKind::Int:
+      fmt::format_to(fmt::appender(out), "{}", *value.AsInt());
+      return;
+    case AttrKind::UInt:
+      fmt::format_to(fmt::appender(out), "{}", *value.AsUInt());
+      return;
+    case AttrKind::Double:
+      if (std::isfinite(*value.AsDouble())) {
+        fmt::format_to(fmt::appender(out), "{}", *value.AsDouble());
+      } else {
+        Append(out, "null");
+      }
+      return;
+    case AttrKind::String:
+      AppendJsonString(out, *value.AsString());
+      return;
+    case AttrKind::Bool:
+      Append(out, *value.AsBool() ? "true" : "false");
+      return;
+    default: {
+      size_t start = out.size();
+      value.FormatTo(out);
+      EscapeJsonTail(out, start, scratch);
+    }
+  }
+}
+
+void AppendCodeName(fmt::memory_buffer& out, int32_t code) {
+  if (auto name = FindErrorCodeName(code)) {
+    Append(out, *name);
+  } else {
+    fmt::format_to(fmt::appender(out), "Code({})", code);
+  }
+}
+
+}  // namespace
+
+//////////////////////////////////////////////////////////////////////
+
+namespace detail {
+
+void ErrorWriter::Describe(fmt::memory_buffer& out, const Error& error, size_t depth) {
+  if (depth == 0) {
+    Append(out, "\n...");
+    return;
+  }
+
+  auto loc = error.SourceLocation();
+
+  fmt::format_to(fmt::appender(out), "\ncode = {} (", error.Code());
+  AppendCodeName(out, error.Code());
+  Append(out, ")\ndomain = ");
+  Append(out, error.FrameDomainView());
+  Append(out, "\nreason = '");
+  error.AppendFrameReason(out);
+  fmt::format_to(fmt::appender(out), "'\norigin = {}:{}\n         {}",
+                 loc.File(), loc.Line(), loc.Function());
+
+  const auto& attrs = error.Attrs();
+
+  if (!attrs.empty()) {
+    Append(out, ", attrs = {");
+    size_t index = 0;
+    for (const auto& attr : attrs) {
+      if (index > 0) {
+        Append(out, ", ");
+      }
+      Append(out, attr.key.Name());
+      Append(out, " = ");
+      attr.value.FormatTo(out);
+      ++index;
+    }
+    Append(out, "}\n");
+  }
+
+  if (auto trace = GetReturnTrace(error); !trace.IsEmpty()) {
+    Append(out, "\nreturn trace:\n");
+    Append(out, trace.Describe());
+  }
+
+  // Symbolized on demand
+  if (const StackTrace* stack = error.FrameStack()) {
+    Append(out, "\nstack trace:\n");
+    Append(out, stack->Describe());
+  }
+
+  if (auto sub_errors = error.FrameSubErrors(); !sub_errors.empty()) {
+    Append(out, "\nsub-errors:");
+    for (size_t i = 0; i < sub_errors.size(); ++i) {
+      fmt::format_to(fmt::appender(out), "\n[{}]", i);
+      Describe(out, sub_errors[i], depth - 1);
+    }
+  }
+
+  // Wrapped errors, innermost last
+  if (const Error* cause = error.Cause()) {
+    Append(out, "\ncaused by:");
+    Describe(out, *cause, depth - 1);
+  }
+}
+
+void ErrorWriter::Summarize(fmt::memory_buffer& out, const Error& error, size_t depth) {
+  AppendCodeName(out, error.Code());
+
+  if (std::string_view domain = error.FrameDomainView(); !domain.empty()) {
+    Append(out, " (");
+    Append(out, domain);
+    Append(out, ")");
+  }
+
+  size_t before_reason = out.size();
+  Append(out, ": ");
+  size_t reason_start = out.size();
+  error.AppendFrameReason(out);
+  if (out.size() == reason_start) {
+    out.resize(before_reason);
+  }
+
+  if (const SiteInfo* site = error.FrameOrigin()) {
+    fmt::format_to(fmt::appender(out), " at {}:{}", site->file, site->line);
+  }
+
+  if (const Error* cause = error.Cause()) {
+    Append(out, "; caused by ");
+    if (depth > 1) {
+      Summarize(out, *cause, depth - 1);
+    } else {
+      Append(out, "...");
+    }
+  }
+}
+
+void ErrorWriter::Summarize(fmt::memory_buffer& out, const Context& context) {
+  const ContextData* data = context.data_;
+  if (data == nullptr) {
+    if (context.site_ == 0) {
+      Append(out, "<empty>");
+      return;
+    }
+    // Origin of a code-only error
+    const SiteInfo& site = GetCallSite(context.site_);
+    if (!site.domain.empty()) {
+      Append(out, site.domain);
+      Append(out, ": ");
+    }
+    fmt::format_to(fmt::appender(out), " at {}:{}", site.file, site.line);
+    return;
+  }
+
+  std::string_view domain = data->domain.Empty()
+                                ? GetCallSite(data->site).domain
+                                : data->domain.View();
+  if (!domain.empty()) {
+    Append(out, domain);
+    Append(out, ": ");
+  }
+  data->reason.AppendTo(out);
+
+  if (const SiteInfo* site = data->Origin()) {
+    fmt::format_to(fmt::appender(out), " at {}:{}", site->file, site->line);
+  }
+
+  if (!data->attrs.empty()) {
+    Append(out, " {");
+    size_t index = 0;
+    for (const auto& attr : data->attrs) {
+      if (index++ > 0) {
+        Append(out, ", ");
+      }
+      Append(out, attr.key.Name());
+      Append(out, " = ");
+      attr.value.FormatTo(out);
+    }
+    Append(out, "}");
+  }
+}
+
+void ErrorWriter::Json(fmt::memory_buffer& out, const Error& error, size_t depth) {
+  if (depth == 0) {
+    Append(out, R"({"truncated":true})");
+    return;
+  }
+
+  // Escaping of rendered values
+  fmt::memory_buffer scratch;
+
+  fmt::format_to(fmt::appender(out), R"({{"code":{},"code_name":)", error.Code());
+  size_t start = out.size();
+  AppendCodeName(out, error.Code());
+  EscapeJsonTail(out, start, scratch);
+
+  if (std::string_view domain = error.FrameDomainView(); !domain.empty()) {
+    Append(out, R"(,"domain":)");
+    AppendJsonString(out, domain);
+  }
+
+  size_t before_reason = out.size();
+  Append(out, R"(,"reason":)");
+  start = out.size();
+  error.AppendFrameReason(out);
+  if (out.size() == start) {
+    out.resize(before_reason);
+  } else {
+    EscapeJsonTail(out, start, scratch);
+  }
+
+  if (const SiteInfo* site = error.FrameOrigin()) {
+    Append(out, R"(,"file":)");
+    AppendJsonString(out, site->file);
+    fmt::format_to(fmt::appender(out), R"(,"line":{},"function":)", site->line);
+    AppendJsonString(out, site->function);
+  }
+
+  if (const auto& attrs = error.Attrs(); !attrs.empty()) {
+    Append(out, R"(,"attrs":{)");
+    size_t index = 0;
+    for (const auto& attr : attrs) {
+      if (index++ > 0) {
+        out.push_back(',');
+      }
+      AppendJsonString(out, attr.key.Name());
+      out.push_back(':');
+      AppendJsonAttrValue(out, attr.value, scratch);
+    }
+    out.push_back('}');
+  }
+
+  if (auto sub_errors = error.FrameSubErrors(); !sub_errors.empty()) {
+    Append(out, R"(,"sub_errors":[)");
+    for (size_t i = 0; i < sub_errors.size(); ++i) {
+      if (i > 0) {
+        out.push_back(',');
+      }
+      Json(out, sub_errors[i], depth - 1);
+    }
+    out.push_back(']');
+  }
+
+  if (const Error* cause = error.Cause()) {
+    Append(out, R"(,"cause":)");
+    Json(out, *cause, depth - 1);
+  }
+
+  out.push_back('}');
+}
+
+void ErrorWriter::Logfmt(fmt::memory_buffer& out, const Error& error,
+                         fmt::memory_buffer& prefix, size_t depth) {
+  std::string_view key_prefix{prefix.data(), prefix.size()};
+
+  auto key = [&](std::string_view name, std::string_view suffix = {}) {
+    if (out.size() > 0) {
+      out.push_back(' ');
+    }
+    Append(out, key_prefix);
+    Append(out, name);
+    Append(out, suffix);
+    out.push_back('=');
+  };
+
+  if (depth == 0) {
+    key("truncated");
+    Append(out, "true");
+    return;
+  }
+
+  fmt::memory_buffer scratch;
+
+  key("code");
+  AppendCodeName(out, error.Code());
+
+  if (std::string_view domain = error.FrameDomainView(); !domain.empty()) {
+    key("domain");
+    AppendLogfmtValue(out, domain);
+  }
+
+  size_t before_reason = out.size();
+  key("reason");
+  size_t start = out.size();
+  error.AppendFrameReason(out);
+  if (out.size() == start) {
+    out.resize(before_reason);
+  } else {
+    EscapeLogfmtTail(out, start, scratch);
+  }
+
+  if (const SiteInfo* site = error.FrameOrigin()) {
+    key("site");
+    start = out.size();
+    fmt::format_to(fmt::appender(out), "{}:{}", site->file, site->line);
+    EscapeLogfmtTail(out, start, scratch);
+  }
+
+  for (const auto& attr : error.Attrs()) {
+    key("attr.", attr.key.Name());
+    start = out.size();
+    attr.value.FormatTo(out);
+    EscapeLogfmtTail(out, start, scratch);
+  }
+
+  size_t prefix_size = prefix.size();
+
+  auto sub_errors = error.FrameSubErrors();
+  for (size_t i = 0; i < sub_errors.size(); ++i) {
+    fmt::format_to(fmt::appender(prefix), "sub.{}.", i);
+    Logfmt(out, sub_errors[i], prefix, depth - 1);
+    prefix.resize(prefix_size);
+  }
+
+  if (const Error* cause = error.Cause()) {
+    Append(prefix, "cause.");
+    Logfmt(out, *cause, prefix, depth - 1);
+    prefix.resize(prefix_size);
+  }
+}
+
+}  // namespace detail
+
+//////////////////////////////////////////////////////////////////////
+
+void DescribeTo(fmt::memory_buffer& out, const Error& error, size_t max_depth) {
+  detail::ErrorWriter::Describe(out, error, max_depth + 1);
+}
+
+void SummarizeTo(fmt::memory_buffer& out, const Error& error, size_t max_depth) {
+  detail::ErrorWriter::Summarize(out, error, max_depth + 1);
+}
+
+void WriteJson(fmt::memory_buffer& out, const Error& error, size_t max_depth) {
+  detail::ErrorWriter::Json(out, error, max_depth + 1);
+}
+
+void WriteLogfmt(fmt::memory_buffer& out, const Error& error, size_t max_depth) {
+  fmt::memory_buffer prefix;
+  detail::ErrorWriter::Logfmt(out, error, prefix, max_depth + 1);
+}
+
+}  // namespace fallible
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <fallible/error/error.hpp>
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <cstddef>
+
+namespace fallible {
+
+//////////////////////////////////////////////////////////////////////
+
+// Streaming writers: append to a caller-provided buffer without
+// intermediate strings (only deferred reasons with formatted
+// arguments and traces are rendered separately)
+//
+// Sub-errors and causes are written recursively up to `max_depth`
+// levels, deeper errors are elided
+
+inline constexpr size_t kDefaultFormatDepth = 8;
+
+// Human-readable, multi-line, see Error::Describe
+void DescribeTo(fmt::memory_buffer& out, const Error& error,
+                size_t max_depth = kDefaultFormatDepth);
+
+// Single line: `TimedOut (Rpc): Deadline exceeded at rpc.cpp:42`
+// followed by `; caused by ...` for wrapped errors
+void SummarizeTo(fmt::memory_buffer& out, const Error& error,
+                 size_t max_depth = kDefaultFormatDepth);
+
+// JSON object:
+//   {"code":6,"code_name":"TimedOut","domain":"Rpc","reason":"...",
+//    "file":"rpc.cpp","line":42,"function":"Call","attrs":{"shard":17},
+//    "sub_errors":[...],"cause":{...}}
+// Empty fields are omitted, elided levels are {"truncated":true}
+void WriteJson(fmt::memory_buffer& out, const Error& error,
+               size_t max_depth = kDefaultFormatDepth);
+
+// logfmt pairs: `code=TimedOut domain=Rpc reason="Deadline exceeded"
+// site=rpc.cpp:42 attr.shard=17 cause.code=...`
+// Sub-errors are prefixed with `sub.<index>.`, elided levels are
+// `<prefix>truncated=true`
+void WriteLogfmt(fmt::memory_buffer& out, const Error& error,
+                 size_t max_depth = kDefaultFormatDepth);
+
+//////////////////////////////////////////////////////////////////////
+
+namespace detail {
+
+// Reads fields of Error and Context frames without copies
+struct ErrorWriter {
+  static void Describe(fmt::memory_buffer& out, const Error& error, size_t depth);
+  static void Summarize(fmt::memory_buffer& out, const Error& error, size_t depth);
+  static void Json(fmt::memory_buffer& out, const Error& error, size_t depth);
+  static void Logfmt(fmt::memory_buffer& out, const Error& error,
+                     fmt::memory_buffer& prefix, size_t depth);
+
+  static void Summarize(fmt::memory_buffer& out, const Context& context);
+};
+
+template <typename FormatContext>
+auto CopyTo(const fmt::memory_buffer& buffer, FormatContext& ctx) {
+  return std::copy(buffer.begin(), buffer.end(), ctx.out());
+}
+
+}  // namespace detail
+
+}  // namespace fallible
+
+//////////////////////////////////////////////////////////////////////
+
+// `{}`: file:line
+template <>
+struct fmt::formatter<fallible::SourceLocation> {
+  constexpr auto parse(format_parse_context& ctx) {
+    return ctx.begin();
+  }
+
+  template <typename FormatContext>
+  auto format(const fallible::SourceLocation& where, FormatContext& ctx) const {
+    return fmt::format_to(ctx.out(), "{}:{}", where.File(), where.Line());
+  }
+};
+
+// `{}`: Rpc: Deadline exceeded at rpc.cpp:42 {shard = 17}
+template <>
+struct fmt::formatter<fallible::Context> {
+  constexpr auto parse(format_parse_context& ctx) {
+    return ctx.begin();
+  }
+
+  template <typename FormatContext>
+  auto format(const fallible::Context& context, FormatContext& ctx) const {
+    fmt::memory_buffer buffer;
+    fallible::detail::ErrorWriter::Summarize(buffer, context);
+    return fallible::detail::CopyTo(buffer, ctx);
+  }
+};
+
+// `{}`: single line (SummarizeTo), `{:v}`: verbose (Describe),
+// `{:j}`: JSON (WriteJson), `{:l}`: logfmt (WriteLogfmt)
+template <>
+struct fmt::formatter<fallible::Error> {
+  char style = 's';
+
+  constexpr auto parse(format_parse_context& ctx) {
+    auto it = ctx.begin();
+    if (it != ctx.end() && (*it == 'v' || *it == 'j' || *it == 'l')) {
+      style = *it++;
+    }
+    if (it != ctx.end() && *it != '}') {
+      throw format_error("invalid format for fallible::Error");
+    }
+    return it;
+  }
+
+  template <typename FormatContext>
+  auto format(const fallible::Error& error, FormatContext& ctx) const {
+    fmt::memory_buffer buffer;
+    switch (style) {
+      case 'v':
+        fallible::DescribeTo(buffer, error);
+        break;
+      case 'j':
+        fallible::WriteJson(buffer, error);
+        break;
+      case 'l':
+        fallible::WriteLogfmt(buffer, error);
+        break;
+      default:
+        fallible::SummarizeTo(buffer, error);
+        break;
+    }
+    return fallible::detail::CopyTo(buffer, ctx);
+  }
+};
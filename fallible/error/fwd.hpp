@@ -3,9 +3,15 @@
 namespace fallible {
 
 class Error;
+class StackTrace;
 
 namespace detail {
 class ErrorBuilder;
+struct ReturnTraces;
+struct ErrorCounters;
+struct FlightRecorders;
+struct ErrorCodec;
+struct ErrorWriter;
 }  // namespace detail
 
 }  // namespace fallible
\ No newline at end of file
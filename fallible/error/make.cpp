@@ -1,5 +1,9 @@
 #include <fallible/error/make.hpp>
 
+#include <fallible/support/arena.hpp>
+#include <fallible/telemetry/counters.hpp>
+#include <fallible/telemetry/flight.hpp>
+
 namespace fallible {
 
 namespace detail {
@@ -8,12 +12,15 @@ ErrorBuilder::ErrorBuilder(int32_t code, wheels::SourceLocation loc)
     : code_(code), context_(loc) {
 }
 
-ErrorBuilder& ErrorBuilder::Domain(std::string name) {
-  context_.Domain(name);
-  return *this;
+ErrorBuilder::ErrorBuilder(Error cause, wheels::SourceLocation loc)
+    : code_(cause.Code()), context_(loc), cause_(std::move(cause)) {
 }
 
-ErrorBuilder& ErrorBuilder::Reason(std::string descr) {
+ErrorBuilder::ErrorBuilder(int32_t code, AtSite at, wheels::SourceLocation loc)
+    : code_(code), context_(at, loc) {
+}
+
+ErrorBuilder& ErrorBuilder::Reason(Literal descr) {
   context_.Reason(descr);
   return *this;
 }
@@ -23,20 +30,73 @@ ErrorBuilder& ErrorBuilder::Location(wheels::SourceLocation source) {
   return *this;
 }
 
+ErrorBuilder& ErrorBuilder::Location(AtSite at) {
+  context_.Location(at);
+  return *this;
+}
+
 ErrorBuilder& ErrorBuilder::AddSubError(Error e) {
   sub_errors_.push_back(std::move(e));
   return *this;
 }
 
-ErrorBuilder& ErrorBuilder::Attr(std::string key, std::string value) {
-  context_.Attr(std::move(key), std::move(value));
+ErrorBuilder& ErrorBuilder::Attr(StringArg key, StringArg value) {
+  context_.Attr(key, value);
+  return *this;
+}
+
+ErrorBuilder& ErrorBuilder::Attr(StringArg key, AttrValue value) {
+  context_.Attr(key, std::move(value));
   return *this;
 }
 
 Error ErrorBuilder::Done() {
-  return Error{*this};
+  // Wrap frames propagate their cause
+  ErrorEvent event = cause_ ? ErrorEvent::Propagated : ErrorEvent::Created;
+  Error error{*this};
+  CountError(event, error);
+  RecordFlight(error);
+  return error;
 }
 
 }  // namespace detail
 
+//////////////////////////////////////////////////////////////////////
+
+detail::ErrorBuilder Err(std::error_code code, wheels::SourceLocation loc) {
+  const std::error_category* category = &code.category();
+  int value = code.value();
+  bool is_errno = *category == std::generic_category() ||
+                  *category == std::system_category();
+
+  // Category objects are never destroyed
+  auto message = detail::LazyString::Deferred(
+      [category, value](fmt::memory_buffer& out) {
+        std::string text = category->message(value);
+        out.append(std::string_view{text});
+      },
+      // Fingerprint: distinguishes values mapped to the same code
+      is_errno ? detail::ErrnoName(value) : std::string_view{});
+
+  return detail::ErrorBuilder(CanonicalErrorCode(code), loc)
+      .Domain(SharedString::Borrow(category->name()))
+      .Reason(std::move(message));
+}
+
+//////////////////////////////////////////////////////////////////////
+
+Error StaticError(int32_t code, Literal domain, Literal reason,
+                  wheels::SourceLocation loc) {
+  // Outlives any arena of the caller
+  detail::HeapScope heap;
+
+  // Not a failure yet: counted and recorded by fallible::Fail
+  detail::ErrorBuilder builder = Err(code, loc);
+  // Built once, the id is hashed at runtime
+  builder.Domain(SharedString{domain}).Reason(reason);
+  Error error{builder};
+  error.MakeImmortal();
+  return error;
+}
+
 }  // namespace fallible
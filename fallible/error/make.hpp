@@ -7,6 +7,8 @@
 #include <fallible/context/make.hpp>
 #include <errno.h>
 
+#include <optional>
+
 namespace fallible {
 
 //////////////////////////////////////////////////////////////////////
@@ -19,13 +21,79 @@ class [[nodiscard]] ErrorBuilder {
  public:
   ErrorBuilder(int32_t code, wheels::SourceLocation loc);
 
-  ErrorBuilder& Domain(std::string name);
-  ErrorBuilder& Reason(std::string descr);
+  // Frame on top of `cause`, see Wrap
+  ErrorBuilder(Error cause, wheels::SourceLocation loc);
+
+  // Registered static site, see FALLIBLE_ERR
+  ErrorBuilder(int32_t code, AtSite at,
+               wheels::SourceLocation loc = wheels::Here());
+
+  ErrorBuilder& Reason(Literal descr);
+
+  // Declared domains and string literals: the id is computed at
+  // compile time, see context/domain.hpp
+  ErrorBuilder& Domain(const ErrorDomain& domain) {
+    context_.Domain(domain);
+    return *this;
+  }
+
+  template <DynamicString S>
+  ErrorBuilder& Domain(S&& name) {
+    context_.Domain(std::forward<S>(name));
+    return *this;
+  }
+
+  template <DynamicString S>
+  ErrorBuilder& Reason(S&& descr) {
+    context_.Reason(std::forward<S>(descr));
+    return *this;
+  }
+
+  // Shared without copying
+  ErrorBuilder& Domain(SharedString name) {
+    context_.Domain(std::move(name));
+    return *this;
+  }
+
+  ErrorBuilder& Reason(SharedString descr) {
+    context_.Reason(std::move(descr));
+    return *this;
+  }
+
+  ErrorBuilder& Reason(LazyString descr) {
+    context_.Reason(std::move(descr));
+    return *this;
+  }
+
+  // Deferred formatting, see ContextBuilder::Reason
+  template <CompiledFormat S, typename... Args>
+  ErrorBuilder& Reason(const S& format, Args&&... args) {
+    context_.Reason(format, std::forward<Args>(args)...);
+    return *this;
+  }
+
+  template <typename... Args>
+  requires (sizeof...(Args) > 0)
+  ErrorBuilder& Reason(fmt::format_string<Args...> format, Args&&... args) {
+    context_.Reason(std::move(format), std::forward<Args>(args)...);
+    return *this;
+  }
+
   ErrorBuilder& Location(wheels::SourceLocation source);
   ErrorBuilder& Location(std::string source);
-  ErrorBuilder& Attr(std::string key, std::string value);
+  ErrorBuilder& Location(AtSite at);
+  ErrorBuilder& Attr(StringArg key, StringArg value);
+  ErrorBuilder& Attr(StringArg key, AttrValue value);
   ErrorBuilder& AddSubError(Error e);
 
+  // Typed payload, small values are stored inline
+  // Usage: .Payload(RetryInfo{.after = 1s})
+  template <typename T>
+  ErrorBuilder& Payload(T value) {
+    payload_ = SmallAny{std::move(value)};
+    return *this;
+  }
+
   Error Done();
 
   operator Error() {
@@ -36,6 +104,8 @@ class [[nodiscard]] ErrorBuilder {
   int32_t code_;
   ContextBuilder context_;
   std::vector<Error> sub_errors_;
+  SmallAny payload_;
+  std::optional<Error> cause_;
 };
 
 }  // namespace detail
@@ -46,15 +116,60 @@ inline detail::ErrorBuilder Err(int32_t code, wheels::SourceLocation loc = wheel
   return detail::ErrorBuilder(code, loc);
 }
 
+// Flyweight for hot failure paths: built once, never freed, copies
+// neither allocate nor touch the reference counter
+//
+// Usage:
+//   static const auto kQueueFull =
+//       fallible::StaticError(ErrorCodes::ResourceExhausted, "Rpc", "queue full");
+//   ...
+//   return fallible::Fail(kQueueFull);
+//
+// Return via fallible::Fail: every failure starts a new return trace
+// (see error/trace.hpp), is counted as created by telemetry and is
+// written to the flight recorder
+// Mutating a copy (AddAttr, SetPayload) copies the payload as usual
+
+Error StaticError(int32_t code, Literal domain, Literal reason,
+                  wheels::SourceLocation loc = wheels::SourceLocation::Current());
+
+// Pushes a frame with layer-specific context on top of `cause`:
+// O(1), single allocation, shares the wrapped error
+// Code is inherited from `cause`
+//
+// Usage:
+//   if (result.Failed()) {
+//     return Fail(Wrap(result.Error()).Reason("Fetch user").Attr("user", id));
+//   }
+
+inline detail::ErrorBuilder Wrap(Error cause, wheels::SourceLocation loc = wheels::SourceLocation::Current()) {
+  return detail::ErrorBuilder(std::move(cause), loc);
+}
+
+// System error with the canonical code (see CanonicalErrorCode) and
+// the category name as domain
+// Stores only the category and the value: message() is rendered on
+// demand, e.g. by Reason() or Describe()
+detail::ErrorBuilder Err(std::error_code code, wheels::SourceLocation loc = wheels::SourceLocation::Current());
+
 struct FromErrno {int err = 0;};
 
+// Usage: Err(FromErrno{}) after a failed syscall
 inline detail::ErrorBuilder Err(FromErrno fe, wheels::SourceLocation loc = wheels::SourceLocation::Current()) {
-  auto code = std::make_error_code(static_cast<std::errc>(fe.err == 0 ? errno : fe.err));
-  return detail::ErrorBuilder(ErrorCodes::Internal, loc)
-    .Domain(code.category().name())
-    .Reason(code.message());
+  return Err(std::error_code(fe.err == 0 ? errno : fe.err, std::generic_category()), loc);
 }
 
+// Err(code) with a call site registered at startup:
+// code-only errors carry their origin without interning on the hot path
+// `code` must be a constant expression, `domain` a string literal
+// Usage: return FALLIBLE_ERR(ErrorCodes::TimedOut);
+
+#define FALLIBLE_ERR_IN(domain, code)                               \
+  ::fallible::detail::ErrorBuilder(                                 \
+      code, ::fallible::detail::AtSite{FALLIBLE_SITE(domain, code)})
+
+#define FALLIBLE_ERR(code) FALLIBLE_ERR_IN("", code)
+
 #define THROW_ERRNO(reason) \
   fallible::ThrowError(fallible::Err(fallible::FromErrno{}, WHEELS_HERE))
 
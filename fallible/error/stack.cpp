@@ -0,0 +1,331 @@
+#include <fallible/error/stack.hpp>
+
+#include <fallible/support/ref_counted.hpp>
+
+#include <wheels/core/singleton.hpp>
+
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <pthread.h>
+
+#include <array>
+#include <cstdlib>
+#include <iomanip>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <utility>
+
+namespace fallible {
+
+//////////////////////////////////////////////////////////////////////
+
+struct StackTrace::Rep : detail::RefCounted {
+  std::array<uintptr_t, kMaxDepth> addresses;
+  size_t depth = 0;
+
+  // Deferred symbolization
+  mutable std::once_flag symbolized;
+  mutable std::vector<Frame> frames;
+};
+
+//////////////////////////////////////////////////////////////////////
+
+namespace {
+
+struct StackBounds {
+  uintptr_t low = 0;
+  uintptr_t high = 0;
+};
+
+// Queried once per thread: the walk must not leave the stack
+// of the thread even if the outermost frames do not keep frame pointers
+const StackBounds& ThreadStackBounds() {
+  static thread_local StackBounds bounds = [] {
+    StackBounds stack;
+    pthread_attr_t attr;
+    if (pthread_getattr_np(pthread_self(), &attr) == 0) {
+      void* addr = nullptr;
+      size_t size = 0;
+      if (pthread_attr_getstack(&attr, &addr, &size) == 0) {
+        stack.low = reinterpret_cast<uintptr_t>(addr);
+        stack.high = stack.low + size;
+      }
+      pthread_attr_destroy(&attr);
+    }
+    return stack;
+  }();
+  return bounds;
+}
+
+std::string Demangle(const char* symbol) {
+  int status = 0;
+  char* demangled = abi::__cxa_demangle(symbol, nullptr, nullptr, &status);
+  if (status != 0 || demangled == nullptr) {
+    return symbol;
+  }
+  std::string name{demangled};
+  std::free(demangled);
+  return name;
+}
+
+StackTrace::Frame Symbolize(uintptr_t address) {
+  StackTrace::Frame frame{address, {}, {}, 0};
+
+  Dl_info info;
+  // Return address points past the call instruction
+  if (dladdr(reinterpret_cast<void*>(address - 1), &info) != 0) {
+    if (info.dli_fname != nullptr) {
+      frame.module = info.dli_fname;
+    }
+    if (info.dli_sname != nullptr) {
+      frame.function = Demangle(info.dli_sname);
+      frame.offset = address - reinterpret_cast<uintptr_t>(info.dli_saddr);
+    } else {
+      frame.offset = address - reinterpret_cast<uintptr_t>(info.dli_fbase);
+    }
+  }
+
+  return frame;
+}
+
+}  // namespace
+
+//////////////////////////////////////////////////////////////////////
+
+__attribute__((noinline)) StackTrace StackTrace::Capture(size_t skip) {
+  const StackBounds& bounds = ThreadStackBounds();
+
+  auto* rep = new Rep();
+
+  // Frame layout: [saved frame pointer][return address]
+  auto fp = reinterpret_cast<uintptr_t>(__builtin_frame_address(0));
+
+  while (rep->depth < kMaxDepth) {
+    if (fp < bounds.low || fp + 2 * sizeof(uintptr_t) > bounds.high ||
+        fp % sizeof(uintptr_t) != 0) {
+      break;
+    }
+
+    const auto* frame = reinterpret_cast<const uintptr_t*>(fp);
+    uintptr_t next = frame[0];
+    uintptr_t ret = frame[1];
+
+    if (ret == 0) {
+      break;
+    }
+
+    if (skip > 0) {
+      --skip;
+    } else {
+      rep->addresses[rep->depth++] = ret;
+    }
+
+    // Stack grows down
+    if (next <= fp) {
+      break;
+    }
+    fp = next;
+  }
+
+  StackTrace trace;
+  if (rep->depth > 0) {
+    trace.rep_ = rep;
+  } else {
+    delete rep;
+  }
+  return trace;
+}
+
+StackTrace::StackTrace(const StackTrace& that)
+    : rep_(that.rep_) {
+  if (rep_ != nullptr) {
+    rep_->Ref();
+  }
+}
+
+StackTrace::StackTrace(StackTrace&& that) noexcept
+    : rep_(std::exchange(that.rep_, nullptr)) {
+}
+
+StackTrace& StackTrace::operator=(StackTrace that) noexcept {
+  std::swap(rep_, that.rep_);
+  return *this;
+}
+
+StackTrace::~StackTrace() {
+  if (rep_ != nullptr && rep_->Unref()) {
+    delete rep_;
+  }
+}
+
+size_t StackTrace::Depth() const {
+  return rep_ != nullptr ? rep_->depth : 0;
+}
+
+uintptr_t StackTrace::Address(size_t index) const {
+  return rep_->addresses[index];
+}
+
+const std::vector<StackTrace::Frame>& StackTrace::Frames() const {
+  static const std::vector<Frame> kNoFrames;
+
+  if (rep_ == nullptr) {
+    return kNoFrames;
+  }
+
+  std::call_once(rep_->symbolized, [rep = rep_] {
+    rep->frames.reserve(rep->depth);
+    for (size_t i = 0; i < rep->depth; ++i) {
+      rep->frames.push_back(Symbolize(rep->addresses[i]));
+    }
+  });
+
+  return rep_->frames;
+}
+
+std::string StackTrace::Describe() const {
+  std::stringstream out;
+  size_t index = 0;
+  for (const auto& frame : Frames()) {
+    out << "  #" << index++ << " 0x" << std::hex << frame.address << std::dec;
+    if (!frame.function.empty()) {
+      out << " in " << frame.function << "+" << frame.offset;
+    }
+    if (!frame.module.empty()) {
+      out << " (" << frame.module << ")";
+    }
+    out << "\n";
+  }
+  return out.str();
+}
+
+//////////////////////////////////////////////////////////////////////
+
+namespace {
+
+class StackCapturePolicy {
+  // Small codes (all canonical ones) are checked with a single load
+  static constexpr int32_t kMaskCodes = 64;
+
+  // Sites: two-level bitmap, lock-free reads
+  static constexpr size_t kChunkBits = 4096;
+  static constexpr size_t kMaxChunks = 4096;
+
+  using Chunk = std::array<std::atomic<uint64_t>, kChunkBits / 64>;
+
+ public:
+  void SetCode(int32_t code, bool enable) {
+    std::lock_guard guard(mutex_);
+
+    bool changed;
+    if (code >= 0 && code < kMaskCodes) {
+      uint64_t bit = uint64_t{1} << code;
+      uint64_t prev = enable ? code_mask_.fetch_or(bit, std::memory_order_relaxed)
+                             : code_mask_.fetch_and(~bit, std::memory_order_relaxed);
+      changed = ((prev & bit) != 0) != enable;
+    } else {
+      changed = enable ? other_codes_.insert(code).second
+                       : other_codes_.erase(code) > 0;
+      other_codes_count_.store(other_codes_.size(), std::memory_order_relaxed);
+    }
+
+    Count(changed, enable);
+  }
+
+  void SetSite(SiteId site, bool enable) {
+    std::lock_guard guard(mutex_);
+
+    size_t chunk = site / kChunkBits;
+    if (chunk >= kMaxChunks) {
+      return;
+    }
+
+    Chunk* bits = chunks_[chunk].load(std::memory_order_relaxed);
+    if (bits == nullptr) {
+      if (!enable) {
+        return;
+      }
+      bits = new Chunk{};
+      chunks_[chunk].store(bits, std::memory_order_release);
+    }
+
+    size_t index = site % kChunkBits;
+    uint64_t bit = uint64_t{1} << (index % 64);
+    auto& word = (*bits)[index / 64];
+    uint64_t prev = enable ? word.fetch_or(bit, std::memory_order_relaxed)
+                           : word.fetch_and(~bit, std::memory_order_relaxed);
+
+    Count(((prev & bit) != 0) != enable, enable);
+  }
+
+  bool Matches(int32_t code, SiteId site) const {
+    if (code >= 0 && code < kMaskCodes) {
+      if (code_mask_.load(std::memory_order_relaxed) & (uint64_t{1} << code)) {
+        return true;
+      }
+    } else if (other_codes_count_.load(std::memory_order_relaxed) > 0) {
+      std::lock_guard guard(mutex_);
+      if (other_codes_.contains(code)) {
+        return true;
+      }
+    }
+
+    size_t chunk = site / kChunkBits;
+    if (site == 0 || chunk >= kMaxChunks) {
+      return false;
+    }
+    Chunk* bits = chunks_[chunk].load(std::memory_order_acquire);
+    if (bits == nullptr) {
+      return false;
+    }
+    size_t index = site % kChunkBits;
+    return (*bits)[index / 64].load(std::memory_order_relaxed) & (uint64_t{1} << (index % 64));
+  }
+
+ private:
+  // Guarded by mutex_
+  void Count(bool changed, bool enable) {
+    if (changed) {
+      if (enable) {
+        detail::stack_capture_rules.fetch_add(1, std::memory_order_relaxed);
+      } else {
+        detail::stack_capture_rules.fetch_sub(1, std::memory_order_relaxed);
+      }
+    }
+  }
+
+ private:
+  std::atomic<uint64_t> code_mask_{0};
+  std::array<std::atomic<Chunk*>, kMaxChunks> chunks_{};
+
+  mutable std::mutex mutex_;
+  std::set<int32_t> other_codes_;
+  std::atomic<size_t> other_codes_count_{0};
+};
+
+StackCapturePolicy& Policy() {
+  return LeakySingleton<StackCapturePolicy>();
+}
+
+}  // namespace
+
+namespace detail {
+
+std::atomic<size_t> stack_capture_rules{0};
+
+bool ShouldCaptureStackSlow(int32_t code, SiteId site) {
+  return Policy().Matches(code, site);
+}
+
+}  // namespace detail
+
+void CaptureStacksForCode(int32_t code, bool enable) {
+  Policy().SetCode(code, enable);
+}
+
+void CaptureStacksForSite(SiteId site, bool enable) {
+  Policy().SetSite(site, enable);
+}
+
+}  // namespace fallible
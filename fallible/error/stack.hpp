@@ -0,0 +1,104 @@
+#pragma once
+
+#include <fallible/context/site.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace fallible {
+
+//////////////////////////////////////////////////////////////////////
+
+// Raw stack of return addresses captured by walking frame pointers
+// (the library is compiled with -fno-omit-frame-pointer)
+//
+// Capture costs a few loads per frame and a single allocation,
+// symbolization is deferred until the first Frames() / Describe() call
+// and cached, copies of the trace share both
+//
+// Symbols are resolved with dladdr: executables should be linked with
+// -rdynamic (ENABLE_EXPORTS in CMake) to name their own functions
+
+class StackTrace {
+  struct Rep;
+
+ public:
+  static constexpr size_t kMaxDepth = 32;
+
+  struct Frame {
+    uintptr_t address;
+    // Demangled, empty if unknown
+    std::string function;
+    // Shared object or executable
+    std::string module;
+    uintptr_t offset;
+  };
+
+  // Empty
+  StackTrace() = default;
+
+  // Skips `skip` innermost frames in addition to Capture itself
+  static StackTrace Capture(size_t skip = 0);
+
+  StackTrace(const StackTrace& that);
+  StackTrace(StackTrace&& that) noexcept;
+  StackTrace& operator=(StackTrace that) noexcept;
+  ~StackTrace();
+
+  bool IsEmpty() const {
+    return rep_ == nullptr;
+  }
+
+  // Innermost first
+  size_t Depth() const;
+  uintptr_t Address(size_t index) const;
+
+  // Symbolized on the first call, thread-safe
+  const std::vector<Frame>& Frames() const;
+
+  std::string Describe() const;
+
+ private:
+  Rep* rep_ = nullptr;
+};
+
+//////////////////////////////////////////////////////////////////////
+
+// Capture policy, stacks are not captured by default
+//
+// Errors created by Err() / FALLIBLE_ERR capture a stack if capture is
+// enabled for their code or their call site. Wrap frames never capture,
+// their cause already has a stack.
+//
+// Usage:
+//
+//   fallible::CaptureStacksForCode(fallible::ErrorCodes::Internal);
+//   fallible::CaptureStacksForSite(site_id);
+
+void CaptureStacksForCode(int32_t code, bool enable = true);
+void CaptureStacksForSite(SiteId site, bool enable = true);
+
+namespace detail {
+
+// Set while capture is enabled for any code or site
+extern std::atomic<size_t> stack_capture_rules;
+
+bool ShouldCaptureStackSlow(int32_t code, SiteId site);
+
+// Single relaxed load when capture is disabled:
+// `site` () -> SiteId is called only if some rule is set,
+// resolving the site of an interned location is not free
+template <typename SiteFn>
+bool ShouldCaptureStack(int32_t code, SiteFn site) {
+  if (stack_capture_rules.load(std::memory_order_relaxed) == 0) {
+    return false;
+  }
+  return ShouldCaptureStackSlow(code, site());
+}
+
+}  // namespace detail
+
+}  // namespace fallible
@@ -1,22 +1,55 @@
 #pragma once
 
+#include <fallible/error/codes.hpp>
 #include <fallible/error/error.hpp>
 
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+
 namespace fallible {
 
+// Description is rendered on the first what() call:
+// exceptions caught and handled by code never pay for it
+// If rendering fails (e.g. std::bad_alloc), what() returns the code name
+
 class ErrorException : public std::runtime_error {
+  struct Description {
+    std::once_flag once;
+    std::string text;
+  };
+
  public:
   ErrorException(Error e)
-      : std::runtime_error(e.Describe()),
-        error_(std::move(e)) {
+      : std::runtime_error("fallible::ErrorException"),
+        error_(std::move(e)),
+        description_(std::make_shared<Description>()),
+        code_name_(FindErrorCodeName(error_.Code()).value_or("fallible::ErrorException").data()) {
   }
 
   const Error& GetError() const {
     return error_;
   }
 
+  const char* what() const noexcept override {
+    try {
+      std::call_once(description_->once, [this] {
+        description_->text = error_.Describe();
+      });
+    } catch (...) {
+      // The flag stays unset, the next call retries
+      return code_name_;
+    }
+    return description_->text.c_str();
+  }
+
  private:
   Error error_;
+  // Shared by copies of the exception
+  std::shared_ptr<Description> description_;
+  // Literal (see ErrorCode), static fallback of what()
+  const char* code_name_;
 };
 
 [[noreturn]] inline void ThrowError(Error e) {
@@ -0,0 +1,32 @@
+#include <fallible/error/trace.hpp>
+
+#include <sstream>
+
+namespace fallible {
+
+SiteId ReturnTrace::Site(size_t index) const {
+  const Hop& hop = (*this)[index];
+  return InternCallSite(hop.file, hop.function, hop.line);
+}
+
+std::string ReturnTrace::Describe() const {
+  std::stringstream out;
+  if (Dropped() > 0) {
+    out << "  ... " << Dropped() << " older hops\n";
+  }
+  for (size_t i = 0; i < Size(); ++i) {
+    const Hop& hop = (*this)[i];
+    out << "  " << hop.file << ":" << hop.line << " in " << hop.function << "\n";
+  }
+  return out.str();
+}
+
+ReturnTrace GetReturnTrace(const Error& error) {
+  const ReturnTrace& trace = detail::current_return_trace;
+  if (detail::ReturnTraces::Matches(trace, error)) {
+    return trace;
+  }
+  return {};
+}
+
+}  // namespace fallible
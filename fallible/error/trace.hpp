@@ -0,0 +1,138 @@
+#pragma once
+
+#include <fallible/error/error.hpp>
+
+#include <fallible/context/site.hpp>
+#include <fallible/telemetry/counters.hpp>
+
+#include <wheels/core/source_location.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace fallible {
+
+//////////////////////////////////////////////////////////////////////
+
+// Error return trace, similar to Zig's
+//
+// Each thread records the hops (PropagateError, WrapError, Map, ...)
+// that its most recent error passes through: a few stores per hop into
+// a fixed-capacity ring, no allocations. Creating a new error restarts
+// the trace, errors sent to another thread start a new trace there.
+// Flyweights (see StaticError) are never rebuilt: fallible::Fail
+// restarts their trace, Result<T>::Fail does not.
+//
+// Traces are keyed by the error word. Code-only errors have no identity:
+// two of them with the same code and site are the same word, so hops of
+// one can not be told apart from hops of the other. Creating such an
+// error while an equal one holds the trace makes the trace ambiguous:
+// GetReturnTrace returns an empty trace until a different error starts
+// a new one. Errors with a reason or attributes are always distinct.
+
+class ReturnTrace {
+ public:
+  static constexpr size_t kCapacity = 32;
+
+  struct Hop {
+    const char* file;
+    const char* function;
+    int line;
+  };
+
+  // Recorded hops, <= kCapacity
+  size_t Size() const {
+    return total_ < kCapacity ? total_ : kCapacity;
+  }
+
+  bool IsEmpty() const {
+    return total_ == 0;
+  }
+
+  // Oldest hops overwritten by the ring
+  size_t Dropped() const {
+    return total_ - Size();
+  }
+
+  // Oldest first
+  const Hop& operator[](size_t index) const {
+    return hops_[(Dropped() + index) % kCapacity];
+  }
+
+  // Interned on demand, see context/site.hpp
+  SiteId Site(size_t index) const;
+
+  std::string Describe() const;
+
+ private:
+  friend struct detail::ReturnTraces;
+
+  uintptr_t key_ = 0;
+  // Equal code-only errors share `key_`, see above
+  bool ambiguous_ = false;
+  size_t total_ = 0;
+  Hop hops_[kCapacity]{};
+};
+
+// Trace of `error` if it is the most recent error created or propagated
+// by the current thread, empty otherwise or if ambiguous
+ReturnTrace GetReturnTrace(const Error& error);
+
+//////////////////////////////////////////////////////////////////////
+
+namespace detail {
+
+// Current trace of the calling thread, trivially initialized
+constinit inline thread_local ReturnTrace current_return_trace{};
+
+struct ReturnTraces {
+  static void Start(const Error& error) {
+    ReturnTrace& trace = current_return_trace;
+    trace.ambiguous_ = error.IsInline() && trace.key_ == error.word_;
+    trace.key_ = error.word_;
+    trace.total_ = 0;
+  }
+
+  // Wrap frame continues the trace of its cause
+  static void Continue(const Error& cause, const Error& frame) {
+    ReturnTrace& trace = current_return_trace;
+    if (trace.key_ == cause.word_) {
+      trace.key_ = frame.word_;
+    } else {
+      Start(frame);
+    }
+  }
+
+  static void Record(const Error& error, wheels::SourceLocation where) {
+    ReturnTrace& trace = current_return_trace;
+    if (trace.key_ != error.word_) {
+      // Created by another thread or before the most recent error
+      Start(error);
+    }
+    trace.hops_[trace.total_ % ReturnTrace::kCapacity] = {
+        std::string_view(where.File()).data(),
+        std::string_view(where.Function()).data(), where.Line()};
+    ++trace.total_;
+  }
+
+  static bool Matches(const ReturnTrace& trace, const Error& error) {
+    return trace.key_ == error.word_ && !trace.ambiguous_;
+  }
+};
+
+// Propagation hook: return trace and telemetry
+// Lightweight errors are not traced
+template <typename E>
+void RecordReturn(const E& error, wheels::SourceLocation where) {
+  if constexpr (std::is_same_v<E, Error>) {
+    ReturnTraces::Record(error, where);
+    CountError(ErrorEvent::Propagated, error);
+  }
+}
+
+}  // namespace detail
+
+}  // namespace fallible
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <fallible/error/error.hpp>
+
+#include <concepts>
+#include <type_traits>
+#include <utility>
+
+namespace fallible {
+
+//////////////////////////////////////////////////////////////////////
+
+/*
+ * Lightweight error type for Result<T, E>: small enum or struct
+ * with cheap widening conversion to the canonical Error found via ADL
+ *
+ * Example:
+ *
+ * namespace parser {
+ *
+ * enum class ParseError { Eof, BadChar };
+ *
+ * fallible::Error ToError(ParseError e) {
+ *   return fallible::Err(fallible::ErrorCodes::Invalid);
+ * }
+ *
+ * }  // namespace parser
+ */
+
+// clang-format off
+
+template <typename E>
+concept WidensToError = requires (const E& error) {
+  { ToError(error) } -> std::same_as<Error>;
+};
+
+// clang-format on
+
+//////////////////////////////////////////////////////////////////////
+
+namespace detail {
+
+// E -> E, E -> Error
+template <typename To, typename From>
+To WidenError(From error) {
+  if constexpr (std::is_same_v<To, From>) {
+    return error;
+  } else {
+    static_assert(std::is_same_v<To, Error> && WidensToError<From>,
+                  "No widening conversion between error types");
+    return ToError(std::as_const(error));
+  }
+}
+
+// To is E or Error
+template <typename To, typename E>
+concept WidensFrom = std::same_as<To, E> ||
+                     (std::same_as<To, Error> && WidensToError<E>);
+
+}  // namespace detail
+
+}  // namespace fallible
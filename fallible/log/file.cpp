@@ -0,0 +1,213 @@
+#include <fallible/log/file.hpp>
+
+#include <fallible/wire/codec.hpp>
+
+#include <fallible/error/codes.hpp>
+#include <fallible/result/make.hpp>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+
+namespace fallible {
+
+//////////////////////////////////////////////////////////////////////
+
+namespace {
+
+constexpr char kMagic[8] = {'F', 'A', 'L', 'E', 'L', 'O', 'G', '1'};
+
+// size:u32 time_ns:u64
+constexpr size_t kRecordHeaderSize = 12;
+
+// Appended in batches
+constexpr size_t kFlushThreshold = 64 * 1024;
+
+uint64_t NowNs() {
+  auto now = std::chrono::system_clock::now().time_since_epoch();
+  return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now).count());
+}
+
+template <typename T>
+void PutFixed(std::string& out, T value) {
+  char bytes[sizeof(T)];
+  std::memcpy(bytes, &value, sizeof(T));
+  out.append(bytes, sizeof(T));
+}
+
+template <typename T>
+T GetFixed(const char* data) {
+  T value;
+  std::memcpy(&value, data, sizeof(T));
+  return value;
+}
+
+Status WriteAll(int fd, std::string_view bytes, const std::string& path) {
+  while (!bytes.empty()) {
+    ssize_t written = ::write(fd, bytes.data(), bytes.size());
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return Fail(Err(FromErrno{}).Attr("path", path).Done());
+    }
+    bytes.remove_prefix(static_cast<size_t>(written));
+  }
+  return Ok();
+}
+
+}  // namespace
+
+//////////////////////////////////////////////////////////////////////
+
+Result<std::unique_ptr<ErrorLogSink>> ErrorLogSink::Open(const std::string& path) {
+  int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+  if (fd < 0) {
+    return Fail(Err(FromErrno{}).Attr("path", path).Done());
+  }
+
+  struct stat st;
+  if (::fstat(fd, &st) != 0) {
+    int err = errno;
+    ::close(fd);
+    return Fail(Err(FromErrno{err}).Attr("path", path).Done());
+  }
+
+  if (st.st_size == 0) {
+    auto status = WriteAll(fd, {kMagic, sizeof(kMagic)}, path);
+    if (status.Failed()) {
+      ::close(fd);
+      return PropagateError(status);
+    }
+  }
+
+  return Ok(std::unique_ptr<ErrorLogSink>{new ErrorLogSink(fd, path)});
+}
+
+ErrorLogSink::ErrorLogSink(int fd, std::string path)
+    : fd_(fd), path_(std::move(path)) {
+}
+
+ErrorLogSink::~ErrorLogSink() {
+  Flush().Ignore("Best effort on close");
+  ::close(fd_);
+}
+
+Status ErrorLogSink::Write(const Error& error) {
+  return Write(error, NowNs());
+}
+
+Status ErrorLogSink::Write(const Error& error, uint64_t time_ns) {
+  std::lock_guard guard(mutex_);
+
+  size_t start = buffer_.size();
+  PutFixed<uint32_t>(buffer_, 0);
+  PutFixed<uint64_t>(buffer_, time_ns);
+  EncodeError(error, buffer_);
+
+  auto size = static_cast<uint32_t>(buffer_.size() - start - kRecordHeaderSize);
+  std::memcpy(buffer_.data() + start, &size, sizeof(size));
+
+  if (buffer_.size() >= kFlushThreshold) {
+    return FlushLocked();
+  }
+  return Ok();
+}
+
+Status ErrorLogSink::Flush() {
+  std::lock_guard guard(mutex_);
+  return FlushLocked();
+}
+
+Status ErrorLogSink::FlushLocked() {
+  if (broken_) {
+    buffer_.clear();
+    return Fail(Err(ErrorCodes::Aborted)
+                    .Domain("ErrorLog")
+                    .Reason("Torn record at the end of the log")
+                    .Attr("path", path_)
+                    .Done());
+  }
+  if (buffer_.empty()) {
+    return Ok();
+  }
+
+  struct stat st;
+  if (::fstat(fd_, &st) != 0) {
+    return Fail(Err(FromErrno{}).Attr("path", path_).Done());
+  }
+
+  // One writer per file: a short write is continued by another write(),
+  // so concurrent appends from other processes could interleave with it,
+  // and the truncation below would cut their records off
+  auto status = WriteAll(fd_, buffer_, path_);
+  buffer_.clear();
+
+  if (status.Failed()) {
+    // Partial write (e.g. ENOSPC): cut the torn records off, otherwise
+    // the next flush appends after them and readers lose the framing
+    int rc;
+    do {
+      rc = ::ftruncate(fd_, st.st_size);
+    } while (rc != 0 && errno == EINTR);
+    broken_ = rc != 0;
+  }
+  return status;
+}
+
+//////////////////////////////////////////////////////////////////////
+
+Result<Error> ErrorLogRecord::Decode() const {
+  return DecodeError(bytes);
+}
+
+Result<ErrorLogFile> ErrorLogFile::Open(const std::string& path) {
+  auto file = MappedFile::Open(path);
+  if (file.Failed()) {
+    return PropagateError(file);
+  }
+
+  if (file->Size() < sizeof(kMagic) ||
+      std::memcmp(file->Bytes().data(), kMagic, sizeof(kMagic)) != 0) {
+    return Fail(Err(ErrorCodes::Invalid)
+                    .Domain("ErrorLog")
+                    .Reason("Not an error log file")
+                    .Attr("path", path)
+                    .Done());
+  }
+
+  return Ok(ErrorLogFile{std::move(*file)});
+}
+
+uint64_t ErrorLogFile::Begin() {
+  return sizeof(kMagic);
+}
+
+std::optional<ErrorLogRecord> ErrorLogFile::RecordAt(uint64_t offset) const {
+  std::string_view bytes = file_.Bytes();
+  if (offset > bytes.size() || bytes.size() - offset < kRecordHeaderSize) {
+    return std::nullopt;
+  }
+
+  const char* header = bytes.data() + offset;
+  auto size = GetFixed<uint32_t>(header);
+  if (bytes.size() - offset - kRecordHeaderSize < size) {
+    return std::nullopt;  // Torn tail
+  }
+
+  return ErrorLogRecord{
+      .offset = offset,
+      .time_ns = GetFixed<uint64_t>(header + 4),
+      .bytes = bytes.substr(offset + kRecordHeaderSize, size),
+  };
+}
+
+uint64_t ErrorLogFile::Next(const ErrorLogRecord& record) {
+  return record.offset + kRecordHeaderSize + record.bytes.size();
+}
+
+}  // namespace fallible
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <fallible/error/error.hpp>
+#include <fallible/result/result.hpp>
+#include <fallible/support/mapped_file.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace fallible {
+
+//////////////////////////////////////////////////////////////////////
+
+// Binary error log: append-only file of timestamped errors,
+// written by ErrorLogSink, indexed and queried by log/index.hpp
+// and the fallible-errlog tool
+//
+//   file   := magic:8 record*
+//   record := size:u32 time_ns:u64 error
+// Little-endian, errors in the wire format of wire/codec.hpp
+
+//////////////////////////////////////////////////////////////////////
+
+// File sink
+//
+// Thread-safe, errors are buffered and appended to the file
+// in batches, see Flush. A failed flush drops its batch and
+// truncates the file back to the last complete record
+//
+// One sink (and one process) per file: batches are not written
+// atomically, concurrent writers of the same file would interleave
+//
+// Usage:
+//   auto sink = fallible::ErrorLogSink::Open("/var/log/app.errlog").ExpectValue();
+//   ...
+//   sink->Write(result.Error()).Ignore("Best effort");
+
+class ErrorLogSink {
+ public:
+  static Result<std::unique_ptr<ErrorLogSink>> Open(const std::string& path);
+
+  ErrorLogSink(const ErrorLogSink&) = delete;
+  ErrorLogSink& operator=(const ErrorLogSink&) = delete;
+
+  // Flushes
+  ~ErrorLogSink();
+
+  // Timestamped with the current time
+  Status Write(const Error& error);
+  Status Write(const Error& error, uint64_t time_ns);
+
+  Status Flush();
+
+ private:
+  ErrorLogSink(int fd, std::string path);
+
+  Status FlushLocked();
+
+ private:
+  std::mutex mutex_;
+  int fd_;
+  std::string path_;
+  std::string buffer_;
+  // A failed flush could not cut off its partial write:
+  // appending after it would corrupt the log
+  bool broken_ = false;
+};
+
+//////////////////////////////////////////////////////////////////////
+
+// Reader
+
+struct ErrorLogRecord {
+  // In the file, identifies the record
+  uint64_t offset;
+  uint64_t time_ns;
+  // Encoded error
+  std::string_view bytes;
+
+  Result<Error> Decode() const;
+};
+
+class ErrorLogFile {
+ public:
+  static Result<ErrorLogFile> Open(const std::string& path);
+
+  // Offset of the first record
+  static uint64_t Begin();
+
+  // Mapped size
+  uint64_t End() const {
+    return file_.Size();
+  }
+
+  // std::nullopt at the end of the file or at a partially written record
+  std::optional<ErrorLogRecord> RecordAt(uint64_t offset) const;
+
+  // Offset of the record following `record`
+  static uint64_t Next(const ErrorLogRecord& record);
+
+ private:
+  explicit ErrorLogFile(MappedFile file)
+      : file_(std::move(file)) {
+  }
+
+ private:
+  MappedFile file_;
+};
+
+}  // namespace fallible
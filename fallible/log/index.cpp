@@ -0,0 +1,493 @@
+#include <fallible/log/index.hpp>
+
+#include <fallible/log/file.hpp>
+
+#include <fallible/error/codes.hpp>
+#include <fallible/result/make.hpp>
+#include <fallible/support/hash.hpp>
+#include <fallible/support/mapped_file.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+#include <span>
+#include <string_view>
+#include <tuple>
+
+namespace fallible {
+
+//////////////////////////////////////////////////////////////////////
+
+// Index layout, little-endian:
+//   [IndexHeader][IndexRecord x record_count][IndexTerm x term_count][u32 postings]
+// Records are sorted by (time, offset), postings are sorted record ordinals.
+// Terms are identified by hash: collisions only add candidates,
+// which are filtered by Matches.
+
+namespace {
+
+constexpr char kIndexMagic[8] = {'F', 'A', 'L', 'E', 'I', 'D', 'X', '2'};
+
+struct IndexHeader {
+  char magic[8];
+  // Indexed prefix of the log
+  uint64_t log_size;
+  // Last record of the prefix in file order
+  uint64_t last_offset;
+  // See PrefixHash
+  uint64_t prefix_hash;
+  uint64_t record_count;
+  uint64_t term_count;
+};
+
+struct IndexRecord {
+  uint64_t time_ns;
+  uint64_t offset;
+};
+
+struct IndexTerm {
+  uint64_t hash;
+  // In postings
+  uint64_t start;
+  uint64_t count;
+};
+
+//////////////////////////////////////////////////////////////////////
+
+// Terms
+
+uint64_t TermHash(std::string_view kind, std::string_view term) {
+  return detail::HashBytes(term, detail::HashBytes(kind));
+}
+
+std::string_view BaseName(std::string_view path) {
+  size_t slash = path.rfind('/');
+  return slash == std::string_view::npos ? path : path.substr(slash + 1);
+}
+
+std::string SiteTerm(std::string_view file, int line) {
+  std::string term{BaseName(file)};
+  term += ':';
+  term += std::to_string(line);
+  return term;
+}
+
+template <typename F>
+void ForEachTerm(const Error& error, F&& visit) {
+  visit(TermHash("code", std::to_string(error.Code())));
+  visit(TermHash("domain", error.Domain()));
+
+  for (const Error* frame = &error; frame != nullptr; frame = frame->Cause()) {
+    // Decoded records carry remote locations, see wire/codec.hpp
+    if (auto where = frame->SourceLocation(); !where.File().empty()) {
+      visit(TermHash("site", SiteTerm(where.File(), where.Line())));
+    }
+    for (const auto& attr : frame->Attrs()) {
+      std::string key{attr.key.Name()};
+      visit(TermHash("attr", key));
+      visit(TermHash("attr", key + "=" + attr.value.Format()));
+    }
+  }
+}
+
+// `file:line`
+std::optional<std::pair<std::string_view, int>> ParseSite(std::string_view site) {
+  size_t colon = site.rfind(':');
+  if (colon == std::string_view::npos) {
+    return std::nullopt;
+  }
+  int line = 0;
+  for (char digit : site.substr(colon + 1)) {
+    if (digit < '0' || digit > '9') {
+      return std::nullopt;
+    }
+    line = line * 10 + (digit - '0');
+  }
+  return std::pair{site.substr(0, colon), line};
+}
+
+// Hashes of the terms required by the query
+// std::nullopt: the query matches nothing
+std::optional<std::vector<uint64_t>> QueryTerms(const ErrorLogQuery& query) {
+  std::vector<uint64_t> terms;
+  if (query.code) {
+    terms.push_back(TermHash("code", std::to_string(*query.code)));
+  }
+  if (query.domain) {
+    terms.push_back(TermHash("domain", *query.domain));
+  }
+  if (query.site) {
+    auto site = ParseSite(*query.site);
+    if (!site) {
+      return std::nullopt;
+    }
+    terms.push_back(TermHash("site", SiteTerm(site->first, site->second)));
+  }
+  for (const auto& attr : query.attrs) {
+    terms.push_back(TermHash("attr", attr));
+  }
+  return terms;
+}
+
+//////////////////////////////////////////////////////////////////////
+
+// Identity of the indexed prefix: its size and its first and last records
+// A rotated or rewritten log does not reuse a stale index
+uint64_t PrefixHash(const ErrorLogFile& log, uint64_t log_size, uint64_t last_offset) {
+  uint64_t hash = detail::HashCombine(detail::kHashSeed, log_size);
+  for (uint64_t offset : {ErrorLogFile::Begin(), last_offset}) {
+    auto record = log.RecordAt(offset);
+    if (record && ErrorLogFile::Next(*record) <= log_size) {
+      hash = detail::HashCombine(hash, record->time_ns);
+      hash = detail::HashBytes(record->bytes, hash);
+    }
+  }
+  return hash;
+}
+
+//////////////////////////////////////////////////////////////////////
+
+Status WriteFile(const std::string& path, const std::string& bytes) {
+  std::string tmp_path = path + ".tmp";
+
+  FILE* file = std::fopen(tmp_path.c_str(), "w");
+  if (file == nullptr) {
+    return Fail(Err(FromErrno{}).Attr("path", tmp_path).Done());
+  }
+
+  bool written = std::fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size();
+  int err = errno;
+  if (std::fclose(file) != 0 && written) {
+    written = false;
+    err = errno;
+  }
+  if (!written) {
+    std::remove(tmp_path.c_str());
+    return Fail(Err(FromErrno{err}).Attr("path", tmp_path).Done());
+  }
+
+  if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+    return Fail(Err(FromErrno{}).Attr("path", path).Done());
+  }
+
+  return Ok();
+}
+
+template <typename T>
+void Append(std::string& out, const T& value) {
+  out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+//////////////////////////////////////////////////////////////////////
+
+// Validated view of a mapped index
+class IndexView {
+ public:
+  static std::optional<IndexView> Open(std::string_view bytes, const ErrorLogFile& log) {
+    if (bytes.size() < sizeof(IndexHeader)) {
+      return std::nullopt;
+    }
+    const auto* header = reinterpret_cast<const IndexHeader*>(bytes.data());
+    if (std::memcmp(header->magic, kIndexMagic, sizeof(kIndexMagic)) != 0 ||
+        header->log_size > log.End()) {
+      return std::nullopt;  // Not an index or the log was truncated
+    }
+    if (header->prefix_hash != PrefixHash(log, header->log_size, header->last_offset)) {
+      return std::nullopt;  // Index of another log
+    }
+
+    size_t available = bytes.size() - sizeof(IndexHeader);
+    if (header->record_count > available / sizeof(IndexRecord)) {
+      return std::nullopt;
+    }
+    available -= header->record_count * sizeof(IndexRecord);
+    if (header->term_count > available / sizeof(IndexTerm)) {
+      return std::nullopt;
+    }
+    available -= header->term_count * sizeof(IndexTerm);
+
+    IndexView view;
+    view.header_ = header;
+    view.records_ = {reinterpret_cast<const IndexRecord*>(header + 1),
+                     header->record_count};
+    view.terms_ = {reinterpret_cast<const IndexTerm*>(view.records_.data() + view.records_.size()),
+                   header->term_count};
+    view.postings_ = {reinterpret_cast<const uint32_t*>(view.terms_.data() + view.terms_.size()),
+                      available / sizeof(uint32_t)};
+
+    for (const IndexTerm& term : view.terms_) {
+      if (term.start > view.postings_.size() ||
+          term.count > view.postings_.size() - term.start) {
+        return std::nullopt;
+      }
+      // Ordinals index records directly
+      auto postings = view.postings_.subspan(term.start, term.count);
+      for (size_t i = 0; i < postings.size(); ++i) {
+        if (postings[i] >= view.records_.size() ||
+            (i > 0 && postings[i] <= postings[i - 1])) {
+          return std::nullopt;
+        }
+      }
+    }
+    return view;
+  }
+
+  uint64_t LogSize() const {
+    return header_->log_size;
+  }
+
+  std::span<const IndexRecord> Records() const {
+    return records_;
+  }
+
+  // Empty if the term does not occur
+  std::span<const uint32_t> Postings(uint64_t hash) const {
+    auto it = std::lower_bound(terms_.begin(), terms_.end(), hash,
+                               [](const IndexTerm& term, uint64_t hash) {
+                                 return term.hash < hash;
+                               });
+    if (it == terms_.end() || it->hash != hash) {
+      return {};
+    }
+    return postings_.subspan(it->start, it->count);
+  }
+
+ private:
+  const IndexHeader* header_ = nullptr;
+  std::span<const IndexRecord> records_;
+  std::span<const IndexTerm> terms_;
+  std::span<const uint32_t> postings_;
+};
+
+// Sorted candidate ordinals in [begin, end)
+std::vector<uint32_t> Candidates(const IndexView& index,
+                                 const std::vector<uint64_t>& terms,
+                                 uint32_t begin, uint32_t end) {
+  std::vector<uint32_t> candidates;
+
+  if (terms.empty()) {
+    candidates.reserve(end - begin);
+    for (uint32_t ordinal = begin; ordinal < end; ++ordinal) {
+      candidates.push_back(ordinal);
+    }
+    return candidates;
+  }
+
+  // Start from the rarest term
+  std::vector<std::span<const uint32_t>> lists;
+  for (uint64_t term : terms) {
+    lists.push_back(index.Postings(term));
+  }
+  std::sort(lists.begin(), lists.end(), [](const auto& lhs, const auto& rhs) {
+    return lhs.size() < rhs.size();
+  });
+
+  auto first = std::lower_bound(lists[0].begin(), lists[0].end(), begin);
+  auto last = std::lower_bound(first, lists[0].end(), end);
+  candidates.assign(first, last);
+
+  for (size_t i = 1; i < lists.size() && !candidates.empty(); ++i) {
+    std::vector<uint32_t> intersection;
+    std::set_intersection(candidates.begin(), candidates.end(),
+                          lists[i].begin(), lists[i].end(),
+                          std::back_inserter(intersection));
+    candidates = std::move(intersection);
+  }
+  return candidates;
+}
+
+bool InRange(uint64_t time_ns, const ErrorLogQuery& query) {
+  return (!query.since_ns || time_ns >= *query.since_ns) &&
+         (!query.until_ns || time_ns < *query.until_ns);
+}
+
+void Check(const ErrorLogRecord& record, const ErrorLogQuery& query,
+           std::vector<ErrorLogMatch>& matches) {
+  if (!InRange(record.time_ns, query)) {
+    return;
+  }
+  auto error = record.Decode();
+  if (error.IsOk() && Matches(*error, query)) {
+    matches.push_back({record.offset, record.time_ns, std::move(*error)});
+  }
+}
+
+}  // namespace
+
+//////////////////////////////////////////////////////////////////////
+
+bool Matches(const Error& error, const ErrorLogQuery& query) {
+  if (query.code && error.Code() != *query.code) {
+    return false;
+  }
+  if (query.domain && error.Domain() != *query.domain) {
+    return false;
+  }
+
+  if (query.site) {
+    auto site = ParseSite(*query.site);
+    if (!site) {
+      return false;
+    }
+    bool found = false;
+    for (const Error* frame = &error; frame != nullptr && !found; frame = frame->Cause()) {
+      auto where = frame->SourceLocation();
+      // Same rule as the indexed site term
+      found = !where.File().empty() && where.Line() == site->second &&
+              BaseName(where.File()) == BaseName(site->first);
+    }
+    if (!found) {
+      return false;
+    }
+  }
+
+  for (const auto& attr : query.attrs) {
+    size_t eq = attr.find('=');
+    std::string_view key = std::string_view{attr}.substr(0, eq);
+
+    bool found = false;
+    for (const Error* frame = &error; frame != nullptr && !found; frame = frame->Cause()) {
+      const AttrValue* value = frame->Attrs().Find(key);
+      found = value != nullptr &&
+              (eq == std::string::npos || value->Format() == attr.substr(eq + 1));
+    }
+    if (!found) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+std::string ErrorLogIndexPath(const std::string& log_path) {
+  return log_path + ".idx";
+}
+
+Status BuildErrorLogIndex(const std::string& log_path) {
+  auto log = ErrorLogFile::Open(log_path);
+  if (log.Failed()) {
+    return PropagateError(log);
+  }
+
+  std::vector<IndexRecord> records;
+  uint64_t offset = ErrorLogFile::Begin();
+  while (auto record = log->RecordAt(offset)) {
+    records.push_back({record->time_ns, record->offset});
+    offset = ErrorLogFile::Next(*record);
+  }
+  uint64_t log_size = offset;
+  uint64_t last_offset = records.empty() ? ErrorLogFile::Begin() : records.back().offset;
+
+  std::sort(records.begin(), records.end(), [](const auto& lhs, const auto& rhs) {
+    return std::tie(lhs.time_ns, lhs.offset) < std::tie(rhs.time_ns, rhs.offset);
+  });
+
+  // (term hash, ordinal)
+  std::vector<std::pair<uint64_t, uint32_t>> occurrences;
+  for (size_t ordinal = 0; ordinal < records.size(); ++ordinal) {
+    auto error = log->RecordAt(records[ordinal].offset)->Decode();
+    if (error.Failed()) {
+      continue;  // Not indexed, never matches
+    }
+    ForEachTerm(*error, [&](uint64_t hash) {
+      occurrences.emplace_back(hash, static_cast<uint32_t>(ordinal));
+    });
+  }
+  std::sort(occurrences.begin(), occurrences.end());
+  occurrences.erase(std::unique(occurrences.begin(), occurrences.end()), occurrences.end());
+
+  std::vector<IndexTerm> terms;
+  for (size_t i = 0; i < occurrences.size(); ++i) {
+    if (terms.empty() || terms.back().hash != occurrences[i].first) {
+      terms.push_back({occurrences[i].first, i, 0});
+    }
+    ++terms.back().count;
+  }
+
+  std::string bytes;
+  IndexHeader header{};
+  std::memcpy(header.magic, kIndexMagic, sizeof(kIndexMagic));
+  header.log_size = log_size;
+  header.last_offset = last_offset;
+  header.prefix_hash = PrefixHash(*log, log_size, last_offset);
+  header.record_count = records.size();
+  header.term_count = terms.size();
+  Append(bytes, header);
+  for (const auto& record : records) {
+    Append(bytes, record);
+  }
+  for (const auto& term : terms) {
+    Append(bytes, term);
+  }
+  for (const auto& [hash, ordinal] : occurrences) {
+    Append(bytes, ordinal);
+  }
+
+  return WriteFile(ErrorLogIndexPath(log_path), bytes);
+}
+
+Result<std::vector<ErrorLogMatch>> QueryErrorLog(const std::string& log_path,
+                                                 const ErrorLogQuery& query) {
+  auto log = ErrorLogFile::Open(log_path);
+  if (log.Failed()) {
+    return PropagateError(log);
+  }
+
+  std::vector<ErrorLogMatch> matches;
+
+  std::optional<std::vector<uint64_t>> terms = QueryTerms(query);
+  if (!terms) {
+    return Ok(std::move(matches));
+  }
+
+  // Optional: stale or missing index means full scan
+  auto index_file = MappedFile::Open(ErrorLogIndexPath(log_path));
+  std::optional<IndexView> index;
+  if (index_file.IsOk()) {
+    index = IndexView::Open(index_file->Bytes(), *log);
+  }
+
+  uint64_t tail = ErrorLogFile::Begin();
+
+  if (index) {
+    auto records = index->Records();
+    auto begin = std::lower_bound(records.begin(), records.end(), query.since_ns.value_or(0),
+                                  [](const IndexRecord& record, uint64_t time) {
+                                    return record.time_ns < time;
+                                  });
+    auto end = query.until_ns
+                   ? std::lower_bound(begin, records.end(), *query.until_ns,
+                                      [](const IndexRecord& record, uint64_t time) {
+                                        return record.time_ns < time;
+                                      })
+                   : records.end();
+
+    for (uint32_t ordinal : Candidates(*index, *terms,
+                                       static_cast<uint32_t>(begin - records.begin()),
+                                       static_cast<uint32_t>(end - records.begin()))) {
+      if (auto record = log->RecordAt(records[ordinal].offset)) {
+        Check(*record, query, matches);
+      }
+    }
+
+    tail = index->LogSize();
+  }
+
+  // Not indexed
+  while (auto record = log->RecordAt(tail)) {
+    Check(*record, query, matches);
+    tail = ErrorLogFile::Next(*record);
+  }
+
+  std::stable_sort(matches.begin(), matches.end(), [](const auto& lhs, const auto& rhs) {
+    return lhs.time_ns < rhs.time_ns;
+  });
+  if (matches.size() > query.limit) {
+    matches.erase(matches.begin() + static_cast<ptrdiff_t>(query.limit), matches.end());
+  }
+
+  return Ok(std::move(matches));
+}
+
+}  // namespace fallible
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <fallible/error/error.hpp>
+#include <fallible/result/result.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace fallible {
+
+//////////////////////////////////////////////////////////////////////
+
+// Offline index of error log files (see log/file.hpp)
+//
+// Maps terms (code, domain, call site, attribute key and key=value)
+// to posting lists of records sorted by time, so queries decode
+// only the candidates instead of scanning the whole log.
+// Stored next to the log as `<log>.idx`, memory-mapped on query.
+
+struct ErrorLogQuery {
+  std::optional<int32_t> code;
+  // Error::Domain
+  std::optional<std::string> domain;
+  // `file:line` of any frame, files match by base name:
+  // `dir/errlog.cpp:10` matches `errlog.cpp:10` and `other/errlog.cpp:10`
+  std::optional<std::string> site;
+  // `key` or `key=value` of any frame, values in AttrValue::Format form
+  std::vector<std::string> attrs;
+
+  // Since epoch, [since, until)
+  std::optional<uint64_t> since_ns;
+  std::optional<uint64_t> until_ns;
+
+  // Earliest matches
+  size_t limit = std::numeric_limits<size_t>::max();
+};
+
+struct ErrorLogMatch {
+  // Of the record in the log
+  uint64_t offset;
+  uint64_t time_ns;
+  Error error;
+};
+
+std::string ErrorLogIndexPath(const std::string& log_path);
+
+// Indexes complete records of the log, replaces the previous index
+Status BuildErrorLogIndex(const std::string& log_path);
+
+// Sorted by time
+// Uses the index if present: records appended after indexing are
+// scanned, a missing or stale index (the log was truncated, rotated
+// or rewritten) falls back to a full scan
+Result<std::vector<ErrorLogMatch>> QueryErrorLog(const std::string& log_path,
+                                                 const ErrorLogQuery& query);
+
+// Exact predicate applied to candidates, except the time range
+bool Matches(const Error& error, const ErrorLogQuery& query);
+
+}  // namespace fallible
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <fallible/result/result.hpp>
+#include <fallible/error/format.hpp>
+
+#include <wheels/core/unit.hpp>
+
+#include <fmt/format.h>
+
+#include <type_traits>
+
+// `{}`: Ok, Ok(value) for formattable values, Error(summary)
+template <typename T, typename E>
+struct fmt::formatter<fallible::Result<T, E>> {
+  constexpr auto parse(format_parse_context& ctx) {
+    return ctx.begin();
+  }
+
+  template <typename FormatContext>
+  auto format(const fallible::Result<T, E>& result, FormatContext& ctx) const {
+    if (result.IsOk()) {
+      if constexpr (!std::is_same_v<T, wheels::Unit> && fmt::is_formattable<T>::value) {
+        return fmt::format_to(ctx.out(), "Ok({})", *result);
+      } else {
+        return fmt::format_to(ctx.out(), "Ok");
+      }
+    } else {
+      if constexpr (fmt::is_formattable<E>::value) {
+        return fmt::format_to(ctx.out(), "Error({})", result.Error());
+      } else {
+        return fmt::format_to(ctx.out(), "Error");
+      }
+    }
+  }
+};
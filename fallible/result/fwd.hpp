@@ -1,11 +1,14 @@
 #pragma once
 
+#include <fallible/error/fwd.hpp>
+
 #include <wheels/core/unit.hpp>
 
 namespace fallible {
 
-// Result = T | Error
-template <typename T>
+// Result = T | E
+// E = Error by default, see error/widen.hpp for lightweight error types
+template <typename T, typename E = Error>
 class Result;
 
 // Status = Result<Unit> = Success | Error
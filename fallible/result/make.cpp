@@ -1,26 +1,31 @@
 #include <fallible/result/make.hpp>
 
 #include <fallible/error/codes.hpp>
+#include <fallible/error/trace.hpp>
+#include <fallible/telemetry/counters.hpp>
+#include <fallible/telemetry/flight.hpp>
 
 namespace fallible {
 
-detail::Failure Fail(Error error) {
-  return detail::Failure(std::move(error));
+detail::Failure<Error> Fail(Error error) {
+  if (error.IsImmortal()) {
+    // Flyweights are built once: every Fail is a new failure
+    detail::ReturnTraces::Start(error);
+    detail::CountError(ErrorEvent::Created, error);
+    detail::RecordFlight(error);
+  }
+  return detail::Failure<Error>(std::move(error));
 }
 
 Status ToStatus(std::error_code error) {
-  // TODO: match error codes
   if (error) {
-    return Fail(Err(error.value())
-                    .Domain(error.category().name())
-                    .Reason(error.message())
-                    .Done());
+    return Fail(Err(error).Done());
   } else {
     return Ok();
   }
 }
 
-detail::Failure NotSupported() {
+detail::Failure<Error> NotSupported() {
   return Fail(Err(ErrorCodes::NotSupported)
                   .Domain("Canonical")
                   .Reason("Not supported")
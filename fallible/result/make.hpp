@@ -3,6 +3,7 @@
 #include <fallible/result/result.hpp>
 #include <fallible/error/codes.hpp>
 #include <fallible/error/make.hpp>
+#include <fallible/error/trace.hpp>
 
 #include <wheels/core/exception.hpp>
 #include <wheels/core/unit.hpp>
@@ -26,9 +27,10 @@ inline Status Ok() {
 
 namespace detail {
 
+template <typename E>
 class [[nodiscard]] Failure {
  public:
-  explicit Failure(Error error) : error_(std::move(error)) {
+  explicit Failure(E error) : error_(std::move(error)) {
   }
 
   // Non-copyable
@@ -39,20 +41,20 @@ class [[nodiscard]] Failure {
   Failure(Failure&&) = delete;
   Failure& operator=(Failure&&) = delete;
 
-  // Implicit conversion to Result<T>
-  template <typename T>
-  operator Result<T>() {
-    return As<T>();
+  // Implicit conversion to Result<T, E2>, E2 = E or Error
+  template <typename T, WidensFrom<E> E2>
+  operator Result<T, E2>() {
+    return Result<T, E2>::Fail(WidenError<E2>(std::move(error_)));
   }
 
-  // Explicit conversion to Result<T>
+  // Explicit conversion to Result<T, E>
   template <typename T>
-  Result<T> As() {
-    return Result<T>::Fail(std::move(error_));
+  Result<T, E> As() {
+    return Result<T, E>::Fail(std::move(error_));
   }
 
  private:
-  Error error_;
+  E error_;
 };
 
 }  // namespace detail
@@ -68,7 +70,13 @@ class [[nodiscard]] Failure {
  * }
  */
 
-detail::Failure Fail(Error error);
+detail::Failure<Error> Fail(Error error);
+
+// Lightweight error, see error/widen.hpp
+template <WidensToError E>
+detail::Failure<E> Fail(E error) {
+  return detail::Failure<E>(std::move(error));
+}
 
 ////////////////////////////////////////////////////////////
 
@@ -86,21 +94,50 @@ detail::Failure Fail(Error error);
  * }
  */
 
-template <typename T>
-detail::Failure PropagateError(const Result<T>& result) {
-  return detail::Failure{result.Error()};
+template <typename T, typename E>
+detail::Failure<E> PropagateError(const Result<T, E>& result,
+                                  wheels::SourceLocation where = wheels::SourceLocation::Current()) {
+  detail::RecordReturn(result.Error(), where);
+  return detail::Failure<E>{result.Error()};
+}
+
+////////////////////////////////////////////////////////////
+
+/*
+ * Precondition: result.HasError()
+ *
+ * Propagates error with layer-specific context, see Wrap
+ *
+ * Example:
+ *
+ * fallible::Result<Widget> Foo() {
+ *   fallible::Result<Gadget> result = Bar();
+ *   if (result.HasError()) {
+ *     return fallible::Fail(
+ *        fallible::WrapError(result).Reason("Bar failed"));
+ *   }
+ *   // Happy path goes here
+ * }
+ */
+
+template <typename T, typename E>
+detail::ErrorBuilder WrapError(const Result<T, E>& result,
+                               wheels::SourceLocation loc = wheels::SourceLocation::Current()) {
+  detail::RecordReturn(result.Error(), loc);
+  return Wrap(detail::WidenError<Error>(result.Error()), loc);
 }
 
 ////////////////////////////////////////////////////////////
 
 // Erase value type to Unit
 
-template <typename T>
-Status JustStatus(const Result<T>& result) {
+template <typename T, typename E>
+Result<wheels::Unit, E> JustStatus(const Result<T, E>& result,
+                                   wheels::SourceLocation where = wheels::SourceLocation::Current()) {
   if (result.IsOk()) {
-    return Ok();
+    return Result<wheels::Unit, E>::Ok({});
   } else {
-    return PropagateError(result);
+    return PropagateError(result, where);
   }
 }
 
@@ -112,6 +149,6 @@ Status ToStatus(std::error_code error);
 ////////////////////////////////////////////////////////////
 
 // For tests
-detail::Failure NotSupported();
+detail::Failure<Error> NotSupported();
 
 }  // namespace fallible
@@ -28,28 +28,28 @@ concept ValueHandler = requires (F f, T value) {
 
 // ResultHandler
 
-template <typename F, typename T>
-concept ResultHandler = requires (F f, Result<T> result) {
+template <typename F, typename T, typename E = Error>
+concept ResultHandler = requires (F f, Result<T, E> result) {
   f(std::move(result));
 };
 
-template <typename F, typename T>
-concept ConstResultHandler = requires (F f, const Result<T>& result) {
+template <typename F, typename T, typename E = Error>
+concept ConstResultHandler = requires (F f, const Result<T, E>& result) {
   f(std::move(result));
 };
 
 // Result mapper: Result<T> -> Result<U>
 
-template <typename F, typename T>
-concept ResultMapper = requires (F f, Result<T> result) {
+template <typename F, typename T, typename E = Error>
+concept ResultMapper = requires (F f, Result<T, E> result) {
   { f(std::move(result)) } -> wheels::InstantiationOf<Result>;
 };
 
-// Error handler: Error -> Result<T>
+// Error handler: E -> Result<T, E>
 
-template <typename H, typename T>
-concept ErrorHandler = requires (H handler, Error error) {
-  { handler(error) } -> std::same_as<Result<T>>;
+template <typename H, typename T, typename E = Error>
+concept ErrorHandler = requires (H handler, E error) {
+  { handler(error) } -> std::same_as<Result<T, E>>;
 };
 
 // Faulty value mapper: T -> Result<U>
@@ -68,17 +68,17 @@ concept ValueEater = requires (F mapper, T value) {
 
 // Result eater
 
-template <typename F, typename T>
-concept ResultEater = requires (F mapper, Result<T> value) {
+template <typename F, typename T, typename E = Error>
+concept ResultEater = requires (F mapper, Result<T, E> value) {
   { mapper(std::move(value)) } -> std::same_as<void>;
 };
 
 // Resilient mapper: Result<T> -> U
 
-template <typename F, typename T>
-concept ResilientMapper = ResultHandler<F,T> &&
-                          !ResultMapper<F,T> &&
-                          !ResultEater<F,T>;
+template <typename F, typename T, typename E = Error>
+concept ResilientMapper = ResultHandler<F, T, E> &&
+                          !ResultMapper<F, T, E> &&
+                          !ResultEater<F, T, E>;
 
 // ValueMapper: T -> U
 
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <fallible/error/error.hpp>
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace fallible {
+
+//////////////////////////////////////////////////////////////////////
+
+/*
+ * Niche = word bit patterns that Error never produces: tag bits are never zero
+ * (see error/error.hpp).
+ *
+ * If ResultNiche<T>::kEnabled, Result<T> stores T and Error in the same word
+ * and drops the separate discriminant: zero tag bits mean "value".
+ *
+ * Requirements for T:
+ * - T fits into a word at byte offset kOffset
+ * - while T is alive, tag bits of the word are zero
+ *   (either T never touches the low-order bytes, or T is an aligned pointer)
+ *
+ * Enabled by default for trivially copyable types smaller than a word
+ * (enums, int, bool, Unit...): they are placed into the high-order bytes.
+ *
+ * Opt-in for pointer-like types:
+ *
+ * template <>
+ * struct fallible::ResultNiche<Handle*> : fallible::PointerNiche<Handle> {};
+ */
+
+//////////////////////////////////////////////////////////////////////
+
+namespace detail {
+
+template <typename T>
+constexpr bool IsSmallTrivial() {
+  return std::is_trivially_copyable_v<T> && sizeof(T) < sizeof(uintptr_t) &&
+         alignof(T) < sizeof(uintptr_t);
+}
+
+// Offset of the high-order bytes of a word
+template <typename T>
+constexpr size_t HighOrderOffset() {
+  if constexpr (std::endian::native == std::endian::little) {
+    return sizeof(uintptr_t) - sizeof(T);
+  } else {
+    return 0;
+  }
+}
+
+}  // namespace detail
+
+//////////////////////////////////////////////////////////////////////
+
+template <typename T>
+struct ResultNiche {
+  static constexpr bool kEnabled = detail::IsSmallTrivial<T>();
+  static constexpr size_t kOffset = detail::HighOrderOffset<T>();
+};
+
+//////////////////////////////////////////////////////////////////////
+
+// For pointer-like types with a single pointer to U
+// in the object representation (U*, std::unique_ptr<U>, ...)
+
+template <typename U>
+struct PointerNiche {
+  static_assert(alignof(U) > Error::kNicheTagMask,
+                "Pointers to U do not have spare low bits");
+
+  static constexpr bool kEnabled = true;
+  static constexpr size_t kOffset = 0;
+};
+
+}  // namespace fallible
@@ -9,23 +9,28 @@ namespace fallible {
 
 //////////////////////////////////////////////////////////////////////
 
-template <typename T>
-template <ResultMapper<T> F>
-auto Result<T>::DoMap(F mapper) && {
-  using ResultU = std::invoke_result_t<F, Result<T>>;
-
-  try {
+template <typename T, typename E>
+template <ResultMapper<T, E> F>
+auto Result<T, E>::DoMap(F mapper) && {
+  using ResultU = std::invoke_result_t<F, Result<T, E>>;
+
+  if constexpr (std::is_same_v<typename ResultU::ErrorType, fallible::Error>) {
+    try {
+      return mapper(std::move(*this));
+    } catch (IgnoreThisException&) {
+      // Ignore
+      throw;
+    } catch (...) {
+      // Unhandled user exception
+      return ResultU::Fail(
+          Err(ErrorCodes::Unknown)
+              .Domain("Fallible")
+              .Reason(FMT_COMPILE("Unhandled exception in user mapper: {}"), wheels::CurrentExceptionMessage())
+              .Done());
+    }
+  } else {
+    // Lightweight errors cannot hold exceptions
     return mapper(std::move(*this));
-  } catch (IgnoreThisException&) {
-    // Ignore
-    throw;
-  } catch (...) {
-    // Unhandled user exception
-    return ResultU::Fail(
-        Err(ErrorCodes::Unknown)
-            .Domain("Fallible")
-            .Reason(std::string("Unhandled exception in user mapper: ") + wheels::CurrentExceptionMessage())
-            .Done());
   }
 }
 
@@ -33,9 +38,9 @@ auto Result<T>::DoMap(F mapper) && {
 
 // Result mapper
 
-template <typename T>
-template <ResultMapper<T> F>
-auto Result<T>::Map(F mapper) && {
+template <typename T, typename E>
+template <ResultMapper<T, E> F>
+auto Result<T, E>::Map(F mapper) && {
   return std::move(*this).DoMap(std::move(mapper));
 }
 
@@ -43,13 +48,13 @@ auto Result<T>::Map(F mapper) && {
 
 // Resilient mapper
 
-template <typename T>
-template <ResilientMapper<T> F>
-auto Result<T>::Map(F mapper) && {
-  using U = std::invoke_result_t<F, Result<T>>;
+template <typename T, typename E>
+template <ResilientMapper<T, E> F>
+auto Result<T, E>::Map(F mapper) && {
+  using U = std::invoke_result_t<F, Result<T, E>>;
 
-  auto result_mapper = [mapper = std::move(mapper)](Result<T> input) mutable -> Result<U> {
-    return Result<U>::Ok(mapper(input));
+  auto result_mapper = [mapper = std::move(mapper)](Result<T, E> input) mutable -> Result<U, E> {
+    return Result<U, E>::Ok(mapper(input));
   };
 
   return std::move(*this).DoMap(std::move(result_mapper));
@@ -59,16 +64,17 @@ auto Result<T>::Map(F mapper) && {
 
 // Value mapper
 
-template <typename T>
+template <typename T, typename E>
 template <ValueMapper<T> F>
-auto Result<T>::Map(F mapper) && {
+auto Result<T, E>::Map(F mapper, wheels::SourceLocation where) && {
   using U = std::invoke_result_t<F, T>;
 
-  auto result_mapper = [mapper = std::move(mapper)](Result<T> input) mutable -> Result<U> {
+  auto result_mapper = [mapper = std::move(mapper), where](Result<T, E> input) mutable -> Result<U, E> {
     if (input.IsOk()) {
-      return Result<U>::Ok(mapper(*input));
+      return Result<U, E>::Ok(mapper(*input));
     } else {
-      return Result<U>::Fail(input.Error());
+      detail::RecordReturn(input.Error(), where);
+      return Result<U, E>::Fail(input.Error());
     }
   };
 
@@ -79,17 +85,19 @@ auto Result<T>::Map(F mapper) && {
 
 // Faulty mapper
 
-template <typename T>
+template <typename T, typename E>
 template <FaultyMapper<T> F>
-auto Result<T>::Map(F mapper) && {
+auto Result<T, E>::Map(F mapper, wheels::SourceLocation where) && {
   using ResultU = std::invoke_result_t<F, T>;
   using U = typename ResultU::ValueType;
+  using E2 = typename ResultU::ErrorType;
 
-  auto result_mapper = [mapper = std::move(mapper)](Result<T> input) mutable -> Result<U> {
+  auto result_mapper = [mapper = std::move(mapper), where](Result<T, E> input) mutable -> Result<U, E2> {
     if (input.IsOk()) {
       return mapper(*input);
     } else {
-      return Result<U>::Fail(input.Error());
+      detail::RecordReturn(input.Error(), where);
+      return Result<U, E2>::Fail(detail::WidenError<E2>(input.Error()));
     }
   };
 
@@ -100,13 +108,14 @@ auto Result<T>::Map(F mapper) && {
 
 // Recover
 
-template <typename T>
-template <ErrorHandler<T> H>
-Result<T> Result<T>::Recover(H error_handler) && {
-  auto result_mapper = [error_handler = std::move(error_handler)](Result<T> input) mutable -> Result<T> {
+template <typename T, typename E>
+template <ErrorHandler<T, E> H>
+Result<T, E> Result<T, E>::Recover(H error_handler) && {
+  auto result_mapper = [error_handler = std::move(error_handler)](Result<T, E> input) mutable -> Result<T, E> {
     if (input.IsOk()) {
       return input;
     } else {
+      detail::CountError(ErrorEvent::Recovered, input.Error());
       return error_handler(input.Error());
     }
   };
@@ -116,9 +125,9 @@ Result<T> Result<T>::Recover(H error_handler) && {
 
 // Recover as Map
 
-template <typename T>
-template <ErrorHandler<T> H>
-Result<T> Result<T>::Map(H error_handler) && {
+template <typename T, typename E>
+template <ErrorHandler<T, E> H>
+Result<T, E> Result<T, E>::Map(H error_handler) && {
   return std::move(*this).Recover(std::move(error_handler));
 }
 
@@ -126,15 +135,16 @@ Result<T> Result<T>::Map(H error_handler) && {
 
 // Value eater
 
-template <typename T>
+template <typename T, typename E>
 template <ValueEater<T> F>
-Status Result<T>::Map(F eater) && {
-  auto result_mapper = [eater = std::move(eater)](Result<T> input) mutable -> Status {
+Result<wheels::Unit, E> Result<T, E>::Map(F eater, wheels::SourceLocation where) && {
+  auto result_mapper = [eater = std::move(eater), where](Result<T, E> input) mutable -> Result<wheels::Unit, E> {
     if (input.IsOk()) {
       eater(std::move(*input));
-      return Status::Ok({});
+      return Result<wheels::Unit, E>::Ok({});
     } else {
-      return Status::Fail(input.Error());
+      detail::RecordReturn(input.Error(), where);
+      return Result<wheels::Unit, E>::Fail(input.Error());
     }
   };
 
@@ -145,12 +155,12 @@ Status Result<T>::Map(F eater) && {
 
 // Result eater
 
-template <typename T>
-template <ResultEater<T> F>
-Status Result<T>::Map(F eater) && {
-  auto result_mapper = [eater = std::move(eater)](Result<T> input) mutable -> Status {
+template <typename T, typename E>
+template <ResultEater<T, E> F>
+Result<wheels::Unit, E> Result<T, E>::Map(F eater) && {
+  auto result_mapper = [eater = std::move(eater)](Result<T, E> input) mutable -> Result<wheels::Unit, E> {
     eater(std::move(input));
-    return Status::Ok({});
+    return Result<wheels::Unit, E>::Ok({});
   };
 
   return std::move(*this).DoMap(std::move(result_mapper));
@@ -161,38 +171,38 @@ Status Result<T>::Map(F eater) && {
 // Void
 
 // void -> T
-template <typename T>
+template <typename T, typename E>
 template <VoidMapper F>
-auto Result<T>::Map(F mapper) && {
+auto Result<T, E>::Map(F mapper, wheels::SourceLocation where) && {
   static_assert(std::same_as<T, wheels::Unit>);
 
   auto unit_mapper = [mapper = std::move(mapper)](wheels::Unit) mutable {
     return mapper();
   };
-  return std::move(*this).Map(std::move(unit_mapper));
+  return std::move(*this).Map(std::move(unit_mapper), where);
 }
 
 // void -> void
-template <typename T>
+template <typename T, typename E>
 template <Worker F>
-Status Result<T>::Map(F worker) && {
+Result<wheels::Unit, E> Result<T, E>::Map(F worker, wheels::SourceLocation where) && {
   static_assert(std::same_as<T, wheels::Unit>);
 
   auto unit_mapper = [worker = std::move(worker)](wheels::Unit) mutable {
     worker();
     return wheels::Unit{};
   };
-  return std::move(*this).Map(std::move(unit_mapper));
+  return std::move(*this).Map(std::move(unit_mapper), where);
 }
 
 //////////////////////////////////////////////////////////////////////
 
 // Identity mapper
 
-template <typename T>
+template <typename T, typename E>
 template <Hook F>
-Result<T> Result<T>::Forward(F hook) && {
-  auto result_mapper = [hook = std::move(hook)](Result<T> input) mutable {
+Result<T, E> Result<T, E>::Forward(F hook) && {
+  auto result_mapper = [hook = std::move(hook)](Result<T, E> input) mutable {
     hook();
     return input;
   };
@@ -201,19 +211,20 @@ Result<T> Result<T>::Forward(F hook) && {
 
 //////////////////////////////////////////////////////////////////////
 
-template <typename T>
-Status Result<T>::JustStatus() && {
+template <typename T, typename E>
+Result<wheels::Unit, E> Result<T, E>::JustStatus(wheels::SourceLocation where) && {
   if (IsOk()) {
-    return Status::Ok({});
+    return Result<wheels::Unit, E>::Ok({});
   } else {
-    return Status::Fail(Error());
+    detail::RecordReturn(Error(), where);
+    return Result<wheels::Unit, E>::Fail(Error());
   }
 }
 
 //////////////////////////////////////////////////////////////////////
 
-template <typename T>
-std::optional<T> Result<T>::ToOptional() && {
+template <typename T, typename E>
+std::optional<T> Result<T, E>::ToOptional() && {
   if (IsOk()) {
     return std::move(ValueUnsafe());
   } else {
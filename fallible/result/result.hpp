@@ -1,10 +1,15 @@
 #pragma once
 
 #include <fallible/error/error.hpp>
+#include <fallible/error/format.hpp>
 #include <fallible/error/throw.hpp>
+#include <fallible/error/trace.hpp>
+#include <fallible/telemetry/counters.hpp>
+#include <fallible/error/widen.hpp>
 
 #include <fallible/result/fwd.hpp>
 #include <fallible/result/mappers.hpp>
+#include <fallible/result/storage.hpp>
 
 #include <fallible/rt/panic.hpp>
 
@@ -38,58 +43,47 @@ namespace fallible {
 ////////////////////////////////////////////////////////////
 
 // Result = Value | Error
+// E = lightweight error type for inner loops, see error/widen.hpp
 
-template <typename T>
+template <typename T, typename E>
 class [[nodiscard]] Result {
  public:
   static_assert(!std::is_reference<T>::value,
                 "Reference types are not supported");
 
   using ValueType = T;
+  using ErrorType = E;
 
   // Static constructors
 
-  static Result<T> Ok(T value) {
-    return Result(std::move(value));
+  static Result Ok(T value) {
+    return Result(detail::ValueTag{}, std::move(value));
   }
 
-  static Result<T> Fail(Error error) {
-    return Result(std::move(error));
+  static Result Fail(E error) {
+    return Result(detail::ErrorTag{}, std::move(error));
   }
 
-  // Moving
+  // Widening E -> Error
 
-  Result(Result&& that) {
-    MoveFrom(std::move(that));
+  template <typename E2>
+  requires std::same_as<E, fallible::Error> && WidensToError<E2>
+  Result(Result<T, E2>&& that)
+      : Result(std::move(that).Widen()) {
   }
 
-  Result& operator=(Result&& that) {
-    Destroy();
-    MoveFrom(std::move(that));
-    return *this;
-  }
-
-  // Copying
-
-  Result(const Result& that) {
-    CopyFrom(that);
-  }
-
-  Result& operator=(const Result& that) {
-    Destroy();
-    CopyFrom(that);
-  }
-
-  // Dtor
-
-  ~Result() {
-    Destroy();
+  Result<T> Widen() && requires WidensToError<E> {
+    if (IsOk()) {
+      return Result<T>::Ok(std::move(ValueUnsafe()));
+    } else {
+      return Result<T>::Fail(ToError(Error()));
+    }
   }
 
   // Testing
 
   bool IsOk() const {
-    return has_value_;
+    return storage_.HasValue();
   }
 
   bool Failed() const {
@@ -103,8 +97,8 @@ class [[nodiscard]] Result {
   */
 
   void ThrowIfError() const {
-    if (!has_value_) {
-      ThrowError(error_);
+    if (!IsOk()) {
+      ThrowError(detail::WidenError<fallible::Error>(Error()));
     }
   }
 
@@ -125,30 +119,33 @@ class [[nodiscard]] Result {
 
   T& ExpectValue(wheels::SourceLocation where = wheels::Here())& {
     ExpectOkImpl(where, "Unexpected error");
-    return value_;
+    return storage_.Value();
   }
 
   T&& ExpectValue(wheels::SourceLocation where = wheels::Here())&& {
     ExpectOkImpl(where, "Unexpected error");
-    return std::move(value_);
+    return std::move(storage_.Value());
   }
 
   T& ExpectValueOr(std::string_view or_error,
                  wheels::SourceLocation where = wheels::Here())& {
     ExpectOkImpl(where, or_error);
-    return value_;
+    return storage_.Value();
   }
 
   T&& ExpectValueOr(std::string_view or_error,
                    wheels::SourceLocation where = wheels::Here()) && {
     ExpectOkImpl(where, or_error);
-    return std::move(value_);
+    return std::move(storage_.Value());
   }
 
   // Ignore
 
+  // Counted by telemetry, see telemetry/counters.hpp
   void Ignore(std::string_view /*excuse*/) {
-    // No-op
+    if (!IsOk()) {
+      detail::CountError(ErrorEvent::Ignored, Error());
+    }
   }
 
   void TODO(std::string_view /*fix*/) {
@@ -158,16 +155,17 @@ class [[nodiscard]] Result {
   // Error accessors
   // Unsafe: behavior is undefined if result holds a value instead of an error
 
-  bool MatchErrorCode(int expected) const {
+  bool MatchErrorCode(int expected) const
+      requires std::same_as<E, fallible::Error> {
     return ErrorCode() == expected;
   }
 
-  const class Error& Error() const {
-    return error_;
+  const E& Error() const {
+    return storage_.GetError();
   }
 
-  int32_t ErrorCode() const {
-    return error_.Code();
+  int32_t ErrorCode() const requires std::same_as<E, fallible::Error> {
+    return Error().Code();
   }
 
   // Value accessors
@@ -176,15 +174,15 @@ class [[nodiscard]] Result {
   // Behavior is undefined if Result does not contain a value
 
   T& ValueUnsafe() & {
-    return value_;
+    return storage_.Value();
   }
 
   const T& ValueUnsafe() const & {
-    return value_;
+    return storage_.Value();
   }
 
   T&& ValueUnsafe() && {
-    return std::move(value_);
+    return std::move(storage_.Value());
   }
 
   // Safe value getters
@@ -192,17 +190,17 @@ class [[nodiscard]] Result {
 
   T& ValueOrThrow()& {
     ThrowIfError();
-    return value_;
+    return storage_.Value();
   }
 
   const T& ValueOrThrow() const& {
     ThrowIfError();
-    return value_;
+    return storage_.Value();
   }
 
   T&& ValueOrThrow()&& {
     ThrowIfError();
-    return std::move(value_);
+    return std::move(storage_.Value());
   }
 
   // For templates:
@@ -215,26 +213,26 @@ class [[nodiscard]] Result {
   // Unsafe: behavior is undefined if this Result does not contain a value
 
   T& operator*() & {
-    return value_;
+    return storage_.Value();
   }
 
   const T& operator*() const & {
-    return value_;
+    return storage_.Value();
   }
 
   T&& operator*() && {
-    return std::move(value_);
+    return std::move(storage_.Value());
   }
 
   // operator -> overloads
   // Unsafe: behavior is undefined if Result does not contain a value
 
   T* operator->() {
-    return &value_;
+    return &storage_.Value();
   }
 
   const T* operator->() const {
-    return &value_;
+    return &storage_.Value();
   }
 
   // Unwrap rvalue Result automatically
@@ -246,49 +244,51 @@ class [[nodiscard]] Result {
   // Monadic API
 
   // Result<T> -> Result<U>
-  template <ResultMapper<T> F>
+  template <ResultMapper<T, E> F>
   auto Map(F mapper) &&;
 
   // Result<T> -> U
-  template <ResilientMapper<T> F>
+  template <ResilientMapper<T, E> F>
   auto Map(F mapper) &&;
 
+  // Error paths are recorded in the return trace, see error/trace.hpp
+
   // T -> U
   template <ValueMapper<T> F>
-  auto Map(F mapper) &&;
+  auto Map(F mapper, wheels::SourceLocation where = wheels::SourceLocation::Current()) &&;
 
   // T -> Result<U>
   template <FaultyMapper<T> F>
-  auto Map(F mapper) &&;
+  auto Map(F mapper, wheels::SourceLocation where = wheels::SourceLocation::Current()) &&;
 
   // Error -> Result<T>
-  template <ErrorHandler<T> H>
-  Result<T> Recover(H error_handler) &&;
+  template <ErrorHandler<T, E> H>
+  Result Recover(H error_handler) &&;
 
   // ErrorHandler as mapper
-  template <ErrorHandler<T> H>
-  Result<T> Map(H error_handler) &&;
+  template <ErrorHandler<T, E> H>
+  Result Map(H error_handler) &&;
 
   // Eat T -> Unit
   template <ValueEater<T> F>
-  Status Map(F eater) &&;
+  Result<wheels::Unit, E> Map(F eater, wheels::SourceLocation where = wheels::SourceLocation::Current()) &&;
 
   // Eat Result<T> -> Unit
-  template <ResultEater<T> F>
-  Status Map(F eater) &&;
+  template <ResultEater<T, E> F>
+  Result<wheels::Unit, E> Map(F eater) &&;
 
   // void -> T
   template <VoidMapper F>
-  auto Map(F mapper) &&;
+  auto Map(F mapper, wheels::SourceLocation where = wheels::SourceLocation::Current()) &&;
 
   // void -> void
   template <Worker F>
-  Status Map(F worker) &&;
+  Result<wheels::Unit, E> Map(F worker, wheels::SourceLocation where = wheels::SourceLocation::Current()) &&;
 
   template <Hook F>
-  Result<T> Forward(F hook) &&;
+  Result Forward(F hook) &&;
 
-  Status JustStatus() &&;
+  Result<wheels::Unit, E> JustStatus(wheels::SourceLocation where = wheels::SourceLocation::Current()) &&;
 
   // Optional
 
@@ -299,66 +299,37 @@ class [[nodiscard]] Result {
   }
 
  private:
-  template <ResultMapper<T> F>
+  template <ResultMapper<T, E> F>
   auto DoMap(F result_mapper) &&;
 
  private:
-  explicit Result(T && value)
-      : has_value_(true),
-        value_(std::move(value)) {
-  }
-
-  explicit Result(const T& value)
-    : has_value_(true),
-      value_(value) {
-  }
-
-  explicit Result(class Error error)
-      : has_value_(false),
-        error_(std::move(error)) {
-  }
-
-  void MoveFrom(Result&& that) {
-    has_value_ = that.has_value_;
-    if (has_value_) {
-      new (&value_) T(std::move(that.value_));
-    } else {
-      new (&error_) class Error(std::move(that.error_));
-    }
-  }
-
-  void CopyFrom(const Result& that) {
-    has_value_ = that.has_value_;
-    if (has_value_) {
-      new (&value_) T(that.value_);
-    } else {
-      new (&error_) class Error(that.error_);
-    }
+  Result(detail::ValueTag, T&& value)
+      : storage_(detail::ValueTag{}, std::move(value)) {
   }
 
-  void Destroy() {
-    if (has_value_) {
-      value_.~T();
-    } else {
-      error_.~Error();
-    }
+  Result(detail::ErrorTag, E error)
+      : storage_(detail::ErrorTag{}, std::move(error)) {
   }
 
   void ExpectOkImpl(wheels::SourceLocation where, std::string_view or_error) {
     if (!IsOk()) {
-      rt::Panic(where, fmt::format("Result::ExpectOk failed: {} ({})", or_error, error_.Describe()));
+      auto error = detail::WidenError<fallible::Error>(Error());
+      detail::CountError(ErrorEvent::Unexpected, error);
+      // Described straight into the panic message
+      rt::Panic(where, fmt::format("Result::ExpectOk failed: {} ({:v})", or_error, error));
     }
   }
 
  private:
-  // Tagged union
-  bool has_value_;
-  union {
-    T value_;
-    class Error error_;
-  };
+  // Value | E, see storage.hpp
+  detail::ResultStorage<T, E> storage_;
 };
 
+template <typename T, typename E>
+struct IsTriviallyRelocatable<Result<T, E>>
+    : std::bool_constant<IsTriviallyRelocatable<T>::value &&
+                         IsTriviallyRelocatable<E>::value> {};
+
 }  // namespace fallible
 
 ////////////////////////////////////////////////////////////
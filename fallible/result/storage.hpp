@@ -0,0 +1,288 @@
+#pragma once
+
+#include <fallible/error/error.hpp>
+#include <fallible/result/niche.hpp>
+
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace fallible {
+
+namespace detail {
+
+//////////////////////////////////////////////////////////////////////
+
+// Layouts of Result<T>
+
+// Separate discriminant + union
+
+template <typename T, typename E>
+class TaggedLayout {
+ public:
+  TaggedLayout() {
+  }
+
+  ~TaggedLayout() requires std::is_trivially_destructible_v<T> &&
+                           std::is_trivially_destructible_v<E> = default;
+
+  ~TaggedLayout() {
+  }
+
+  bool HasValue() const {
+    return has_value_;
+  }
+
+  T* ValuePtr() {
+    return &value_;
+  }
+
+  const T* ValuePtr() const {
+    return &value_;
+  }
+
+  E* ErrorPtr() {
+    return &error_;
+  }
+
+  const E* ErrorPtr() const {
+    return &error_;
+  }
+
+  // Before constructing value / error in place
+  void MarkValue() {
+    has_value_ = true;
+  }
+
+  void MarkError() {
+    has_value_ = false;
+  }
+
+ private:
+  bool has_value_;
+  union {
+    T value_;
+    E error_;
+  };
+};
+
+// Value and error share one word, see niche.hpp
+
+template <typename T>
+class NicheLayout {
+  using Niche = ResultNiche<T>;
+
+  static_assert(sizeof(Error) == sizeof(uintptr_t));
+  static_assert(Niche::kOffset + sizeof(T) <= sizeof(uintptr_t));
+  static_assert(Niche::kOffset % alignof(T) == 0);
+  static_assert(alignof(T) <= alignof(uintptr_t));
+
+ public:
+  bool HasValue() const {
+    uintptr_t word;
+    std::memcpy(&word, storage_, sizeof(word));
+    return (word & Error::kNicheTagMask) == 0;
+  }
+
+  T* ValuePtr() {
+    return std::launder(reinterpret_cast<T*>(storage_ + Niche::kOffset));
+  }
+
+  const T* ValuePtr() const {
+    return std::launder(reinterpret_cast<const T*>(storage_ + Niche::kOffset));
+  }
+
+  Error* ErrorPtr() {
+    return std::launder(reinterpret_cast<Error*>(storage_));
+  }
+
+  const Error* ErrorPtr() const {
+    return std::launder(reinterpret_cast<const Error*>(storage_));
+  }
+
+  void MarkValue() {
+    // Bytes not covered by T must keep tag bits zero
+    std::memset(storage_, 0, sizeof(storage_));
+  }
+
+  void MarkError() {
+    // Error word itself sets tag bits
+  }
+
+ private:
+  alignas(uintptr_t) std::byte storage_[sizeof(uintptr_t)];
+};
+
+// Niche is provided by the canonical Error only
+template <typename T, typename E>
+using ResultLayout =
+    std::conditional_t<ResultNiche<T>::kEnabled && std::is_same_v<E, Error>,
+                       NicheLayout<T>, TaggedLayout<T, E>>;
+
+//////////////////////////////////////////////////////////////////////
+
+struct ValueTag {};
+struct ErrorTag {};
+
+// Value | Error
+
+// Special members are trivial / noexcept iff they are for both T and E
+//
+// Error owns a ref-counted payload, so triviality applies to custom
+// error types only (e.g. Result<int, ParseError>): Result<T> with the
+// default E = Error is never trivially copyable and is not passed in
+// registers. It is still noexcept-movable and trivially relocatable,
+// see IsTriviallyRelocatable
+
+template <typename T, typename E>
+class ResultStorage {
+  static constexpr bool kTrivialCopy =
+      std::is_trivially_copy_constructible_v<T> &&
+      std::is_trivially_copy_constructible_v<E>;
+
+  static constexpr bool kTrivialMove =
+      std::is_trivially_move_constructible_v<T> &&
+      std::is_trivially_move_constructible_v<E>;
+
+  static constexpr bool kTrivialDtor =
+      std::is_trivially_destructible_v<T> &&
+      std::is_trivially_destructible_v<E>;
+
+  static constexpr bool kTrivialCopyAssign =
+      kTrivialCopy && kTrivialDtor &&
+      std::is_trivially_copy_assignable_v<T> &&
+      std::is_trivially_copy_assignable_v<E>;
+
+  static constexpr bool kTrivialMoveAssign =
+      kTrivialMove && kTrivialDtor &&
+      std::is_trivially_move_assignable_v<T> &&
+      std::is_trivially_move_assignable_v<E>;
+
+  static constexpr bool kNothrowCopy =
+      std::is_nothrow_copy_constructible_v<T> &&
+      std::is_nothrow_copy_constructible_v<E>;
+
+  static constexpr bool kNothrowMove =
+      std::is_nothrow_move_constructible_v<T> &&
+      std::is_nothrow_move_constructible_v<E>;
+
+ public:
+  template <typename... Args>
+  explicit ResultStorage(ValueTag, Args&&... args) {
+    ConstructValue(std::forward<Args>(args)...);
+  }
+
+  ResultStorage(ErrorTag, E error) noexcept(
+      std::is_nothrow_move_constructible_v<E>) {
+    ConstructError(std::move(error));
+  }
+
+  // Moving
+
+  ResultStorage(ResultStorage&&) requires kTrivialMove = default;
+
+  ResultStorage(ResultStorage&& that) noexcept(kNothrowMove) {
+    MoveFrom(std::move(that));
+  }
+
+  ResultStorage& operator=(ResultStorage&&) requires kTrivialMoveAssign = default;
+
+  ResultStorage& operator=(ResultStorage&& that) noexcept(kNothrowMove) {
+    Destroy();
+    MoveFrom(std::move(that));
+    return *this;
+  }
+
+  // Copying
+
+  ResultStorage(const ResultStorage&) requires kTrivialCopy = default;
+
+  ResultStorage(const ResultStorage& that) noexcept(kNothrowCopy) {
+    CopyFrom(that);
+  }
+
+  ResultStorage& operator=(const ResultStorage&) requires kTrivialCopyAssign = default;
+
+  ResultStorage& operator=(const ResultStorage& that) noexcept(kNothrowCopy) {
+    if (this != &that) {
+      Destroy();
+      CopyFrom(that);
+    }
+    return *this;
+  }
+
+  // Dtor
+
+  ~ResultStorage() requires kTrivialDtor = default;
+
+  ~ResultStorage() {
+    Destroy();
+  }
+
+  bool HasValue() const {
+    return layout_.HasValue();
+  }
+
+  T& Value() {
+    return *layout_.ValuePtr();
+  }
+
+  const T& Value() const {
+    return *layout_.ValuePtr();
+  }
+
+  E& GetError() {
+    return *layout_.ErrorPtr();
+  }
+
+  const E& GetError() const {
+    return *layout_.ErrorPtr();
+  }
+
+ private:
+  template <typename... Args>
+  void ConstructValue(Args&&... args) {
+    layout_.MarkValue();
+    new (layout_.ValuePtr()) T(std::forward<Args>(args)...);
+  }
+
+  void ConstructError(E error) {
+    layout_.MarkError();
+    new (layout_.ErrorPtr()) E(std::move(error));
+  }
+
+  void MoveFrom(ResultStorage&& that) {
+    if (that.HasValue()) {
+      ConstructValue(std::move(that.Value()));
+    } else {
+      ConstructError(std::move(that.GetError()));
+    }
+  }
+
+  void CopyFrom(const ResultStorage& that) {
+    if (that.HasValue()) {
+      ConstructValue(that.Value());
+    } else {
+      ConstructError(that.GetError());
+    }
+  }
+
+  void Destroy() {
+    if (HasValue()) {
+      Value().~T();
+    } else {
+      GetError().~E();
+    }
+  }
+
+ private:
+  ResultLayout<T, E> layout_;
+};
+
+static_assert(!std::is_trivially_copyable_v<ResultStorage<int, Error>>,
+              "Error is not trivially copyable, neither is Result<T>");
+
+}  // namespace detail
+
+}  // namespace fallible
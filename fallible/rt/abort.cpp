@@ -1,5 +1,7 @@
 #include <fallible/rt/abort.hpp>
 
+#include <fallible/telemetry/flight.hpp>
+
 #include <wheels/core/singleton.hpp>
 
 #include <mutex>
@@ -16,6 +18,9 @@ struct AbortPanicker : IPanicker {
 
     std::cout << "Panicked at " << where << ": " << reason << std::endl;
 
+    // Errors that led up to the panic, see telemetry/flight.hpp
+    detail::SealFlightRecorder(where, reason);
+
     std::abort();
   }
 
@@ -0,0 +1,85 @@
+#include <fallible/support/arena.hpp>
+
+#include <fallible/support/ref_counted.hpp>
+
+namespace fallible {
+
+//////////////////////////////////////////////////////////////////////
+
+// Not thread-safe: allocations come only from the thread that installed
+// the arena, deallocation is deferred to the destruction of the arena
+
+class ErrorArena : public detail::RefCounted {
+ public:
+  ErrorArena(size_t initial_size, std::pmr::memory_resource* upstream)
+      : resource_(initial_size, upstream) {
+  }
+
+  void* Allocate(size_t size, size_t alignment) {
+    Ref();
+    return resource_.allocate(size, alignment);
+  }
+
+  std::pmr::memory_resource* Resource() {
+    return &resource_;
+  }
+
+ private:
+  std::pmr::monotonic_buffer_resource resource_;
+};
+
+static thread_local ErrorArena* current_arena = nullptr;
+
+//////////////////////////////////////////////////////////////////////
+
+ErrorArenaScope::ErrorArenaScope(size_t initial_size,
+                                 std::pmr::memory_resource* upstream)
+    : arena_(new ErrorArena(initial_size, upstream)),
+      prev_(std::exchange(current_arena, arena_)) {
+}
+
+ErrorArenaScope::~ErrorArenaScope() {
+  current_arena = prev_;
+  detail::ArenaRelease(arena_);
+}
+
+//////////////////////////////////////////////////////////////////////
+
+namespace detail {
+
+ErrorArena* CurrentArena() {
+  return current_arena;
+}
+
+std::pmr::memory_resource* CurrentResource() {
+  return ArenaResource(current_arena);
+}
+
+std::pmr::memory_resource* ArenaResource(ErrorArena* arena) {
+  if (arena != nullptr) {
+    return arena->Resource();
+  }
+  return std::pmr::new_delete_resource();
+}
+
+void* ArenaAllocate(ErrorArena* arena, size_t size, size_t alignment) {
+  return arena->Allocate(size, alignment);
+}
+
+void ArenaRelease(ErrorArena* arena) {
+  if (arena->Unref()) {
+    delete arena;
+  }
+}
+
+HeapScope::HeapScope()
+    : prev_(std::exchange(current_arena, nullptr)) {
+}
+
+HeapScope::~HeapScope() {
+  current_arena = prev_;
+}
+
+}  // namespace detail
+
+}  // namespace fallible
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <fallible/support/confined.hpp>
+
+#include <cstddef>
+#include <memory_resource>
+#include <new>
+#include <utility>
+
+namespace fallible {
+
+class ErrorArena;
+
+//////////////////////////////////////////////////////////////////////
+
+// Installs a fresh arena as the allocation target for errors and contexts
+// built by the current thread (payload nodes, copied strings, sub-error
+// vectors) until the end of the scope. Memory is released in bulk.
+//
+// Safe fallback: each allocation keeps the arena alive, so errors that
+// escape the scope stay valid and the arena is released when the last of
+// them dies. Call Error::Detach to move an escaping error to the global
+// heap and release the arena as soon as the scope ends.
+//
+// Usage: per request or per thread
+//
+//   {
+//     ErrorArenaScope arena;
+//     Status status = HandleRequest(request);
+//     ...
+//   }
+
+class ErrorArenaScope {
+ public:
+  static constexpr size_t kDefaultChunkSize = 4096;
+
+  explicit ErrorArenaScope(
+      size_t initial_size = kDefaultChunkSize,
+      std::pmr::memory_resource* upstream = std::pmr::get_default_resource());
+
+  // Non-copyable
+  ErrorArenaScope(const ErrorArenaScope&) = delete;
+  ErrorArenaScope& operator=(const ErrorArenaScope&) = delete;
+
+  ~ErrorArenaScope();
+
+ private:
+  ErrorArena* arena_;
+  ErrorArena* prev_;
+};
+
+//////////////////////////////////////////////////////////////////////
+
+namespace detail {
+
+// nullptr = global heap
+ErrorArena* CurrentArena();
+
+// Arena resource or the global heap
+std::pmr::memory_resource* CurrentResource();
+
+// Resource of `arena`, nullptr = global heap
+std::pmr::memory_resource* ArenaResource(ErrorArena* arena);
+
+// Takes a reference to `arena`
+void* ArenaAllocate(ErrorArena* arena, size_t size, size_t alignment);
+
+// Drops a reference taken by ArenaAllocate, memory is reclaimed in bulk
+void ArenaRelease(ErrorArena* arena);
+
+// Temporarily routes allocations of the current thread to the global heap
+class HeapScope {
+ public:
+  HeapScope();
+  ~HeapScope();
+
+  HeapScope(const HeapScope&) = delete;
+  HeapScope& operator=(const HeapScope&) = delete;
+
+ private:
+  ErrorArena* prev_;
+};
+
+//////////////////////////////////////////////////////////////////////
+
+// Nodes (ContextData and derived) remember their arena in `arena`
+// and start in the thread-local reference counting mode
+// inside ThreadConfinedScope
+
+template <typename T, typename... Args>
+T* NewNode(Args&&... args) {
+  T* node;
+  if (ErrorArena* arena = CurrentArena(); arena != nullptr) {
+    void* memory = ArenaAllocate(arena, sizeof(T), alignof(T));
+    node = new (memory) T(std::forward<Args>(args)...);
+    node->arena = arena;
+  } else {
+    node = new T(std::forward<Args>(args)...);
+  }
+  if (IsThreadConfined()) {
+    node->MakeThreadLocal();
+  }
+  return node;
+}
+
+template <typename T>
+void DeleteNode(T* node) {
+  ErrorArena* arena = node->arena;
+  if (arena == nullptr) {
+    delete node;
+  } else {
+    node->~T();
+    ArenaRelease(arena);
+  }
+}
+
+}  // namespace detail
+
+}  // namespace fallible
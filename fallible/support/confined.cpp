@@ -0,0 +1,25 @@
+#include <fallible/support/confined.hpp>
+
+#include <utility>
+
+namespace fallible {
+
+static thread_local bool thread_confined = false;
+
+ThreadConfinedScope::ThreadConfinedScope()
+    : prev_(std::exchange(thread_confined, true)) {
+}
+
+ThreadConfinedScope::~ThreadConfinedScope() {
+  thread_confined = prev_;
+}
+
+namespace detail {
+
+bool IsThreadConfined() {
+  return thread_confined;
+}
+
+}  // namespace detail
+
+}  // namespace fallible
@@ -0,0 +1,40 @@
+#pragma once
+
+namespace fallible {
+
+//////////////////////////////////////////////////////////////////////
+
+// Errors and contexts created by the current thread inside the scope use
+// non-atomic reference counting (see support/ref_counted.hpp), so copying
+// them costs a plain increment.
+//
+// Such errors must not leave the thread: call Error::Share() before
+// sending an error (or a Result holding it) to another thread.
+//
+// Usage: once per shard worker thread
+//
+//   void ShardWorker() {
+//     ThreadConfinedScope confined;
+//     ...
+//   }
+
+class ThreadConfinedScope {
+ public:
+  ThreadConfinedScope();
+  ~ThreadConfinedScope();
+
+  // Non-copyable
+  ThreadConfinedScope(const ThreadConfinedScope&) = delete;
+  ThreadConfinedScope& operator=(const ThreadConfinedScope&) = delete;
+
+ private:
+  bool prev_;
+};
+
+namespace detail {
+
+bool IsThreadConfined();
+
+}  // namespace detail
+
+}  // namespace fallible
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+namespace fallible::detail {
+
+//////////////////////////////////////////////////////////////////////
+
+// Fast non-cryptographic 64-bit hashing for fingerprints
+// Stable across processes and builds of the same architecture:
+// depends only on the bytes
+
+inline constexpr uint64_t kHashSeed = 0x9E3779B97F4A7C15;
+
+// Final mixer of MurmurHash3
+inline uint64_t HashMix(uint64_t h) {
+  h ^= h >> 33;
+  h *= 0xFF51AFD7ED558CCD;
+  h ^= h >> 33;
+  h *= 0xC4CEB9FE1A85EC53;
+  h ^= h >> 33;
+  return h;
+}
+
+inline uint64_t HashCombine(uint64_t seed, uint64_t value) {
+  return HashMix(seed ^ (value + kHashSeed + (seed << 6) + (seed >> 2)));
+}
+
+// Eight bytes per step
+inline uint64_t HashBytes(std::string_view bytes, uint64_t seed = kHashSeed) {
+  uint64_t h = seed ^ (bytes.size() * 0x87C37B91114253D5);
+
+  const char* data = bytes.data();
+  size_t size = bytes.size();
+
+  while (size >= 8) {
+    uint64_t chunk;
+    std::memcpy(&chunk, data, 8);
+    h = HashMix(h ^ chunk);
+    data += 8;
+    size -= 8;
+  }
+
+  if (size > 0) {
+    uint64_t tail = 0;
+    std::memcpy(&tail, data, size);
+    h = HashMix(h ^ tail);
+  }
+
+  return h;
+}
+
+}  // namespace fallible::detail
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <fallible/support/small_any.hpp>
+#include <fallible/support/string.hpp>
+
+#include <fmt/format.h>
+
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace fallible::detail {
+
+//////////////////////////////////////////////////////////////////////
+
+// Either a ready string or a deferred renderer (e.g. captured format
+// arguments), rendered on every access and never cached
+// Small renderers are stored inline, see SmallAny
+
+class LazyString {
+  using RenderFn = void (*)(const SmallAny&, fmt::memory_buffer&);
+
+ public:
+  LazyString() = default;
+
+  LazyString(SharedString text)  // NOLINT
+      : text_(std::move(text)) {
+  }
+
+  LazyString(const LazyString& that) = default;
+
+  LazyString(LazyString&& that) noexcept
+      : text_(std::move(that.text_)),
+        deferred_(std::move(that.deferred_)),
+        render_(std::exchange(that.render_, nullptr)),
+        template_(std::move(that.template_)),
+        has_template_(std::exchange(that.has_template_, false)) {
+  }
+
+  LazyString& operator=(LazyString that) noexcept {
+    text_ = std::move(that.text_);
+    deferred_ = std::move(that.deferred_);
+    render_ = std::exchange(that.render_, nullptr);
+    template_ = std::move(that.template_);
+    has_template_ = std::exchange(that.has_template_, false);
+    return *this;
+  }
+
+  // F: (fmt::memory_buffer&) const -> void, appends the text
+  // `templ`: static format string the renderer was built from
+  template <typename F>
+  static LazyString Deferred(F renderer, std::string_view templ = {}) {
+    LazyString lazy;
+    lazy.deferred_ = SmallAny{std::move(renderer)};
+    lazy.render_ = &Render<F>;
+    lazy.template_ = SharedString::Borrow(templ);
+    lazy.has_template_ = true;
+    return lazy;
+  }
+
+  // Text rendered elsewhere from `templ`, e.g. a decoded reason
+  // (see wire/codec.hpp): keeps the template for Error::Fingerprint
+  static LazyString Rendered(SharedString text, SharedString templ) {
+    LazyString lazy{std::move(text)};
+    lazy.template_ = std::move(templ);
+    lazy.has_template_ = true;
+    return lazy;
+  }
+
+  bool Empty() const {
+    return render_ == nullptr && text_.Empty();
+  }
+
+  bool IsDeferred() const {
+    return render_ != nullptr;
+  }
+
+  // Copies arena-allocated text to the global heap, see support/arena.hpp
+  LazyString Detach() const {
+    LazyString copy{*this};
+    copy.text_ = text_.Detach();
+    copy.template_ = template_.Detach();
+    return copy;
+  }
+
+  // Format string of a deferred or rendered text, the text itself otherwise
+  // Not rendered, see Error::Fingerprint
+  std::string_view Template() const {
+    return has_template_ ? template_.View() : text_.View();
+  }
+
+  std::string ToString() const {
+    if (render_ != nullptr) {
+      fmt::memory_buffer out;
+      render_(deferred_, out);
+      return fmt::to_string(out);
+    }
+    return text_.ToString();
+  }
+
+  // Renders without intermediate strings
+  void AppendTo(fmt::memory_buffer& out) const {
+    if (render_ != nullptr) {
+      render_(deferred_, out);
+    } else {
+      out.append(text_.View());
+    }
+  }
+
+ private:
+  template <typename F>
+  static void Render(const SmallAny& renderer, fmt::memory_buffer& out) {
+    (*renderer.Get<F>())(out);
+  }
+
+ private:
+  SharedString text_;
+  SmallAny deferred_;
+  RenderFn render_ = nullptr;
+  SharedString template_;
+  bool has_template_ = false;
+};
+
+}  // namespace fallible::detail
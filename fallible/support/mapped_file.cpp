@@ -0,0 +1,72 @@
+#include <fallible/support/mapped_file.hpp>
+
+#include <fallible/result/make.hpp>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <utility>
+
+namespace fallible {
+
+//////////////////////////////////////////////////////////////////////
+
+Result<MappedFile> MappedFile::Open(const std::string& path) {
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return Fail(Err(FromErrno{}).Attr("path", path).Done());
+  }
+
+  struct stat st;
+  if (::fstat(fd, &st) != 0) {
+    int err = errno;
+    ::close(fd);
+    return Fail(Err(FromErrno{err}).Attr("path", path).Done());
+  }
+  auto size = static_cast<size_t>(st.st_size);
+
+  if (size == 0) {
+    // mmap rejects empty mappings
+    ::close(fd);
+    return Ok(MappedFile{});
+  }
+
+  void* base = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+  int err = errno;
+  ::close(fd);
+  if (base == MAP_FAILED) {
+    return Fail(Err(FromErrno{err}).Attr("path", path).Done());
+  }
+
+  return Ok(MappedFile{static_cast<const char*>(base), size});
+}
+
+MappedFile::MappedFile(MappedFile&& that) noexcept
+    : data_(std::exchange(that.data_, nullptr)),
+      size_(std::exchange(that.size_, 0)) {
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& that) noexcept {
+  if (this != &that) {
+    Reset();
+    data_ = std::exchange(that.data_, nullptr);
+    size_ = std::exchange(that.size_, 0);
+  }
+  return *this;
+}
+
+MappedFile::~MappedFile() {
+  Reset();
+}
+
+void MappedFile::Reset() {
+  if (data_ != nullptr) {
+    ::munmap(const_cast<char*>(data_), size_);
+    data_ = nullptr;
+    size_ = 0;
+  }
+}
+
+}  // namespace fallible
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <fallible/result/result.hpp>
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace fallible {
+
+//////////////////////////////////////////////////////////////////////
+
+// Read-only memory mapping of a whole file, move-only
+
+class MappedFile {
+ public:
+  static Result<MappedFile> Open(const std::string& path);
+
+  MappedFile() = default;
+
+  MappedFile(MappedFile&& that) noexcept;
+  MappedFile& operator=(MappedFile&& that) noexcept;
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  ~MappedFile();
+
+  // Contents at the moment of Open
+  std::string_view Bytes() const {
+    return {data_, size_};
+  }
+
+  size_t Size() const {
+    return size_;
+  }
+
+ private:
+  MappedFile(const char* data, size_t size)
+      : data_(data), size_(size) {
+  }
+
+  void Reset();
+
+ private:
+  const char* data_ = nullptr;
+  size_t size_ = 0;
+};
+
+}  // namespace fallible
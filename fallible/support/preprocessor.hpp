@@ -0,0 +1,8 @@
+#pragma once
+
+// Pastes after expanding the arguments, e.g. __COUNTER__
+#define FALLIBLE_CONCAT_IMPL(lhs, rhs) lhs##rhs
+#define FALLIBLE_CONCAT(lhs, rhs) FALLIBLE_CONCAT_IMPL(lhs, rhs)
+
+// Identifier unique within the translation unit
+#define FALLIBLE_UNIQUE_NAME(prefix) FALLIBLE_CONCAT(prefix, __COUNTER__)
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+namespace fallible {
+
+namespace detail {
+
+//////////////////////////////////////////////////////////////////////
+
+// Intrusive reference counter, starts with one reference
+//
+// Two ownership modes:
+// - shared (default): atomic read-modify-write operations
+// - thread-local: plain loads and stores, no lock prefix, no cache-line
+//   ping-pong. All references must stay on the owning thread until
+//   Share() upgrades the counter to the shared mode.
+// - immortal: never freed, Ref / Unref are a single load,
+//   see MakeImmortal
+//
+// Word layout: [count][immortal:1][shared:1]
+
+class RefCounted {
+  static constexpr size_t kShared = 1;
+  static constexpr size_t kImmortal = 2;
+  static constexpr size_t kOne = 4;
+
+ public:
+  void Ref() const noexcept {
+    size_t word = word_.load(std::memory_order_relaxed);
+    if (word & kImmortal) {
+      return;
+    }
+    if (word & kShared) {
+      word_.fetch_add(kOne, std::memory_order_relaxed);
+    } else {
+      word_.store(word + kOne, std::memory_order_relaxed);
+    }
+  }
+
+  // Returns true if the last reference was dropped
+  bool Unref() const noexcept {
+    size_t word = word_.load(std::memory_order_relaxed);
+    if (word & kImmortal) {
+      return false;
+    }
+    if (word & kShared) {
+      return word_.fetch_sub(kOne, std::memory_order_acq_rel) == (kOne | kShared);
+    } else {
+      word_.store(word - kOne, std::memory_order_relaxed);
+      return word == kOne;
+    }
+  }
+
+  bool IsUnique() const noexcept {
+    return (word_.load(std::memory_order_acquire) & ~kShared) == kOne;
+  }
+
+  bool IsShared() const noexcept {
+    return word_.load(std::memory_order_relaxed) & kShared;
+  }
+
+  // Precondition: called by the owning thread before the object
+  // (or any reference to it) is handed to another thread
+  void Share() const noexcept {
+    if ((word_.load(std::memory_order_relaxed) & (kShared | kImmortal)) == 0) {
+      word_.fetch_or(kShared, std::memory_order_release);
+    }
+  }
+
+  // Precondition: freshly created, not yet published
+  void MakeThreadLocal() noexcept {
+    word_.store(kOne, std::memory_order_relaxed);
+  }
+
+  // Leaks the object, reference counting stops writing to it
+  // Precondition: not yet published
+  void MakeImmortal() const noexcept {
+    word_.store(kOne | kImmortal | kShared, std::memory_order_relaxed);
+  }
+
+  bool IsImmortal() const noexcept {
+    return word_.load(std::memory_order_relaxed) & kImmortal;
+  }
+
+ private:
+  mutable std::atomic<size_t> word_{kOne | kShared};
+};
+
+}  // namespace detail
+
+}  // namespace fallible
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace fallible {
+
+//////////////////////////////////////////////////////////////////////
+
+// Object of type T can be moved to another address with memcpy:
+// the source is treated as dead afterwards, its destructor is not called
+
+// Specialize for your own types:
+// template <>
+// struct fallible::IsTriviallyRelocatable<Widget> : std::true_type {};
+
+template <typename T>
+struct IsTriviallyRelocatable : std::is_trivially_copyable<T> {};
+
+template <typename T, typename D>
+struct IsTriviallyRelocatable<std::unique_ptr<T, D>>
+    : IsTriviallyRelocatable<D> {};
+
+template <typename T>
+struct IsTriviallyRelocatable<std::shared_ptr<T>> : std::true_type {};
+
+//////////////////////////////////////////////////////////////////////
+
+// Relocate `count` objects from `from` to uninitialized memory at `to`
+
+template <typename T>
+void Relocate(T* from, size_t count, T* to) {
+  if constexpr (IsTriviallyRelocatable<T>::value) {
+    std::memcpy(static_cast<void*>(to), static_cast<const void*>(from),
+                count * sizeof(T));
+  } else {
+    for (size_t i = 0; i < count; ++i) {
+      new (to + i) T(std::move(from[i]));
+      from[i].~T();
+    }
+  }
+}
+
+}  // namespace fallible
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace fallible::detail {
+
+//////////////////////////////////////////////////////////////////////
+
+// Type-erased copyable value with small buffer optimization
+// Small nothrow-movable values are stored inline, everything else on the heap
+// No RTTI: types are identified by the address of a per-type vtable
+
+class SmallAny {
+  static constexpr size_t kInlineSize = 3 * sizeof(void*);
+
+  template <typename T>
+  static constexpr bool kFitsInline =
+      sizeof(T) <= kInlineSize && alignof(T) <= alignof(void*) &&
+      std::is_nothrow_move_constructible_v<T>;
+
+  struct VTable {
+    void (*copy)(const SmallAny& from, SmallAny& to);
+    void (*move)(SmallAny& from, SmallAny& to) noexcept;
+    void (*destroy)(SmallAny& self) noexcept;
+  };
+
+ public:
+  SmallAny() = default;
+
+  template <typename T>
+  requires (!std::is_same_v<std::decay_t<T>, SmallAny>)
+  explicit SmallAny(T&& value) {
+    Emplace<std::decay_t<T>>(std::forward<T>(value));
+  }
+
+  SmallAny(const SmallAny& that) {
+    if (that.vtable_ != nullptr) {
+      that.vtable_->copy(that, *this);
+    }
+  }
+
+  SmallAny(SmallAny&& that) noexcept {
+    if (that.vtable_ != nullptr) {
+      that.vtable_->move(that, *this);
+    }
+  }
+
+  SmallAny& operator=(SmallAny that) noexcept {
+    Reset();
+    if (that.vtable_ != nullptr) {
+      that.vtable_->move(that, *this);
+    }
+    return *this;
+  }
+
+  ~SmallAny() {
+    Reset();
+  }
+
+  bool HasValue() const {
+    return vtable_ != nullptr;
+  }
+
+  // nullptr if empty or holds another type
+  template <typename T>
+  const T* Get() const {
+    if (vtable_ != &kVTable<T>) {
+      return nullptr;
+    }
+    return Object<T>();
+  }
+
+  template <typename T>
+  static constexpr bool IsInline() {
+    return kFitsInline<T>;
+  }
+
+  void Reset() noexcept {
+    if (vtable_ != nullptr) {
+      vtable_->destroy(*this);
+      vtable_ = nullptr;
+    }
+  }
+
+ private:
+  template <typename T, typename... Args>
+  void Emplace(Args&&... args) {
+    if constexpr (kFitsInline<T>) {
+      new (storage_) T(std::forward<Args>(args)...);
+    } else {
+      heap_ = new T(std::forward<Args>(args)...);
+    }
+    vtable_ = &kVTable<T>;
+  }
+
+  template <typename T>
+  const T* Object() const {
+    if constexpr (kFitsInline<T>) {
+      return std::launder(reinterpret_cast<const T*>(storage_));
+    } else {
+      return static_cast<const T*>(heap_);
+    }
+  }
+
+  template <typename T>
+  T* Object() {
+    return const_cast<T*>(std::as_const(*this).template Object<T>());
+  }
+
+  template <typename T>
+  static void Copy(const SmallAny& from, SmallAny& to) {
+    to.Emplace<T>(*from.Object<T>());
+  }
+
+  template <typename T>
+  static void Move(SmallAny& from, SmallAny& to) noexcept {
+    if constexpr (kFitsInline<T>) {
+      new (to.storage_) T(std::move(*from.Object<T>()));
+      from.Object<T>()->~T();
+    } else {
+      to.heap_ = std::exchange(from.heap_, nullptr);
+    }
+    to.vtable_ = std::exchange(from.vtable_, nullptr);
+  }
+
+  template <typename T>
+  static void Destroy(SmallAny& self) noexcept {
+    if constexpr (kFitsInline<T>) {
+      self.Object<T>()->~T();
+    } else {
+      delete self.Object<T>();
+    }
+  }
+
+  template <typename T>
+  static constexpr VTable kVTable{&Copy<T>, &Move<T>, &Destroy<T>};
+
+ private:
+  union {
+    alignas(void*) std::byte storage_[kInlineSize];
+    void* heap_;
+  };
+  const VTable* vtable_ = nullptr;
+};
+
+}  // namespace fallible::detail
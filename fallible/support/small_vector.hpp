@@ -0,0 +1,164 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace fallible::detail {
+
+//////////////////////////////////////////////////////////////////////
+
+// Vector with inline storage for the first N elements
+// Minimal: only what flat containers need (ordered insert, iteration)
+
+template <typename T, size_t N>
+class SmallVector {
+ public:
+  using Iterator = T*;
+  using ConstIterator = const T*;
+
+  SmallVector() = default;
+
+  SmallVector(const SmallVector& that) {
+    Reserve(that.size_);
+    std::uninitialized_copy(that.begin(), that.end(), data_);
+    size_ = that.size_;
+  }
+
+  SmallVector(SmallVector&& that) noexcept {
+    Steal(that);
+  }
+
+  SmallVector& operator=(const SmallVector& that) {
+    if (this != &that) {
+      SmallVector copy{that};
+      Clear();
+      Steal(copy);
+    }
+    return *this;
+  }
+
+  SmallVector& operator=(SmallVector&& that) noexcept {
+    if (this != &that) {
+      Clear();
+      Steal(that);
+    }
+    return *this;
+  }
+
+  ~SmallVector() {
+    Clear();
+  }
+
+  size_t size() const {
+    return size_;
+  }
+
+  bool empty() const {
+    return size_ == 0;
+  }
+
+  bool IsInline() const {
+    return data_ == Inline();
+  }
+
+  T* begin() {
+    return data_;
+  }
+
+  T* end() {
+    return data_ + size_;
+  }
+
+  const T* begin() const {
+    return data_;
+  }
+
+  const T* end() const {
+    return data_ + size_;
+  }
+
+  T& operator[](size_t index) {
+    return data_[index];
+  }
+
+  const T& operator[](size_t index) const {
+    return data_[index];
+  }
+
+  // Returns iterator to the inserted element
+  T* Insert(const T* pos, T value) {
+    size_t index = pos - data_;
+    if (size_ == capacity_) {
+      Reserve(capacity_ * 2);
+    }
+    T* at = data_ + index;
+    if (index == size_) {
+      new (at) T(std::move(value));
+    } else {
+      new (end()) T(std::move(data_[size_ - 1]));
+      std::move_backward(at, end() - 1, end());
+      *at = std::move(value);
+    }
+    ++size_;
+    return at;
+  }
+
+  void Clear() {
+    std::destroy(begin(), end());
+    size_ = 0;
+    if (!IsInline()) {
+      ::operator delete(data_);
+      data_ = Inline();
+      capacity_ = N;
+    }
+  }
+
+ private:
+  T* Inline() {
+    return std::launder(reinterpret_cast<T*>(inline_));
+  }
+
+  const T* Inline() const {
+    return std::launder(reinterpret_cast<const T*>(inline_));
+  }
+
+  void Reserve(size_t capacity) {
+    if (capacity <= capacity_) {
+      return;
+    }
+    T* heap = static_cast<T*>(::operator new(capacity * sizeof(T)));
+    std::uninitialized_move(begin(), end(), heap);
+    std::destroy(begin(), end());
+    if (!IsInline()) {
+      ::operator delete(data_);
+    }
+    data_ = heap;
+    capacity_ = static_cast<uint32_t>(capacity);
+  }
+
+  // Precondition: this vector is empty and inline
+  void Steal(SmallVector& that) noexcept {
+    if (that.IsInline()) {
+      std::uninitialized_move(that.begin(), that.end(), Inline());
+      size_ = that.size_;
+      that.Clear();
+    } else {
+      data_ = std::exchange(that.data_, that.Inline());
+      size_ = std::exchange(that.size_, 0);
+      capacity_ = std::exchange(that.capacity_, N);
+    }
+  }
+
+ private:
+  alignas(T) std::byte inline_[N * sizeof(T)];
+  T* data_ = Inline();
+  // Small by design, 32 bits keep the header at two words
+  uint32_t size_ = 0;
+  uint32_t capacity_ = N;
+};
+
+}  // namespace fallible::detail
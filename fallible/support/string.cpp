@@ -0,0 +1,70 @@
+#include <fallible/support/string.hpp>
+
+#include <fallible/support/arena.hpp>
+
+#include <cstring>
+#include <new>
+
+namespace fallible {
+
+// Characters follow the header in the same allocation
+struct SharedString::Block : detail::RefCounted {
+  // See support/arena.hpp
+  ErrorArena* arena = nullptr;
+
+  char* Chars() {
+    return reinterpret_cast<char*>(this + 1);
+  }
+};
+
+SharedString SharedString::Copy(std::string_view str) {
+  if (str.empty()) {
+    return {};
+  }
+
+  SharedString copy = Allocate(str.size());
+  std::memcpy(copy.MutableData(), str.data(), str.size());
+  return copy;
+}
+
+SharedString SharedString::Allocate(size_t chars) {
+  if (chars == 0) {
+    return {};
+  }
+
+  ErrorArena* arena = detail::CurrentArena();
+  size_t size = sizeof(Block) + chars;
+
+  void* memory = arena != nullptr
+                     ? detail::ArenaAllocate(arena, size, alignof(Block))
+                     : ::operator new(size);
+  auto* block = new (memory) Block{};
+  block->arena = arena;
+  return SharedString{block->Chars(), chars, block};
+}
+
+void SharedString::Ref() {
+  block_->Ref();
+}
+
+void SharedString::Unref() {
+  if (block_->Unref()) {
+    ErrorArena* arena = block_->arena;
+    block_->~Block();
+    if (arena != nullptr) {
+      detail::ArenaRelease(arena);
+    } else {
+      ::operator delete(block_);
+    }
+  }
+}
+
+SharedString SharedString::Detach() const {
+  if (block_ != nullptr && block_->arena != nullptr) {
+    detail::HeapScope heap;
+    return Copy(View());
+  }
+  return *this;
+}
+
+}  // namespace fallible
@@ -0,0 +1,208 @@
+#pragma once
+
+#include <fallible/support/ref_counted.hpp>
+
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+namespace fallible {
+
+//////////////////////////////////////////////////////////////////////
+
+// String literal (or other constant expression with static storage)
+// Usage: .Domain("Rpc")
+// Sized up to the first NUL, so an oversized constant buffer
+// does not carry its padding
+
+class Literal {
+ public:
+  template <size_t N>
+  consteval Literal(const char (&str)[N])  // NOLINT
+      : str_(str, std::char_traits<char>::length(str)) {
+  }
+
+  constexpr std::string_view View() const {
+    return str_;
+  }
+
+ private:
+  std::string_view str_;
+};
+
+//////////////////////////////////////////////////////////////////////
+
+namespace detail {
+
+// Dynamic string, copied once when stored
+// String literals bind to Literal overloads and are not copied,
+// mutable char buffers (e.g. filled by snprintf) are dynamic
+
+template <typename S>
+concept DynamicString =
+    std::constructible_from<std::string_view, S> &&
+    !(std::is_array_v<std::remove_reference_t<S>> &&
+      std::is_const_v<std::remove_extent_t<std::remove_reference_t<S>>>);
+
+}  // namespace detail
+
+//////////////////////////////////////////////////////////////////////
+
+// Immutable string that either borrows static storage
+// or owns a ref-counted copy (single allocation)
+
+class SharedString {
+  struct Block;
+
+ public:
+  SharedString() = default;
+
+  SharedString(Literal literal)  // NOLINT
+      : data_(literal.View().data()),
+        size_(literal.View().size()) {
+  }
+
+  // Precondition: `str` has static storage duration
+  static SharedString Borrow(std::string_view str) {
+    return SharedString{str.data(), str.size(), nullptr};
+  }
+
+  static SharedString Copy(std::string_view str);
+
+  // Owned characters to be written through MutableData,
+  // e.g. a receive buffer (see wire/codec.hpp)
+  static SharedString Allocate(size_t size);
+
+  // Precondition: allocated by Allocate and not shared yet
+  char* MutableData() {
+    return const_cast<char*>(data_);
+  }
+
+  SharedString(const SharedString& that) noexcept
+      : data_(that.data_), size_(that.size_), block_(that.block_) {
+    if (block_ != nullptr) {
+      Ref();
+    }
+  }
+
+  SharedString(SharedString&& that) noexcept
+      : data_(that.data_), size_(that.size_), block_(that.block_) {
+    that.Reset();
+  }
+
+  SharedString& operator=(SharedString that) noexcept {
+    std::swap(data_, that.data_);
+    std::swap(size_, that.size_);
+    std::swap(block_, that.block_);
+    return *this;
+  }
+
+  ~SharedString() {
+    if (block_ != nullptr) {
+      Unref();
+    }
+  }
+
+  std::string_view View() const {
+    return {data_, size_};
+  }
+
+  std::string ToString() const {
+    return std::string{View()};
+  }
+
+  bool Empty() const {
+    return size_ == 0;
+  }
+
+  bool IsOwned() const {
+    return block_ != nullptr;
+  }
+
+  // Zero-copy: shares ownership of the characters
+  // Precondition: pos + count <= size
+  SharedString Substr(size_t pos, size_t count) const {
+    return SharedString{*this, data_ + pos, count};
+  }
+
+  // Copies arena-allocated characters to the global heap,
+  // see support/arena.hpp
+  SharedString Detach() const;
+
+ private:
+  SharedString(const char* data, size_t size, Block* block)
+      : data_(data), size_(size), block_(block) {
+  }
+
+  // Shares the block of `owner`
+  SharedString(const SharedString& owner, const char* data, size_t size)
+      : SharedString(owner) {
+    data_ = data;
+    size_ = size;
+  }
+
+  void Reset() {
+    data_ = "";
+    size_ = 0;
+    block_ = nullptr;
+  }
+
+  void Ref();
+  void Unref();
+
+ private:
+  const char* data_ = "";
+  size_t size_ = 0;
+  Block* block_ = nullptr;
+};
+
+//////////////////////////////////////////////////////////////////////
+
+// Non-owning string argument that remembers whether it is a literal
+// Usage: void Set(StringArg key, StringArg value);
+
+class StringArg {
+ public:
+  template <size_t N>
+  consteval StringArg(const char (&str)[N])  // NOLINT
+      : str_(str, std::char_traits<char>::length(str)), literal_(true) {
+  }
+
+  // Mutable buffer: sized up to the first NUL and copied when stored
+  template <size_t N>
+  StringArg(char (&str)[N])  // NOLINT
+      : str_(str, std::char_traits<char>::length(str)), literal_(false) {
+  }
+
+  StringArg(Literal literal)  // NOLINT
+      : str_(literal.View()), literal_(true) {
+  }
+
+  template <detail::DynamicString S>
+  StringArg(const S& str)  // NOLINT
+      : str_(str), literal_(false) {
+  }
+
+  std::string_view View() const {
+    return str_;
+  }
+
+  bool IsLiteral() const {
+    return literal_;
+  }
+
+  // Borrows literals, copies everything else
+  SharedString ToShared() const {
+    return literal_ ? SharedString::Borrow(str_) : SharedString::Copy(str_);
+  }
+
+ private:
+  std::string_view str_;
+  bool literal_;
+};
+
+}  // namespace fallible
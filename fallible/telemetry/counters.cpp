@@ -0,0 +1,264 @@
+#include <fallible/telemetry/counters.hpp>
+
+#include <fallible/error/codes.hpp>
+#include <fallible/support/hash.hpp>
+
+#include <wheels/core/singleton.hpp>
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <tuple>
+#include <unordered_set>
+
+namespace fallible {
+
+//////////////////////////////////////////////////////////////////////
+
+const char* ErrorEventName(ErrorEvent event) {
+  switch (event) {
+    case ErrorEvent::Created:
+      return "created";
+    case ErrorEvent::Propagated:
+      return "propagated";
+    case ErrorEvent::Recovered:
+      return "recovered";
+    case ErrorEvent::Ignored:
+      return "ignored";
+    case ErrorEvent::Unexpected:
+      return "unexpected";
+  }
+  return "unknown";
+}
+
+uint64_t ErrorTelemetrySnapshot::Total(ErrorEvent event) const {
+  uint64_t total = 0;
+  for (const auto& counter : counters) {
+    total += counter.Count(event);
+  }
+  return total;
+}
+
+namespace detail {
+
+std::atomic<bool> error_telemetry_enabled{false};
+
+}  // namespace detail
+
+void EnableErrorTelemetry(bool enable) {
+  detail::error_telemetry_enabled.store(enable, std::memory_order_relaxed);
+}
+
+//////////////////////////////////////////////////////////////////////
+
+namespace {
+
+// Per-thread open-addressing table, written only by its owner
+// Readers (snapshots) see entries published with release stores
+
+class Shard {
+  static constexpr size_t kCapacity = 512;
+  static constexpr size_t kMaxProbes = 16;
+
+  struct Entry {
+    // 0 = empty, set last
+    std::atomic<uint64_t> hash{0};
+    int32_t code = 0;
+    SiteId site = 0;
+    std::string domain;
+    std::array<std::atomic<uint64_t>, kErrorEventCount> counts{};
+  };
+
+ public:
+  void Count(ErrorEvent event, int32_t code, SiteId site, std::string_view domain) {
+    uint64_t hash = detail::HashCombine(
+        detail::HashCombine(detail::HashBytes(domain), static_cast<uint32_t>(code)), site);
+    hash += (hash == 0);
+
+    Entry& entry = Find(hash, code, site, domain);
+    auto& counter = entry.counts[static_cast<size_t>(event)];
+    // Single writer: no read-modify-write
+    counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  }
+
+  template <typename F>
+  void ForEach(F visitor) const {
+    for (const Entry& entry : entries_) {
+      if (entry.hash.load(std::memory_order_acquire) != 0) {
+        Visit(entry, visitor);
+      }
+    }
+    if (overflow_.hash.load(std::memory_order_acquire) != 0) {
+      Visit(overflow_, visitor);
+    }
+  }
+
+  // Racy with the owner, counts may be lost
+  void Reset() {
+    for (Entry& entry : entries_) {
+      for (auto& counter : entry.counts) {
+        counter.store(0, std::memory_order_relaxed);
+      }
+    }
+    for (auto& counter : overflow_.counts) {
+      counter.store(0, std::memory_order_relaxed);
+    }
+  }
+
+ private:
+  Entry& Find(uint64_t hash, int32_t code, SiteId site, std::string_view domain) {
+    for (size_t probe = 0; probe < kMaxProbes; ++probe) {
+      Entry& entry = entries_[(hash + probe) % kCapacity];
+      uint64_t entry_hash = entry.hash.load(std::memory_order_relaxed);
+      if (entry_hash == 0) {
+        // Slow path: once per key per thread
+        entry.code = code;
+        entry.site = site;
+        entry.domain = domain;
+        entry.hash.store(hash, std::memory_order_release);
+        return entry;
+      }
+      if (entry_hash == hash && entry.code == code && entry.site == site &&
+          entry.domain == domain) {
+        return entry;
+      }
+    }
+
+    // Table is full: anonymous bucket
+    if (overflow_.hash.load(std::memory_order_relaxed) == 0) {
+      overflow_.code = ErrorCodes::Unknown;
+      overflow_.domain = "overflow";
+      overflow_.hash.store(1, std::memory_order_release);
+    }
+    return overflow_;
+  }
+
+  template <typename F>
+  static void Visit(const Entry& entry, F& visitor) {
+    std::array<uint64_t, kErrorEventCount> counts;
+    for (size_t i = 0; i < kErrorEventCount; ++i) {
+      counts[i] = entry.counts[i].load(std::memory_order_relaxed);
+    }
+    visitor(entry.code, entry.site, entry.domain, counts);
+  }
+
+ private:
+  std::array<Entry, kCapacity> entries_;
+  Entry overflow_;
+};
+
+//////////////////////////////////////////////////////////////////////
+
+class ShardRegistry {
+  // code, site, domain
+  using Key = std::tuple<int32_t, SiteId, std::string>;
+  using Counts = std::array<uint64_t, kErrorEventCount>;
+
+ public:
+  void Add(Shard* shard) {
+    std::lock_guard guard(mutex_);
+    live_.insert(shard);
+  }
+
+  // Thread exit: counts are kept
+  void Retire(Shard* shard) {
+    std::lock_guard guard(mutex_);
+    live_.erase(shard);
+    shard->ForEach(Accumulator{retired_});
+  }
+
+  ErrorTelemetrySnapshot Snapshot() const {
+    std::map<Key, Counts> totals;
+    {
+      std::lock_guard guard(mutex_);
+      totals = retired_;
+      for (const Shard* shard : live_) {
+        shard->ForEach(Accumulator{totals});
+      }
+    }
+
+    ErrorTelemetrySnapshot snapshot;
+    snapshot.counters.reserve(totals.size());
+    for (auto& [key, counts] : totals) {
+      auto& [code, site, domain] = key;
+      snapshot.counters.push_back({code, domain, site, counts});
+    }
+    return snapshot;
+  }
+
+  void Reset() {
+    std::lock_guard guard(mutex_);
+    retired_.clear();
+    for (Shard* shard : live_) {
+      shard->Reset();
+    }
+  }
+
+ private:
+  struct Accumulator {
+    std::map<Key, Counts>& totals;
+
+    void operator()(int32_t code, SiteId site, const std::string& domain,
+                    const Counts& counts) {
+      auto& total = totals[Key{code, site, domain}];
+      for (size_t i = 0; i < kErrorEventCount; ++i) {
+        total[i] += counts[i];
+      }
+    }
+  };
+
+ private:
+  mutable std::mutex mutex_;
+  std::unordered_set<Shard*> live_;
+  std::map<Key, Counts> retired_;
+};
+
+ShardRegistry& Registry() {
+  return LeakySingleton<ShardRegistry>();
+}
+
+// Allocated on the first event of the thread
+class ShardHolder {
+ public:
+  Shard& Get() {
+    if (!shard_) {
+      shard_ = std::make_unique<Shard>();
+      Registry().Add(shard_.get());
+    }
+    return *shard_;
+  }
+
+  ~ShardHolder() {
+    if (shard_) {
+      Registry().Retire(shard_.get());
+    }
+  }
+
+ private:
+  std::unique_ptr<Shard> shard_;
+};
+
+thread_local ShardHolder shard;
+
+}  // namespace
+
+//////////////////////////////////////////////////////////////////////
+
+namespace detail {
+
+void ErrorCounters::Count(ErrorEvent event, const Error& error) {
+  shard.Get().Count(event, error.Code(), error.Site(), error.FrameDomainView());
+}
+
+}  // namespace detail
+
+ErrorTelemetrySnapshot SnapshotErrorTelemetry() {
+  return Registry().Snapshot();
+}
+
+void ResetErrorTelemetry() {
+  Registry().Reset();
+}
+
+}  // namespace fallible
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <fallible/error/error.hpp>
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace fallible {
+
+//////////////////////////////////////////////////////////////////////
+
+// Opt-in error telemetry: counts of errors created, propagated,
+// recovered, ignored and unexpected (ExpectOk) by code, domain and
+// call site
+//
+// Each thread counts into its own shard with plain relaxed stores,
+// shards are aggregated on snapshot. Disabled telemetry costs a single
+// relaxed load per event.
+//
+// Usage:
+//   fallible::EnableErrorTelemetry();
+//   ...
+//   auto snapshot = fallible::SnapshotErrorTelemetry();
+//   fallible::WritePrometheusFile(snapshot, "/var/lib/node_exporter/app.prom");
+
+enum class ErrorEvent : uint8_t {
+  // Err(...).Done(), fallible::Fail(StaticError)
+  Created = 0,
+  // PropagateError, WrapError, Map, Wrap frames
+  Propagated,
+  // Result::Recover
+  Recovered,
+  // Result::Ignore
+  Ignored,
+  // Result::ExpectOk and friends
+  Unexpected,
+};
+
+inline constexpr size_t kErrorEventCount = 5;
+
+const char* ErrorEventName(ErrorEvent event);
+
+void EnableErrorTelemetry(bool enable = true);
+
+struct ErrorCounter {
+  int32_t code;
+  std::string domain;
+  SiteId site;
+  // Indexed by ErrorEvent
+  std::array<uint64_t, kErrorEventCount> counts{};
+
+  uint64_t Count(ErrorEvent event) const {
+    return counts[static_cast<size_t>(event)];
+  }
+};
+
+struct ErrorTelemetrySnapshot {
+  // Sorted by code, site and domain
+  std::vector<ErrorCounter> counters;
+
+  // Sum over codes, domains and sites
+  uint64_t Total(ErrorEvent event) const;
+};
+
+// Live threads and threads that already exited
+ErrorTelemetrySnapshot SnapshotErrorTelemetry();
+
+// Zeroes the counters of all threads, for tests
+void ResetErrorTelemetry();
+
+//////////////////////////////////////////////////////////////////////
+
+namespace detail {
+
+extern std::atomic<bool> error_telemetry_enabled;
+
+// Reads fields of Error without allocations
+struct ErrorCounters {
+  static void Count(ErrorEvent event, const Error& error);
+};
+
+// Lightweight errors are not counted
+template <typename E>
+void CountError(ErrorEvent event, const E& error) {
+  if constexpr (std::is_same_v<E, Error>) {
+    if (error_telemetry_enabled.load(std::memory_order_relaxed)) {
+      ErrorCounters::Count(event, error);
+    }
+  }
+}
+
+}  // namespace detail
+
+}  // namespace fallible
@@ -0,0 +1,489 @@
+#include <fallible/telemetry/flight.hpp>
+
+#include <fallible/error/codes.hpp>
+#include <fallible/result/make.hpp>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <sstream>
+#include <string_view>
+
+namespace fallible {
+
+//////////////////////////////////////////////////////////////////////
+
+// File layout:
+//   [FileHeader, 4 KiB][RingHeader x max_threads][Record x records_per_thread] x max_threads
+// Little-endian, fixed-size records, see Record
+
+namespace {
+
+constexpr char kMagic[8] = {'F', 'A', 'L', 'F', 'L', 'T', '0', '1'};
+constexpr uint32_t kVersion = 1;
+
+constexpr uint32_t kRecording = 0;
+constexpr uint32_t kSealed = 1;
+
+struct FileHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t max_threads;
+  uint32_t records_per_thread;
+  uint32_t record_size;
+  std::atomic<uint32_t> state;
+  uint32_t panic_line;
+  uint64_t start_time_ns;
+  uint64_t seal_time_ns;
+  char panic_file[256];
+  char panic_reason[3072];
+};
+
+constexpr size_t kFileHeaderSize = 4096;
+static_assert(sizeof(FileHeader) <= kFileHeaderSize);
+
+struct alignas(64) RingHeader {
+  // Owning thread, 0 = free
+  std::atomic<uint32_t> owner;
+  // Records written so far
+  std::atomic<uint64_t> head;
+};
+
+constexpr size_t kRecordSize = 256;
+
+struct Record {
+  // ring index + 1 once complete, torn records do not match
+  std::atomic<uint64_t> seq;
+  uint64_t time_ns;
+  uint32_t thread;
+  int32_t code;
+  uint32_t line;
+  uint16_t file_size;
+  uint16_t function_size;
+  uint16_t domain_size;
+  uint16_t reason_size;
+  // file, function, domain, reason
+  char data[kRecordSize - 36];
+};
+
+static_assert(sizeof(Record) == kRecordSize);
+
+uint64_t NowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+
+// Keeps the tail of paths (file name), the head of everything else
+size_t Pack(char*& out, size_t& budget, std::string_view str, bool keep_tail) {
+  size_t size = std::min(str.size(), budget);
+  if (size == 0) {
+    return 0;  // Empty views may have no data
+  }
+  if (keep_tail) {
+    str = str.substr(str.size() - size);
+  }
+  std::memcpy(out, str.data(), size);
+  out += size;
+  budget -= size;
+  return size;
+}
+
+void CopyTruncated(char* to, size_t capacity, std::string_view from) {
+  size_t size = std::min(from.size(), capacity - 1);
+  if (size > 0) {
+    std::memcpy(to, from.data(), size);
+  }
+  to[size] = '\0';
+}
+
+}  // namespace
+
+//////////////////////////////////////////////////////////////////////
+
+namespace detail {
+
+class FlightRecorder {
+ public:
+  FlightRecorder(char* base, size_t size)
+      : base_(base), size_(size) {
+  }
+
+  FileHeader& Header() const {
+    return *reinterpret_cast<FileHeader*>(base_);
+  }
+
+  RingHeader& Ring(size_t index) const {
+    return reinterpret_cast<RingHeader*>(base_ + kFileHeaderSize)[index];
+  }
+
+  Record& At(size_t ring, uint64_t index) const {
+    const FileHeader& header = Header();
+    char* records = base_ + kFileHeaderSize + header.max_threads * sizeof(RingHeader);
+    size_t offset = (ring * header.records_per_thread + index % header.records_per_thread) * kRecordSize;
+    return *reinterpret_cast<Record*>(records + offset);
+  }
+
+  // Free ring or the ring of an exited thread, -1 if none
+  int Claim(uint32_t thread) {
+    const size_t rings = Header().max_threads;
+    for (size_t i = 0; i < rings; ++i) {
+      size_t index = (thread + i) % rings;
+      uint32_t expected = 0;
+      if (Ring(index).owner.compare_exchange_strong(expected, thread)) {
+        return static_cast<int>(index);
+      }
+    }
+    return -1;
+  }
+
+  void Release(int ring) {
+    Ring(ring).owner.store(0, std::memory_order_release);
+  }
+
+  void Sync() {
+    msync(base_, size_, MS_SYNC);
+  }
+
+ private:
+  char* base_;
+  size_t size_;
+};
+
+std::atomic<FlightRecorder*> flight_recorder{nullptr};
+
+}  // namespace detail
+
+//////////////////////////////////////////////////////////////////////
+
+namespace {
+
+// Ring of the current thread
+class ThreadRing {
+ public:
+  ~ThreadRing() {
+    if (ring_ >= 0) {
+      recorder_->Release(ring_);
+    }
+  }
+
+  // -1 if all rings are taken
+  int Get(detail::FlightRecorder* recorder) {
+    if (recorder_ != recorder) {
+      recorder_ = recorder;
+      thread_ = static_cast<uint32_t>(syscall(SYS_gettid));
+      ring_ = recorder->Claim(thread_);
+    }
+    return ring_;
+  }
+
+  uint32_t Thread() const {
+    return thread_;
+  }
+
+ private:
+  detail::FlightRecorder* recorder_ = nullptr;
+  uint32_t thread_ = 0;
+  int ring_ = -1;
+};
+
+thread_local ThreadRing thread_ring;
+
+}  // namespace
+
+namespace detail {
+
+void FlightRecorders::Record(FlightRecorder* recorder, const Error& error) {
+  int ring = thread_ring.Get(recorder);
+  if (ring < 0) {
+    return;
+  }
+
+  RingHeader& header = recorder->Ring(ring);
+  // Single writer
+  uint64_t index = header.head.load(std::memory_order_relaxed);
+  auto& record = recorder->At(ring, index);
+
+  record.seq.store(0, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  const SiteInfo& site = GetCallSite(error.Site());
+
+  record.time_ns = NowNs();
+  record.thread = thread_ring.Thread();
+  record.code = error.Code();
+  record.line = static_cast<uint32_t>(site.line);
+
+  char* out = record.data;
+  size_t budget = sizeof(record.data);
+  record.file_size = Pack(out, budget, site.file, /*keep_tail=*/true);
+  record.function_size = Pack(out, budget, site.function, false);
+  record.domain_size = Pack(out, budget, error.FrameDomainView(), false);
+  record.reason_size = Pack(out, budget, error.FrameReasonTemplate(), false);
+
+  record.seq.store(index + 1, std::memory_order_release);
+  header.head.store(index + 1, std::memory_order_release);
+}
+
+void SealFlightRecorder(const wheels::SourceLocation& where,
+                        const std::string& reason) {
+  FlightRecorder* recorder = flight_recorder.load(std::memory_order_acquire);
+  if (recorder == nullptr) {
+    return;
+  }
+
+  FileHeader& header = recorder->Header();
+  uint32_t expected = kRecording;
+  if (!header.state.compare_exchange_strong(expected, kSealed)) {
+    return;  // Already sealed by another panicking thread
+  }
+
+  CopyTruncated(header.panic_file, sizeof(header.panic_file), where.File());
+  CopyTruncated(header.panic_reason, sizeof(header.panic_reason), reason);
+  header.panic_line = static_cast<uint32_t>(where.Line());
+  header.seal_time_ns = NowNs();
+
+  recorder->Sync();
+}
+
+}  // namespace detail
+
+//////////////////////////////////////////////////////////////////////
+
+static size_t FileSize(const FileHeader& header) {
+  return kFileHeaderSize + header.max_threads * sizeof(RingHeader) +
+         size_t{header.max_threads} * header.records_per_thread * kRecordSize;
+}
+
+Status StartFlightRecorder(const std::string& path,
+                           FlightRecorderOptions options) {
+  if (detail::flight_recorder.load() != nullptr) {
+    return Fail(Err(ErrorCodes::AlreadyExists)
+                    .Domain("FlightRecorder")
+                    .Reason("Flight recorder is already started")
+                    .Done());
+  }
+
+  if (options.max_threads == 0 || options.records_per_thread == 0) {
+    return Fail(Err(ErrorCodes::Invalid)
+                    .Domain("FlightRecorder")
+                    .Reason("Empty flight recorder")
+                    .Done());
+  }
+
+  // Stored in 32-bit header fields
+  if (options.max_threads > UINT32_MAX || options.records_per_thread > UINT32_MAX) {
+    return Fail(Err(ErrorCodes::Invalid)
+                    .Domain("FlightRecorder")
+                    .Reason("Flight recorder is too large")
+                    .Attr("max_threads", options.max_threads)
+                    .Attr("records_per_thread", options.records_per_thread)
+                    .Done());
+  }
+
+  FileHeader layout{};
+  layout.max_threads = options.max_threads;
+  layout.records_per_thread = options.records_per_thread;
+  size_t size = FileSize(layout);
+
+  int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    return Fail(Err(FromErrno{}).Attr("path", path).Done());
+  }
+
+  if (::ftruncate(fd, static_cast<off_t>(size)) != 0) {
+    int err = errno;
+    ::close(fd);
+    return Fail(Err(FromErrno{err}).Attr("path", path).Done());
+  }
+
+  void* base = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  int err = errno;
+  ::close(fd);
+  if (base == MAP_FAILED) {
+    return Fail(Err(FromErrno{err}).Attr("path", path).Done());
+  }
+
+  // Zero-filled by ftruncate
+  auto* header = static_cast<FileHeader*>(base);
+  std::memcpy(header->magic, kMagic, sizeof(kMagic));
+  header->version = kVersion;
+  header->max_threads = layout.max_threads;
+  header->records_per_thread = layout.records_per_thread;
+  header->record_size = kRecordSize;
+  header->start_time_ns = NowNs();
+
+  // Leaked: recording threads may outlive any owner
+  auto* recorder = new detail::FlightRecorder(static_cast<char*>(base), size);
+
+  detail::FlightRecorder* expected = nullptr;
+  if (!detail::flight_recorder.compare_exchange_strong(expected, recorder)) {
+    ::munmap(base, size);
+    delete recorder;
+    return Fail(Err(ErrorCodes::AlreadyExists)
+                    .Domain("FlightRecorder")
+                    .Reason("Flight recorder is already started")
+                    .Done());
+  }
+
+  return Ok();
+}
+
+//////////////////////////////////////////////////////////////////////
+
+Result<FlightLog> ReadFlightLog(const std::string& path) {
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return Fail(Err(FromErrno{}).Attr("path", path).Done());
+  }
+
+  struct stat st;
+  if (::fstat(fd, &st) != 0) {
+    int err = errno;
+    ::close(fd);
+    return Fail(Err(FromErrno{err}).Attr("path", path).Done());
+  }
+  size_t size = static_cast<size_t>(st.st_size);
+
+  auto corrupted = [&path](const char* reason) {
+    return Fail(Err(ErrorCodes::Invalid)
+                    .Domain("FlightRecorder")
+                    .Reason(std::string_view{reason})
+                    .Attr("path", path)
+                    .Done());
+  };
+
+  if (size < kFileHeaderSize) {
+    ::close(fd);
+    return corrupted("Truncated header");
+  }
+
+  void* base = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+  int err = errno;
+  ::close(fd);
+  if (base == MAP_FAILED) {
+    return Fail(Err(FromErrno{err}).Attr("path", path).Done());
+  }
+
+  // Decoding reuses the writer layout
+  detail::FlightRecorder file{static_cast<char*>(base), size};
+  const FileHeader& header = file.Header();
+
+  auto unmap = [base, size] {
+    ::munmap(base, size);
+  };
+
+  if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+      header.version != kVersion || header.record_size != kRecordSize) {
+    unmap();
+    return corrupted("Not a flight recorder file");
+  }
+  // Damaged headers: rings are indexed modulo records_per_thread
+  if (header.max_threads == 0 || header.records_per_thread == 0) {
+    unmap();
+    return corrupted("Empty rings");
+  }
+  // FileSize may overflow for garbage values
+  if (size_t{header.max_threads} * header.records_per_thread > size / kRecordSize ||
+      FileSize(header) > size) {
+    unmap();
+    return corrupted("Truncated rings");
+  }
+
+  FlightLog log;
+  log.sealed = header.state.load() == kSealed;
+  if (log.sealed) {
+    log.panic_file = std::string(header.panic_file, strnlen(header.panic_file, sizeof(header.panic_file)));
+    log.panic_line = static_cast<int>(header.panic_line);
+    log.panic_reason = std::string(header.panic_reason, strnlen(header.panic_reason, sizeof(header.panic_reason)));
+  }
+
+  for (size_t ring = 0; ring < header.max_threads; ++ring) {
+    uint64_t head = file.Ring(ring).head.load(std::memory_order_acquire);
+    uint64_t first = head > header.records_per_thread ? head - header.records_per_thread : 0;
+
+    for (uint64_t index = first; index < head; ++index) {
+      // Live file: the owner may be overwriting the record,
+      // copy it and check the sequence number again (seqlock)
+      const Record& live = file.At(ring, index);
+      uint64_t seq = live.seq.load(std::memory_order_acquire);
+      Record record;
+      std::memcpy(static_cast<void*>(&record), &live, sizeof(Record));
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (seq != index + 1 || live.seq.load(std::memory_order_relaxed) != seq) {
+        continue;  // Torn
+      }
+      size_t total = size_t{record.file_size} + record.function_size +
+                     record.domain_size + record.reason_size;
+      if (total > sizeof(record.data)) {
+        continue;
+      }
+
+      const char* data = record.data;
+      auto take = [&data](uint16_t size) {
+        std::string str{data, size};
+        data += size;
+        return str;
+      };
+
+      FlightRecord decoded;
+      decoded.thread = record.thread;
+      decoded.index = index;
+      decoded.time_ns = record.time_ns;
+      decoded.code = record.code;
+      decoded.line = static_cast<int>(record.line);
+      decoded.file = take(record.file_size);
+      decoded.function = take(record.function_size);
+      decoded.domain = take(record.domain_size);
+      decoded.reason = take(record.reason_size);
+
+      log.records.push_back(std::move(decoded));
+    }
+  }
+
+  unmap();
+
+  std::stable_sort(log.records.begin(), log.records.end(),
+                   [](const FlightRecord& lhs, const FlightRecord& rhs) {
+                     return lhs.time_ns < rhs.time_ns;
+                   });
+
+  return Ok(std::move(log));
+}
+
+std::string Describe(const FlightLog& log) {
+  std::stringstream out;
+
+  if (log.sealed) {
+    out << "Panicked at " << log.panic_file << ":" << log.panic_line << ": "
+        << log.panic_reason << "\n";
+  } else {
+    out << "Not sealed (process is running or was killed)\n";
+  }
+
+  out << log.records.size() << " errors, oldest first:\n";
+
+  for (const auto& record : log.records) {
+    out << "[" << record.time_ns << "] thread " << record.thread
+        << " code = " << record.code
+        << " at " << record.file << ":" << record.line << " in " << record.function;
+    if (!record.domain.empty()) {
+      out << ", domain = " << record.domain;
+    }
+    if (!record.reason.empty()) {
+      out << ", reason = '" << record.reason << "'";
+    }
+    out << "\n";
+  }
+
+  return out.str();
+}
+
+}  // namespace fallible
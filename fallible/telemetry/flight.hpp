@@ -0,0 +1,103 @@
+#pragma once
+
+#include <fallible/error/error.hpp>
+#include <fallible/result/result.hpp>
+
+#include <wheels/core/source_location.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace fallible {
+
+//////////////////////////////////////////////////////////////////////
+
+// Flight recorder: the last errors created by each thread, kept in
+// per-thread rings of fixed-size binary records in a memory-mapped file
+//
+// Recording is lock-free and allocation-free: one record is a few
+// memcpy-s of the code, location, domain and reason template (format
+// string, never rendered). The file survives a crash of the process
+// (dirty pages stay in the page cache), the abort panicker seals it
+// with the panic location and reason, see rt/abort.cpp.
+//
+// Decode with ReadFlightLog or the fallible-flight tool.
+//
+// Usage: once at startup
+//   fallible::StartFlightRecorder("/var/tmp/app.flight").ExpectOk();
+
+struct FlightRecorderOptions {
+  // Threads beyond the limit share the rings of exited threads or are
+  // not recorded
+  size_t max_threads = 64;
+  size_t records_per_thread = 256;
+};
+
+// Once per process, the recorder lives until exit
+Status StartFlightRecorder(const std::string& path,
+                           FlightRecorderOptions options = {});
+
+//////////////////////////////////////////////////////////////////////
+
+// Decoding
+
+struct FlightRecord {
+  uint32_t thread;
+  // Per-thread ring index
+  uint64_t index;
+  // Since epoch
+  uint64_t time_ns;
+  int32_t code;
+  // Possibly truncated
+  std::string file;
+  std::string function;
+  int line;
+  std::string domain;
+  std::string reason;
+};
+
+struct FlightLog {
+  // Sealed by the panicker
+  bool sealed = false;
+  std::string panic_file;
+  int panic_line = 0;
+  std::string panic_reason;
+
+  // Oldest first
+  std::vector<FlightRecord> records;
+};
+
+// Torn records (written at the moment of the crash) are skipped
+Result<FlightLog> ReadFlightLog(const std::string& path);
+
+std::string Describe(const FlightLog& log);
+
+//////////////////////////////////////////////////////////////////////
+
+namespace detail {
+
+class FlightRecorder;
+
+extern std::atomic<FlightRecorder*> flight_recorder;
+
+// Reads fields of Error without allocations
+struct FlightRecorders {
+  static void Record(FlightRecorder* recorder, const Error& error);
+};
+
+inline void RecordFlight(const Error& error) {
+  if (FlightRecorder* recorder = flight_recorder.load(std::memory_order_acquire)) {
+    FlightRecorders::Record(recorder, error);
+  }
+}
+
+// Called by the panicker before abort, no-op if not started
+void SealFlightRecorder(const wheels::SourceLocation& where,
+                        const std::string& reason);
+
+}  // namespace detail
+
+}  // namespace fallible
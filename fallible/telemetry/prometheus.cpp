@@ -0,0 +1,103 @@
+#include <fallible/telemetry/prometheus.hpp>
+
+#include <fallible/error/codes.hpp>
+#include <fallible/result/make.hpp>
+
+#include <fmt/format.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <string_view>
+
+namespace fallible {
+
+//////////////////////////////////////////////////////////////////////
+
+// Label values escape backslash, double quote and line feed
+static void AppendLabel(std::string& out, std::string_view name, std::string_view value) {
+  out += name;
+  out += "=\"";
+  for (char c : value) {
+    switch (c) {
+      case '\\':
+        out += "\\\\";
+        break;
+      case '"':
+        out += "\\\"";
+        break;
+      case '\n':
+        out += "\\n";
+        break;
+      default:
+        out += c;
+    }
+  }
+  out += '"';
+}
+
+// Canonical and registered codes by name
+static std::string CodeLabel(int32_t code) {
+  if (auto name = FindErrorCodeName(code)) {
+    return std::string{*name};
+  }
+  return std::to_string(code);
+}
+
+void WritePrometheus(const ErrorTelemetrySnapshot& snapshot, std::string& out) {
+  out += "# HELP fallible_errors_total Errors by event, code, domain and call site\n";
+  out += "# TYPE fallible_errors_total counter\n";
+
+  for (const auto& counter : snapshot.counters) {
+    auto site = GetCallSite(counter.site);
+    std::string where = site.id != 0 ? fmt::format("{}:{}", site.file, site.line) : "";
+
+    for (size_t i = 0; i < kErrorEventCount; ++i) {
+      if (counter.counts[i] == 0) {
+        continue;
+      }
+      out += "fallible_errors_total{";
+      AppendLabel(out, "event", ErrorEventName(static_cast<ErrorEvent>(i)));
+      out += ',';
+      AppendLabel(out, "code", CodeLabel(counter.code));
+      out += ',';
+      AppendLabel(out, "domain", counter.domain);
+      out += ',';
+      AppendLabel(out, "site", where);
+      out += "} ";
+      out += std::to_string(counter.counts[i]);
+      out += '\n';
+    }
+  }
+}
+
+Status WritePrometheusFile(const ErrorTelemetrySnapshot& snapshot,
+                           const std::string& path) {
+  std::string text;
+  WritePrometheus(snapshot, text);
+
+  std::string tmp_path = path + ".tmp";
+
+  FILE* file = std::fopen(tmp_path.c_str(), "w");
+  if (file == nullptr) {
+    return Fail(Err(FromErrno{}).Attr("path", tmp_path).Done());
+  }
+
+  bool written = std::fwrite(text.data(), 1, text.size(), file) == text.size();
+  int err = errno;
+  if (std::fclose(file) != 0 && written) {
+    written = false;
+    err = errno;
+  }
+  if (!written) {
+    std::remove(tmp_path.c_str());
+    return Fail(Err(FromErrno{err}).Attr("path", tmp_path).Done());
+  }
+
+  if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+    return Fail(Err(FromErrno{}).Attr("path", path).Done());
+  }
+
+  return Ok();
+}
+
+}  // namespace fallible
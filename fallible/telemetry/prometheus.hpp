@@ -0,0 +1,24 @@
+#pragma once
+
+#include <fallible/telemetry/counters.hpp>
+#include <fallible/result/result.hpp>
+
+#include <string>
+
+namespace fallible {
+
+//////////////////////////////////////////////////////////////////////
+
+// Prometheus text exposition format, one counter family:
+//
+//   fallible_errors_total{event="created",code="TimedOut",domain="Rpc",
+//                         site="rpc/client.cpp:42"} 17
+
+void WritePrometheus(const ErrorTelemetrySnapshot& snapshot, std::string& out);
+
+// Written to a temporary file and renamed, so scrapers
+// (e.g. node_exporter textfile collector) never see a partial file
+Status WritePrometheusFile(const ErrorTelemetrySnapshot& snapshot,
+                           const std::string& path);
+
+}  // namespace fallible
@@ -0,0 +1,438 @@
+#include <fallible/wire/batch.hpp>
+
+#include <fallible/wire/codec.hpp>
+#include <fallible/wire/varint.hpp>
+
+#include <fallible/context/data.hpp>
+
+#include <fallible/error/codes.hpp>
+#include <fallible/error/make.hpp>
+#include <fallible/result/make.hpp>
+#include <fallible/support/hash.hpp>
+
+#include <memory>
+
+namespace fallible {
+
+//////////////////////////////////////////////////////////////////////
+
+namespace {
+
+constexpr uint8_t kBatchVersion = 1;
+
+// Record tags
+constexpr uint8_t kStringRecord = 1;
+constexpr uint8_t kSiteRecord = 2;
+constexpr uint8_t kOkRecord = 3;
+constexpr uint8_t kErrorRecord = 4;
+
+// Per dictionary
+constexpr size_t kMaxDictionarySize = 1 << 16;
+
+constexpr size_t kMaxRecordSize = 16 << 20;
+
+// Decoding recursion limit for sub-errors and causes
+constexpr size_t kMaxDepth = 64;
+
+}  // namespace
+
+//////////////////////////////////////////////////////////////////////
+
+size_t BatchEncoder::StringHash::operator()(std::string_view str) const {
+  return detail::HashBytes(str);
+}
+
+BatchEncoder::BatchEncoder() {
+  out_.push_back(static_cast<char>(kBatchVersion));
+}
+
+void BatchEncoder::AppendOk() {
+  detail::PutVarint(out_, 1);
+  out_.push_back(static_cast<char>(kOkRecord));
+}
+
+void BatchEncoder::Append(const Error& error) {
+  record_.clear();
+  Encode(error);
+
+  // Dictionary definitions used by the error are already in out_
+  detail::PutVarint(out_, 1 + record_.size());
+  out_.push_back(static_cast<char>(kErrorRecord));
+  out_.append(record_);
+}
+
+std::string BatchEncoder::TakeBytes() {
+  return std::exchange(out_, {});
+}
+
+void BatchEncoder::Encode(const Error& error) {
+  using namespace detail;
+
+  ErrorCodec::Frame frame = ErrorCodec::View(error);
+  uint64_t flags = FrameFlags(frame);
+
+  PutVarint(record_, ZigZag(error.Code()));
+  PutVarint(record_, flags);
+
+  if (flags & kHasCause) {
+    Encode(*frame.cause);
+  }
+
+  if (flags & kHasSite) {
+    PutSite(*frame.site);
+  }
+  if (flags & kHasDomain) {
+    PutString(record_, frame.domain);
+  }
+  if (flags & kHasReason) {
+    if (frame.literal_reason) {
+      PutString(record_, frame.reason);
+    } else {
+      // Formatted: unlikely to repeat
+      PutVarint(record_, 0);
+      PutBytes(record_, frame.reason);
+    }
+  }
+  if (flags & kHasReasonTemplate) {
+    PutString(record_, frame.reason_template);
+  }
+  if (flags & kHasAttrs) {
+    PutVarint(record_, frame.attrs->size());
+    for (const auto& attr : *frame.attrs) {
+      PutString(record_, attr.key.Name());
+      PutAttrValue(record_, attr.value);
+    }
+  }
+  if (flags & kHasSubErrors) {
+    PutVarint(record_, frame.sub_errors.size());
+    for (const auto& sub_error : frame.sub_errors) {
+      Encode(sub_error);
+    }
+  }
+}
+
+void BatchEncoder::PutSite(const SiteInfo& site) {
+  if (auto it = sites_.find(site.id); it != sites_.end()) {
+    detail::PutVarint(record_, it->second + 1);
+    return;
+  }
+
+  // Remote origins are not registered: no stable key, strings still
+  // go through the string dictionary
+  if (site.id == 0 || sites_.size() == kMaxDictionarySize) {
+    detail::PutVarint(record_, 0);
+    PutLocation(record_, site);
+    return;
+  }
+
+  std::string definition;
+  definition.push_back(static_cast<char>(kSiteRecord));
+  PutLocation(definition, site);
+
+  detail::PutVarint(out_, definition.size());
+  out_.append(definition);
+
+  size_t index = sites_.size();
+  sites_.emplace(site.id, index);
+  detail::PutVarint(record_, index + 1);
+}
+
+void BatchEncoder::PutLocation(std::string& out, const SiteInfo& site) {
+  PutString(out, site.file);
+  PutString(out, site.function);
+  detail::PutVarint(out, static_cast<uint64_t>(site.line));
+}
+
+void BatchEncoder::PutString(std::string& out, std::string_view str) {
+  if (std::optional<size_t> index = StringIndex(str)) {
+    detail::PutVarint(out, *index + 1);
+  } else {
+    detail::PutVarint(out, 0);
+    detail::PutBytes(out, str);
+  }
+}
+
+std::optional<size_t> BatchEncoder::StringIndex(std::string_view str) {
+  if (auto it = strings_.find(str); it != strings_.end()) {
+    return it->second;
+  }
+
+  if (strings_.size() == kMaxDictionarySize) {
+    return std::nullopt;
+  }
+
+  size_t index = strings_.size();
+  strings_.emplace(std::string{str}, index);
+
+  detail::PutVarint(out_, 1 + detail::VarintSize(str.size()) + str.size());
+  out_.push_back(static_cast<char>(kStringRecord));
+  detail::PutBytes(out_, str);
+
+  return index;
+}
+
+//////////////////////////////////////////////////////////////////////
+
+namespace {
+
+// Body of a single record, strings share its copy
+class RecordReader {
+ public:
+  using Site = std::shared_ptr<const detail::RemoteSite>;
+
+  RecordReader(SharedString record,
+               const std::vector<SharedString>& strings,
+               const std::vector<Site>& sites)
+      : record_(std::move(record)),
+        reader_(record_.View()),
+        strings_(strings),
+        sites_(sites) {
+  }
+
+  bool Done() const {
+    return reader_.Ok() && reader_.AtEnd();
+  }
+
+  std::optional<SharedString> String() {
+    uint64_t ref = reader_.Varint();
+    if (!reader_.Ok()) {
+      return std::nullopt;
+    }
+    if (ref == 0) {
+      size_t size;
+      size_t offset = reader_.BytesOffset(size);
+      if (!reader_.Ok()) {
+        return std::nullopt;
+      }
+      return record_.Substr(offset, size);
+    }
+    if (ref - 1 >= strings_.size()) {
+      return std::nullopt;
+    }
+    return strings_[ref - 1];
+  }
+
+  // Shares the strings, see wire/codec.hpp
+  Site Location() {
+    std::optional<SharedString> file = String();
+    std::optional<SharedString> function = String();
+    auto line = static_cast<int>(reader_.Varint());
+    if (!file || !function || !reader_.Ok()) {
+      return nullptr;
+    }
+    return std::make_shared<const detail::RemoteSite>(std::move(*file),
+                                                      std::move(*function), line);
+  }
+
+  // nullptr if malformed
+  Site ReadSite() {
+    uint64_t ref = reader_.Varint();
+    if (!reader_.Ok()) {
+      return nullptr;
+    }
+    if (ref == 0) {
+      return Location();
+    }
+    if (ref - 1 >= sites_.size()) {
+      return nullptr;
+    }
+    return sites_[ref - 1];
+  }
+
+  std::optional<Error> ReadError(size_t depth) {
+    using namespace detail;
+
+    if (depth > kMaxDepth) {
+      return std::nullopt;
+    }
+
+    auto code = static_cast<int32_t>(UnZigZag(reader_.Varint()));
+    uint64_t flags = reader_.Varint();
+
+    std::optional<Error> cause;
+    if (flags & kHasCause) {
+      cause = ReadError(depth + 1);
+      if (!cause) {
+        return std::nullopt;
+      }
+    }
+
+    ContextData context;
+
+    if (flags & kHasSite) {
+      context.remote_site = ReadSite();
+      if (!context.remote_site) {
+        return std::nullopt;
+      }
+    }
+
+    if (flags & kHasDomain) {
+      std::optional<SharedString> domain = String();
+      if (!domain) {
+        return std::nullopt;
+      }
+      context.domain = std::move(*domain);
+      context.domain_id = DomainIdOf(context.domain.View());
+    }
+    std::optional<SharedString> reason = SharedString{};
+    if (flags & kHasReason) {
+      reason = String();
+      if (!reason) {
+        return std::nullopt;
+      }
+    }
+    if (flags & kHasReasonTemplate) {
+      std::optional<SharedString> templ = String();
+      if (!templ) {
+        return std::nullopt;
+      }
+      context.reason = LazyString::Rendered(std::move(*reason), std::move(*templ));
+    } else {
+      context.reason = std::move(*reason);
+    }
+
+    if (flags & kHasAttrs) {
+      uint64_t count = reader_.Varint();
+      for (uint64_t i = 0; i < count && reader_.Ok(); ++i) {
+        std::optional<SharedString> key = String();
+        if (!key) {
+          return std::nullopt;
+        }
+        std::optional<AttrValue> value = ReadAttrValue(reader_, record_);
+        if (!value) {
+          return std::nullopt;
+        }
+        context.attrs.Set(AttrKey::Shared(std::move(*key)), std::move(*value));
+      }
+    }
+
+    std::vector<Error> sub_errors;
+    if (flags & kHasSubErrors) {
+      uint64_t count = reader_.Varint();
+      for (uint64_t i = 0; i < count && reader_.Ok(); ++i) {
+        std::optional<Error> sub_error = ReadError(depth + 1);
+        if (!sub_error) {
+          return std::nullopt;
+        }
+        sub_errors.push_back(std::move(*sub_error));
+      }
+    }
+
+    if (!reader_.Ok()) {
+      return std::nullopt;
+    }
+    return ErrorCodec::Assemble(code, context, std::move(sub_errors), std::move(cause));
+  }
+
+ private:
+  SharedString record_;
+  detail::WireReader reader_;
+  const std::vector<SharedString>& strings_;
+  const std::vector<Site>& sites_;
+};
+
+}  // namespace
+
+//////////////////////////////////////////////////////////////////////
+
+void BatchDecoder::Feed(std::string_view bytes) {
+  // Drop consumed records before growing
+  if (pos_ > 0 && pos_ >= buffer_.size() / 2) {
+    buffer_.erase(0, pos_);
+    pos_ = 0;
+  }
+  buffer_.append(bytes);
+}
+
+Result<std::optional<Status>> BatchDecoder::Next() {
+  if (broken_) {
+    return Corrupted("Decoding failed before");
+  }
+
+  if (!started_) {
+    if (buffer_.empty()) {
+      return Ok(std::optional<Status>{});
+    }
+    if (static_cast<uint8_t>(buffer_[0]) != kBatchVersion) {
+      return Corrupted("Unsupported batch version");
+    }
+    pos_ = 1;
+    started_ = true;
+  }
+
+  while (pos_ < buffer_.size()) {
+    std::string_view rest = std::string_view{buffer_}.substr(pos_);
+
+    detail::WireReader header{rest};
+    uint64_t size = header.Varint();
+    if (!header.Ok()) {
+      if (rest.size() < 10) {
+        break;  // Partial size
+      }
+      return Corrupted("Malformed record size");
+    }
+    if (size == 0 || size > kMaxRecordSize) {
+      return Corrupted("Invalid record size");
+    }
+    if (rest.size() - header.Position() < size) {
+      break;  // Partial record
+    }
+
+    auto tag = static_cast<uint8_t>(rest[header.Position()]);
+    std::string_view body = rest.substr(header.Position() + 1, size - 1);
+    pos_ += header.Position() + size;
+
+    switch (tag) {
+      case kStringRecord: {
+        detail::WireReader reader{body};
+        std::string_view str = reader.Bytes();
+        if (!reader.Ok() || !reader.AtEnd() ||
+            strings_.size() == kMaxDictionarySize) {
+          return Corrupted("Malformed string record");
+        }
+        strings_.push_back(SharedString::Copy(str));
+        break;
+      }
+
+      case kSiteRecord: {
+        RecordReader reader{SharedString::Copy(body), strings_, sites_};
+        auto site = reader.Location();
+        if (!site || !reader.Done() || sites_.size() == kMaxDictionarySize) {
+          return Corrupted("Malformed site record");
+        }
+        sites_.push_back(std::move(site));
+        break;
+      }
+
+      case kOkRecord:
+        if (!body.empty()) {
+          return Corrupted("Malformed ok record");
+        }
+        return Ok(std::optional<Status>{Status::Ok({})});
+
+      case kErrorRecord: {
+        RecordReader reader{SharedString::Copy(body), strings_, sites_};
+        std::optional<Error> error = reader.ReadError(0);
+        if (!error || !reader.Done()) {
+          return Corrupted("Malformed error record");
+        }
+        return Ok(std::optional<Status>{Status::Fail(std::move(*error))});
+      }
+
+      default:
+        return Corrupted("Unknown record");
+    }
+  }
+
+  return Ok(std::optional<Status>{});
+}
+
+Result<std::optional<Status>> BatchDecoder::Corrupted(const char* reason) {
+  broken_ = true;
+  return Fail(Err(ErrorCodes::Invalid)
+                  .Domain("Wire")
+                  .Reason(std::string_view{reason})
+                  .Done());
+}
+
+}  // namespace fallible
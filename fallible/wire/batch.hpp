@@ -0,0 +1,130 @@
+#pragma once
+
+#include <fallible/error/error.hpp>
+#include <fallible/result/result.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace fallible {
+
+namespace detail {
+struct RemoteSite;
+}  // namespace detail
+
+//////////////////////////////////////////////////////////////////////
+
+// Streaming encoding of batches of errors and statuses
+//
+// Domains, literal reasons, reason templates, attribute keys and call
+// sites repeat across the errors of a batch: each is sent once per stream
+// as a dictionary entry and referred to by index afterwards. Formatted
+// reasons and attribute values are sent inline. See wire/codec.hpp for single errors.
+//
+// Dictionaries are bounded, overflowing entries are sent inline.
+//
+//   stream := version:u8 record*
+//   record := varint(size) tag:u8 body
+//     string := bytes           defines the next string index
+//     site   := location        defines the next site index
+//     ok     :=
+//     error  := varint(zigzag code) varint(flags) [cause:error]
+//               [site] [domain:str] [reason:str] [template:str]
+//               [attrs] [sub-errors]
+//   site     := varint(0) location | varint(index + 1)
+//   location := str(file) str(function) varint(line)
+//   str      := varint(0) bytes | varint(index + 1)
+//   attrs    := varint(count) (str(key) kind:u8 value)*
+
+class BatchEncoder {
+ public:
+  BatchEncoder();
+
+  void Append(const Error& error);
+  void AppendOk();
+
+  template <typename T>
+  void Append(const Result<T>& result) {
+    if (result.IsOk()) {
+      AppendOk();
+    } else {
+      Append(result.Error());
+    }
+  }
+
+  // Encoded bytes since the previous call, e.g. the next chunk to send
+  // Dictionary is kept: chunks must be decoded in order
+  std::string TakeBytes();
+
+ private:
+  void Encode(const Error& error);
+  void PutSite(const SiteInfo& site);
+  void PutLocation(std::string& out, const SiteInfo& site);
+  void PutString(std::string& out, std::string_view str);
+  std::optional<size_t> StringIndex(std::string_view str);
+
+ private:
+  struct StringHash {
+    using is_transparent = void;
+    size_t operator()(std::string_view str) const;
+  };
+
+  std::unordered_map<std::string, size_t, StringHash, std::equal_to<>> strings_;
+  std::unordered_map<SiteId, size_t> sites_;
+  // Dictionary definitions and complete records
+  std::string out_;
+  // Body of the current error record
+  std::string record_;
+};
+
+//////////////////////////////////////////////////////////////////////
+
+// Incremental: chunks of a stream are fed in order, each complete record
+// is decoded and released, the rest is kept until the next chunk arrives
+//
+// Usage:
+//   fallible::BatchDecoder decoder;
+//   while (Receive(chunk)) {
+//     decoder.Feed(chunk);
+//     while (true) {
+//       auto item = decoder.Next();  // Result<std::optional<Status>>
+//       if (item.Failed()) { ... }   // Malformed stream
+//       if (!*item) break;           // Needs more bytes
+//       Handle(std::move(**item));
+//     }
+//   }
+
+class BatchDecoder {
+ public:
+  void Feed(std::string_view bytes);
+
+  // Next item of the stream: Ok or the error,
+  // std::nullopt if more bytes are needed
+  // Fails on malformed streams, subsequent calls fail too
+  Result<std::optional<Status>> Next();
+
+  // No partially received record
+  bool Idle() const {
+    return pos_ == buffer_.size();
+  }
+
+ private:
+  Result<std::optional<Status>> Corrupted(const char* reason);
+
+ private:
+  std::string buffer_;
+  size_t pos_ = 0;
+  bool started_ = false;
+  bool broken_ = false;
+
+  // Dictionary
+  std::vector<SharedString> strings_;
+  std::vector<std::shared_ptr<const detail::RemoteSite>> sites_;
+};
+
+}  // namespace fallible
@@ -0,0 +1,297 @@
+#include <fallible/wire/codec.hpp>
+
+#include <fallible/wire/varint.hpp>
+
+#include <fallible/context/data.hpp>
+
+#include <fallible/error/codes.hpp>
+#include <fallible/error/make.hpp>
+#include <fallible/result/make.hpp>
+
+#include <bit>
+#include <memory>
+
+namespace fallible {
+
+//////////////////////////////////////////////////////////////////////
+
+namespace {
+
+constexpr uint8_t kWireVersion = 1;
+
+// Decoding recursion limit for sub-errors and causes
+constexpr size_t kMaxDepth = 64;
+
+//////////////////////////////////////////////////////////////////////
+
+class Decoder {
+ public:
+  explicit Decoder(SharedString buffer)
+      : buffer_(std::move(buffer)),
+        reader_(buffer_.View()) {
+  }
+
+  Result<Error> DecodeMessage() {
+    if (reader_.Byte() != kWireVersion) {
+      return Corrupted("Unsupported wire version");
+    }
+    std::optional<Error> error = DecodeError(0);
+    if (!error || !reader_.Ok()) {
+      return Corrupted("Malformed error");
+    }
+    if (!reader_.AtEnd()) {
+      return Corrupted("Trailing bytes");
+    }
+    return Ok(std::move(*error));
+  }
+
+ private:
+  std::optional<Error> DecodeError(size_t depth) {
+    if (depth > kMaxDepth) {
+      return std::nullopt;
+    }
+
+    auto code = static_cast<int32_t>(detail::UnZigZag(reader_.Varint()));
+    uint64_t flags = reader_.Varint();
+
+    std::optional<Error> cause;
+    if (flags & detail::kHasCause) {
+      cause = DecodeError(depth + 1);
+      if (!cause) {
+        return std::nullopt;
+      }
+    }
+
+    detail::ContextData context;
+
+    if (flags & detail::kHasSite) {
+      SharedString file = String();
+      SharedString function = String();
+      auto line = static_cast<int>(reader_.Varint());
+      if (!reader_.Ok()) {
+        return std::nullopt;
+      }
+      context.remote_site = std::make_shared<const detail::RemoteSite>(
+          std::move(file), std::move(function), line);
+    }
+
+    if (flags & detail::kHasDomain) {
+      context.domain = String();
+      context.domain_id = DomainIdOf(context.domain.View());
+    }
+    SharedString reason;
+    if (flags & detail::kHasReason) {
+      reason = String();
+    }
+    if (flags & detail::kHasReasonTemplate) {
+      context.reason = detail::LazyString::Rendered(std::move(reason), String());
+    } else {
+      context.reason = std::move(reason);
+    }
+
+    if (flags & detail::kHasAttrs) {
+      uint64_t count = reader_.Varint();
+      for (uint64_t i = 0; i < count && reader_.Ok(); ++i) {
+        SharedString key = String();
+        std::optional<AttrValue> value = detail::ReadAttrValue(reader_, buffer_);
+        if (!value) {
+          return std::nullopt;
+        }
+        context.attrs.Set(AttrKey::Shared(std::move(key)), std::move(*value));
+      }
+    }
+
+    std::vector<Error> sub_errors;
+    if (flags & detail::kHasSubErrors) {
+      uint64_t count = reader_.Varint();
+      for (uint64_t i = 0; i < count && reader_.Ok(); ++i) {
+        std::optional<Error> sub_error = DecodeError(depth + 1);
+        if (!sub_error) {
+          return std::nullopt;
+        }
+        sub_errors.push_back(std::move(*sub_error));
+      }
+    }
+
+    if (!reader_.Ok()) {
+      return std::nullopt;
+    }
+    return detail::ErrorCodec::Assemble(code, context, std::move(sub_errors),
+                                        std::move(cause));
+  }
+
+  // View into the buffer
+  SharedString String() {
+    size_t size;
+    size_t offset = reader_.BytesOffset(size);
+    return buffer_.Substr(offset, size);
+  }
+
+  static Result<Error> Corrupted(const char* reason) {
+    return Fail(Err(ErrorCodes::Invalid)
+                    .Domain("Wire")
+                    .Reason(std::string_view{reason})
+                    .Done());
+  }
+
+ private:
+  SharedString buffer_;
+  detail::WireReader reader_;
+};
+
+}  // namespace
+
+//////////////////////////////////////////////////////////////////////
+
+namespace detail {
+
+ErrorCodec::Frame ErrorCodec::View(const Error& error) {
+  std::string reason = error.FrameReason();
+  std::string_view reason_template = error.FrameReasonTemplate();
+  bool literal_reason = reason_template == reason;
+  return {
+      .site = error.FrameOrigin(),
+      .domain = error.FrameDomainView(),
+      .reason = std::move(reason),
+      .literal_reason = literal_reason,
+      .reason_template = literal_reason ? std::string_view{} : reason_template,
+      .attrs = &error.Attrs(),
+      .sub_errors = error.FrameSubErrors(),
+      .cause = error.Cause(),
+  };
+}
+
+Error ErrorCodec::Assemble(int32_t code, ContextData& context,
+                           std::vector<Error> sub_errors, std::optional<Error> cause) {
+  return Error::Assemble(code, context, std::move(sub_errors), std::move(cause));
+}
+
+void ErrorCodec::Encode(const Error& error, std::string& out) {
+  Frame frame = View(error);
+  uint64_t flags = FrameFlags(frame);
+
+  PutVarint(out, ZigZag(error.Code()));
+  PutVarint(out, flags);
+
+  // Cause goes first: decoder builds the frame on top of it
+  if (flags & kHasCause) {
+    Encode(*frame.cause, out);
+  }
+
+  if (flags & kHasSite) {
+    PutBytes(out, frame.site->file);
+    PutBytes(out, frame.site->function);
+    PutVarint(out, static_cast<uint64_t>(frame.site->line));
+  }
+  if (flags & kHasDomain) {
+    PutBytes(out, frame.domain);
+  }
+  if (flags & kHasReason) {
+    PutBytes(out, frame.reason);
+  }
+  if (flags & kHasReasonTemplate) {
+    PutBytes(out, frame.reason_template);
+  }
+  if (flags & kHasAttrs) {
+    PutVarint(out, frame.attrs->size());
+    for (const auto& attr : *frame.attrs) {
+      PutBytes(out, attr.key.Name());
+      PutAttrValue(out, attr.value);
+    }
+  }
+  if (flags & kHasSubErrors) {
+    PutVarint(out, frame.sub_errors.size());
+    for (const auto& sub_error : frame.sub_errors) {
+      Encode(sub_error, out);
+    }
+  }
+}
+
+uint64_t FrameFlags(const ErrorCodec::Frame& frame) {
+  uint64_t flags = 0;
+  flags |= frame.site != nullptr ? kHasSite : 0;
+  flags |= !frame.domain.empty() ? kHasDomain : 0;
+  flags |= !frame.reason.empty() ? kHasReason : 0;
+  flags |= !frame.literal_reason ? kHasReasonTemplate : 0;
+  flags |= !frame.attrs->empty() ? kHasAttrs : 0;
+  flags |= !frame.sub_errors.empty() ? kHasSubErrors : 0;
+  flags |= frame.cause != nullptr ? kHasCause : 0;
+  return flags;
+}
+
+void PutAttrValue(std::string& out, const AttrValue& value) {
+  out.push_back(static_cast<char>(value.Kind()));
+
+  switch (value.Kind()) {
+    case AttrKind::String:
+      PutBytes(out, *value.AsString());
+      break;
+    case AttrKind::Int:
+      PutVarint(out, ZigZag(*value.AsInt()));
+      break;
+    case AttrKind::UInt:
+      PutVarint(out, *value.AsUInt());
+      break;
+    case AttrKind::Double:
+      PutFixed64(out, std::bit_cast<uint64_t>(*value.AsDouble()));
+      break;
+    case AttrKind::Duration:
+      PutVarint(out, ZigZag(value.AsDuration()->count()));
+      break;
+    case AttrKind::Blob:
+      PutBytes(out, *value.AsBlob());
+      break;
+    case AttrKind::Bool:
+      out.push_back(*value.AsBool() ? 1 : 0);
+      break;
+  }
+}
+
+std::optional<AttrValue> ReadAttrValue(WireReader& reader, const SharedString& buffer) {
+  auto string = [&] {
+    size_t size;
+    size_t offset = reader.BytesOffset(size);
+    return buffer.Substr(offset, size);
+  };
+
+  switch (static_cast<AttrKind>(reader.Byte())) {
+    case AttrKind::String:
+      return AttrValue{string()};
+    case AttrKind::Int:
+      return AttrValue{UnZigZag(reader.Varint())};
+    case AttrKind::UInt:
+      return AttrValue{reader.Varint()};
+    case AttrKind::Double:
+      return AttrValue{std::bit_cast<double>(reader.Fixed64())};
+    case AttrKind::Duration:
+      return AttrValue{std::chrono::nanoseconds{UnZigZag(reader.Varint())}};
+    case AttrKind::Blob:
+      return AttrValue::SharedBlob(string());
+    case AttrKind::Bool:
+      return AttrValue{reader.Byte() != 0};
+  }
+  return std::nullopt;
+}
+
+}  // namespace detail
+
+void EncodeError(const Error& error, std::string& out) {
+  out.push_back(static_cast<char>(kWireVersion));
+  detail::ErrorCodec::Encode(error, out);
+}
+
+std::string EncodeError(const Error& error) {
+  std::string out;
+  EncodeError(error, out);
+  return out;
+}
+
+Result<Error> DecodeError(SharedString buffer) {
+  return Decoder{std::move(buffer)}.DecodeMessage();
+}
+
+Result<Error> DecodeError(std::string_view bytes) {
+  return DecodeError(SharedString::Copy(bytes));
+}
+
+}  // namespace fallible
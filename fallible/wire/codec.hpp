@@ -0,0 +1,107 @@
+#pragma once
+
+#include <fallible/error/error.hpp>
+#include <fallible/result/result.hpp>
+
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace fallible {
+
+//////////////////////////////////////////////////////////////////////
+
+// Compact binary wire format of Error
+//
+// Covers the code, call site, domain, rendered reason and its template
+// and typed attributes of each frame, sub-errors and wrapped causes.
+// Payloads (see Error::Payload) and stack traces stay local.
+//
+//   message := version:u8 error
+//   error   := varint(zigzag code) varint(flags)
+//              [cause:error] [site] [domain] [reason] [template]
+//              [attrs] [sub-errors]
+//   site    := bytes(file) bytes(function) varint(line)
+//   reason  := bytes(rendered)
+//   template := bytes(format string), if it differs from the reason
+//   attrs   := varint(count) (bytes(key) kind:u8 value)*
+//   bytes   := varint(size) byte*
+//
+// Decoded errors view into the received buffer: domains, reasons,
+// string attributes, attribute names and call sites share it without
+// copying and keep it alive. Remote call sites are not registered:
+// Error::Site() is 0, see Error::SourceLocation().
+//
+// Reasons travel rendered, together with the format string of formatted
+// ones: decoded errors compare equal to the originals, see Error::Fingerprint.
+
+// Appends to `out`
+void EncodeError(const Error& error, std::string& out);
+
+std::string EncodeError(const Error& error);
+
+// Zero-copy, `buffer` is shared by the decoded error
+// Usage:
+//   auto buffer = SharedString::Allocate(size);
+//   Receive(buffer.MutableData(), size);
+//   auto error = DecodeError(std::move(buffer));
+Result<Error> DecodeError(SharedString buffer);
+
+// Copies `bytes` once
+Result<Error> DecodeError(std::string_view bytes);
+
+//////////////////////////////////////////////////////////////////////
+
+namespace detail {
+
+class WireReader;
+
+// Reads fields of Error frames without walking the chain
+struct ErrorCodec {
+  // Fields of a single frame
+  struct Frame {
+    // Registered site or remote origin, nullptr if unknown
+    const SiteInfo* site;
+    std::string_view domain;
+    std::string reason;
+    // Not formatted: shared by all errors of the call site
+    bool literal_reason;
+    // Format string of a formatted reason
+    std::string_view reason_template;
+    const fallible::Attrs* attrs;
+    std::span<const Error> sub_errors;
+    const Error* cause;
+  };
+
+  static Frame View(const Error& error);
+
+  static void Encode(const Error& error, std::string& out);
+
+  // Decoded errors are not failures of this process: built as is,
+  // without stacks, return traces, telemetry or flight records
+  static Error Assemble(int32_t code, ContextData& context,
+                        std::vector<Error> sub_errors, std::optional<Error> cause);
+};
+
+// Frame flags
+inline constexpr uint64_t kHasSite = 1;
+inline constexpr uint64_t kHasDomain = 2;
+inline constexpr uint64_t kHasReason = 4;
+inline constexpr uint64_t kHasAttrs = 8;
+inline constexpr uint64_t kHasSubErrors = 16;
+inline constexpr uint64_t kHasCause = 32;
+inline constexpr uint64_t kHasReasonTemplate = 64;
+
+uint64_t FrameFlags(const ErrorCodec::Frame& frame);
+
+// kind:u8 value
+void PutAttrValue(std::string& out, const AttrValue& value);
+
+// Strings share `buffer`, the bytes of `reader`
+std::optional<AttrValue> ReadAttrValue(WireReader& reader, const SharedString& buffer);
+
+}  // namespace detail
+
+}  // namespace fallible
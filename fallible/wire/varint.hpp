@@ -0,0 +1,140 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+namespace fallible::detail {
+
+//////////////////////////////////////////////////////////////////////
+
+// Protobuf-compatible base-128 varints, little-endian fixed-width values
+
+inline uint64_t ZigZag(int64_t value) {
+  return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+inline int64_t UnZigZag(uint64_t value) {
+  return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+inline size_t VarintSize(uint64_t value) {
+  size_t size = 1;
+  while (value >= 0x80) {
+    value >>= 7;
+    ++size;
+  }
+  return size;
+}
+
+inline void PutVarint(std::string& out, uint64_t value) {
+  char bytes[10];
+  size_t size = 0;
+  while (value >= 0x80) {
+    bytes[size++] = static_cast<char>(value | 0x80);
+    value >>= 7;
+  }
+  bytes[size++] = static_cast<char>(value);
+  out.append(bytes, size);
+}
+
+inline void PutFixed64(std::string& out, uint64_t value) {
+  char bytes[8];
+  std::memcpy(bytes, &value, 8);
+  out.append(bytes, 8);
+}
+
+inline void PutBytes(std::string& out, std::string_view bytes) {
+  PutVarint(out, bytes.size());
+  out.append(bytes);
+}
+
+//////////////////////////////////////////////////////////////////////
+
+// Bounds-checked reader, sticky failure: once a read fails
+// all subsequent reads fail too
+
+class WireReader {
+ public:
+  explicit WireReader(std::string_view bytes)
+      : bytes_(bytes) {
+  }
+
+  bool Ok() const {
+    return ok_;
+  }
+
+  size_t Position() const {
+    return pos_;
+  }
+
+  bool AtEnd() const {
+    return pos_ == bytes_.size();
+  }
+
+  uint64_t Varint() {
+    uint64_t value = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7) {
+      if (pos_ == bytes_.size()) {
+        return Fail();
+      }
+      auto byte = static_cast<uint8_t>(bytes_[pos_++]);
+      value |= uint64_t{byte & 0x7Fu} << shift;
+      if ((byte & 0x80) == 0) {
+        return value;
+      }
+    }
+    return Fail();  // Overlong
+  }
+
+  uint64_t Fixed64() {
+    if (bytes_.size() - pos_ < 8) {
+      return Fail();
+    }
+    uint64_t value;
+    std::memcpy(&value, bytes_.data() + pos_, 8);
+    pos_ += 8;
+    return value;
+  }
+
+  uint8_t Byte() {
+    if (pos_ == bytes_.size()) {
+      return Fail();
+    }
+    return static_cast<uint8_t>(bytes_[pos_++]);
+  }
+
+  // Length-prefixed, returns offset of the bytes, see Bytes()
+  size_t BytesOffset(size_t& size) {
+    size = Varint();
+    if (!ok_ || bytes_.size() - pos_ < size) {
+      size = 0;
+      return Fail();
+    }
+    size_t offset = pos_;
+    pos_ += size;
+    return offset;
+  }
+
+  std::string_view Bytes() {
+    size_t size;
+    size_t offset = BytesOffset(size);
+    return bytes_.substr(ok_ ? offset : 0, size);
+  }
+
+ private:
+  uint64_t Fail() {
+    ok_ = false;
+    pos_ = bytes_.size();
+    return 0;
+  }
+
+ private:
+  std::string_view bytes_;
+  size_t pos_ = 0;
+  bool ok_ = true;
+};
+
+}  // namespace fallible::detail
@@ -0,0 +1,74 @@
+#include "allocs.hpp"
+
+#include <cstdlib>
+#include <new>
+
+// Counting replacements of global allocation functions
+// All non-aligned forms are replaced: sanitizers report memory freed
+// by a replaced operator delete but allocated by the original new
+
+static thread_local size_t allocation_count = 0;
+static thread_local bool fail_allocations = false;
+
+size_t AllocationCount() {
+  return allocation_count;
+}
+
+AllocationFailures::AllocationFailures() {
+  fail_allocations = true;
+}
+
+AllocationFailures::~AllocationFailures() {
+  fail_allocations = false;
+}
+
+static void* Allocate(size_t size) noexcept {
+  if (fail_allocations) {
+    return nullptr;
+  }
+  ++allocation_count;
+  return std::malloc(size == 0 ? 1 : size);
+}
+
+void* operator new(size_t size) {
+  if (void* ptr = Allocate(size)) {
+    return ptr;
+  }
+  throw std::bad_alloc{};
+}
+
+void* operator new[](size_t size) {
+  return ::operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+  return Allocate(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+  return Allocate(size);
+}
+
+void operator delete(void* ptr) noexcept {
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t /*size*/) noexcept {
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept {
+  std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+  std::free(ptr);
+}
+
+void operator delete[](void* ptr, size_t /*size*/) noexcept {
+  std::free(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept {
+  std::free(ptr);
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+
+// Heap allocations made by the current thread, see allocs.cpp
+
+size_t AllocationCount();
+
+// Usage:
+// AllocationCounter allocs;
+// ...
+// ASSERT_EQ(allocs.Count(), 0);
+
+class AllocationCounter {
+ public:
+  AllocationCounter()
+      : start_(AllocationCount()) {
+  }
+
+  size_t Count() const {
+    return AllocationCount() - start_;
+  }
+
+ private:
+  size_t start_;
+};
+
+// Makes heap allocations of the current thread throw std::bad_alloc
+// until the end of the scope
+
+class AllocationFailures {
+ public:
+  AllocationFailures();
+  ~AllocationFailures();
+};
@@ -0,0 +1,95 @@
+#include <fallible/error/error.hpp>
+#include <fallible/error/make.hpp>
+#include <fallible/support/arena.hpp>
+
+#include <wheels/test/test_framework.hpp>
+
+#include "allocs.hpp"
+
+#include <string>
+
+using fallible::Error;
+using fallible::ErrorCodes;
+using fallible::Err;
+using fallible::ErrorArenaScope;
+
+////////////////////////////////////////////////////////////////////////////////
+
+static Error MakeError(const std::string& peer) {
+  return Err(ErrorCodes::Unavailable)
+      .Domain(peer)
+      .Reason(std::string_view{peer})
+      .Attr("peer", peer)
+      .AddSubError(Err(ErrorCodes::TimedOut).Reason(peer).Done())
+      .Done();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+TEST_SUITE(Arena) {
+  SIMPLE_TEST(NoGlobalAllocations) {
+    std::string peer = "a-rather-long-peer-name.cluster.local";
+
+    // Warm up interned sites
+    MakeError(peer);
+
+    ErrorArenaScope arena;
+    MakeError(peer);  // First arena chunk
+
+    AllocationCounter allocs;
+    for (size_t i = 0; i < 8; ++i) {
+      Error error = MakeError(peer);
+      ASSERT_EQ(error.Code(), ErrorCodes::Unavailable);
+    }
+    // Only the sub-error vector of the builder
+    ASSERT_EQ(allocs.Count(), 8);
+  }
+
+  SIMPLE_TEST(Escape) {
+    std::string peer = "escaped.cluster.local";
+
+    Error escaped = fallible::errors::Ok();
+    {
+      ErrorArenaScope arena;
+      escaped = MakeError(peer);
+    }
+
+    // Arena is kept alive by the error
+    ASSERT_EQ(escaped.Domain(), peer);
+    ASSERT_EQ(escaped.SubError().Reason(), peer);
+    ASSERT_TRUE(escaped.Attrs().Find("peer")->AsString() == peer);
+  }
+
+  SIMPLE_TEST(Detach) {
+    std::string peer = "detached.cluster.local";
+
+    Error detached = fallible::errors::Ok();
+    {
+      ErrorArenaScope arena;
+      Error error = MakeError(peer);
+      error.SetPayload(42);
+
+      detached = error.Detach();
+    }
+
+    ASSERT_EQ(detached.Code(), ErrorCodes::Unavailable);
+    ASSERT_EQ(detached.Domain(), peer);
+    ASSERT_EQ(detached.Reason(), peer);
+    ASSERT_EQ(detached.SubError().Reason(), peer);
+    ASSERT_TRUE(detached.Attrs().Find("peer")->AsString() == peer);
+    ASSERT_EQ(*detached.Payload<int>(), 42);
+  }
+
+  SIMPLE_TEST(Nested) {
+    ErrorArenaScope outer;
+    ASSERT_TRUE(fallible::detail::CurrentArena() != nullptr);
+    auto* outer_arena = fallible::detail::CurrentArena();
+
+    {
+      ErrorArenaScope inner;
+      ASSERT_TRUE(fallible::detail::CurrentArena() != outer_arena);
+    }
+
+    ASSERT_TRUE(fallible::detail::CurrentArena() == outer_arena);
+  }
+}
@@ -0,0 +1,138 @@
+#include <wheels/test/test_framework.hpp>
+
+#include <fallible/context/data.hpp>
+#include <fallible/context/make.hpp>
+
+#include "allocs.hpp"
+
+#include <chrono>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+TEST_SUITE(Attrs) {
+  SIMPLE_TEST(SortedAttrs) {
+    std::string dynamic = "host";
+
+    auto ctx = fallible::Ctx()
+                   .Attr("shard", "17")
+                   .Attr(dynamic, "db-3")
+                   .Attr("attempt", "2")  // Spills to the heap
+                   .Attr("zone", "eu")
+                   .Attr("replica", "1")
+                   .Attr("shard", "18")   // Overwrites
+                   .Done();
+
+    std::vector<std::string_view> names;
+    for (const auto& attr : ctx.Attrs()) {
+      names.push_back(attr.key.Name());
+    }
+
+    std::vector<std::string_view> expected{"attempt", "host", "replica", "shard", "zone"};
+    ASSERT_TRUE(names == expected);
+
+    ASSERT_TRUE(ctx.Attrs().Find("shard")->AsString() == "18");
+    ASSERT_TRUE(ctx.Attrs().Find(std::string_view{"host"})->AsString() == "db-3");
+    ASSERT_TRUE(ctx.Attrs().Find("missing") == nullptr);
+  }
+
+  SIMPLE_TEST(InternedKeys) {
+    std::string name = "key";
+    ASSERT_TRUE(fallible::AttrKey::Intern("key") == fallible::AttrKey::Intern(name));
+    ASSERT_FALSE(fallible::AttrKey::Intern("key") == fallible::AttrKey::Intern("other"));
+  }
+
+  SIMPLE_TEST(DynamicKeys) {
+    std::string name = "dynamic";
+
+    auto key = fallible::AttrKey::Intern(name);
+    name = "changed";
+    ASSERT_EQ(key.Name(), "dynamic");
+
+    // Literal is borrowed as is
+    static constexpr char kLiteral[] = "literal";
+    ASSERT_EQ(fallible::AttrKey::Intern(kLiteral).Name().data(), kLiteral);
+
+    // Owned copy per key, no global table
+    AllocationCounter allocs;
+    for (size_t i = 0; i < 3; ++i) {
+      auto copy = fallible::AttrKey::Intern(key.Name());
+      ASSERT_TRUE(copy == key);
+    }
+    ASSERT_EQ(allocs.Count(), 3);
+  }
+
+  SIMPLE_TEST(AttrAllocations) {
+    // Literal attribute names are borrowed
+    for (size_t i = 0; i < 2; ++i) {
+      AllocationCounter allocs;
+      auto ctx = fallible::Ctx()
+                     .Attr("shard", "17")
+                     .Attr("host", "db-3")
+                     .Done();
+      if (i > 0) {
+        // Single allocation for the context itself, attrs are inline
+        ASSERT_EQ(allocs.Count(), 1);
+      }
+    }
+  }
+
+  SIMPLE_TEST(Footprint) {
+    // Every context carries the inline slots
+    static_assert(sizeof(fallible::Attr) <= 56);
+    static_assert(sizeof(fallible::Attrs) <= 128);
+    static_assert(sizeof(fallible::detail::ContextData) <= 296);
+  }
+
+  SIMPLE_TEST(TypedAttrs) {
+    using namespace std::chrono_literals;
+
+    const char bytes[] = {0x0a, 0x1b};
+
+    auto ctx = fallible::Ctx()
+                   .Attr("shard", 17)
+                   .Attr("size", size_t{1} << 40)
+                   .Attr("ratio", 0.5)
+                   .Attr("retry_after", 150ms)
+                   .Attr("token", fallible::Blob::Of(bytes, sizeof(bytes)))
+                   .Attr("peer", "db-3")
+                   .Done();
+
+    const auto& attrs = ctx.Attrs();
+
+    ASSERT_TRUE(attrs.Find("shard")->AsInt() == 17);
+    ASSERT_TRUE(attrs.Find("shard")->AsString() == std::nullopt);
+    ASSERT_TRUE(attrs.Find("size")->AsUInt() == uint64_t{1} << 40);
+    ASSERT_TRUE(attrs.Find("size")->AsInt() == int64_t{1} << 40);
+    ASSERT_TRUE(attrs.Find("ratio")->AsDouble() == 0.5);
+    ASSERT_TRUE(attrs.Find("retry_after")->AsDuration() == 150ms);
+    ASSERT_TRUE(attrs.Find("token")->AsBlob() == std::string_view(bytes, 2));
+    ASSERT_TRUE(attrs.Find("peer")->Kind() == fallible::AttrKind::String);
+
+    // Formatted on demand
+    ASSERT_EQ(attrs.Find("shard")->Format(), "17");
+    ASSERT_EQ(attrs.Find("ratio")->Format(), "0.5");
+    ASSERT_EQ(attrs.Find("retry_after")->Format(), "150ms");
+    ASSERT_EQ(attrs.Find("token")->Format(), "0x0a1b");
+  }
+
+  SIMPLE_TEST(BoolAttrs) {
+    auto ctx = fallible::Ctx()
+                   .Attr("retry", true)
+                   .Attr("cached", false)
+                   .Done();
+
+    const auto& attrs = ctx.Attrs();
+    ASSERT_TRUE(attrs.Find("retry")->Kind() == fallible::AttrKind::Bool);
+    ASSERT_TRUE(attrs.Find("retry")->AsBool() == true);
+    ASSERT_TRUE(attrs.Find("retry")->AsInt() == std::nullopt);
+    ASSERT_EQ(attrs.Find("retry")->Format(), "true");
+    ASSERT_EQ(attrs.Find("cached")->Format(), "false");
+
+    // Characters are not numbers
+    static_assert(!std::is_convertible_v<char, fallible::AttrValue>);
+    static_assert(!std::is_convertible_v<char32_t, fallible::AttrValue>);
+    static_assert(!std::is_convertible_v<const int*, fallible::AttrValue>);
+    static_assert(std::is_convertible_v<int8_t, fallible::AttrValue>);
+  }
+}
@@ -0,0 +1,175 @@
+#include <fallible/wire/batch.hpp>
+#include <fallible/wire/codec.hpp>
+#include <fallible/result/make.hpp>
+
+#include <wheels/test/test_framework.hpp>
+
+#include <string>
+#include <vector>
+
+using fallible::Error;
+using fallible::ErrorCodes;
+using fallible::Status;
+
+////////////////////////////////////////////////////////////////////////////////
+
+static Error LookupError(int key) {
+  return fallible::Err(ErrorCodes::NotFound)
+      .Domain("Storage")
+      .Reason("Key not found")
+      .Attr("key", key)
+      .Attr("table", "users")
+      .Done();
+}
+
+// Decodes all complete items
+static std::vector<Status> Drain(fallible::BatchDecoder& decoder) {
+  std::vector<Status> items;
+  while (true) {
+    auto item = decoder.Next();
+    ASSERT_TRUE(item.IsOk());
+    if (!*item) {
+      break;
+    }
+    items.push_back(std::move(**item));
+  }
+  return items;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+TEST_SUITE(Batch) {
+  SIMPLE_TEST(Roundtrip) {
+    fallible::BatchEncoder encoder;
+
+    Error cause = fallible::Err(ErrorCodes::Unavailable).Domain("Rpc").Done();
+    Error wrapped = fallible::Wrap(cause).Reason("Replica {} down", 3).Done();
+
+    encoder.Append(LookupError(1));
+    encoder.AppendOk();
+    encoder.Append(wrapped);
+    encoder.Append(fallible::Result<int>{fallible::Ok(7)});
+    encoder.Append(LookupError(2));
+
+    std::string bytes = encoder.TakeBytes();
+
+    fallible::BatchDecoder decoder;
+    decoder.Feed(bytes);
+    auto items = Drain(decoder);
+
+    ASSERT_EQ(items.size(), 5);
+    ASSERT_TRUE(decoder.Idle());
+
+    ASSERT_TRUE(items[0].Failed());
+    ASSERT_EQ(items[0].Error(), LookupError(1));
+    ASSERT_EQ(*items[0].Error().Attrs().Find("key")->AsInt(), 1);
+    ASSERT_TRUE(items[1].IsOk());
+    ASSERT_EQ(items[2].Error().Reason(), "Replica 3 down");
+    ASSERT_EQ(items[2].Error(), wrapped);
+    ASSERT_EQ(items[2].Error().Cause()->Domain(), "Rpc");
+    ASSERT_TRUE(items[3].IsOk());
+    ASSERT_EQ(*items[4].Error().Attrs().Find("key")->AsInt(), 2);
+    ASSERT_EQ(items[4].Error().Reason(), "Key not found");
+  }
+
+  SIMPLE_TEST(Forward) {
+    fallible::BatchEncoder encoder;
+    encoder.Append(LookupError(1));
+
+    fallible::BatchDecoder decoder;
+    decoder.Feed(encoder.TakeBytes());
+    auto received = Drain(decoder);
+    ASSERT_EQ(received.size(), 1);
+
+    // Decoded errors carry remote sites, e.g. a proxy
+    fallible::BatchEncoder proxy;
+    proxy.Append(received[0].Error());
+    proxy.Append(received[0].Error());
+
+    fallible::BatchDecoder downstream;
+    downstream.Feed(proxy.TakeBytes());
+    auto items = Drain(downstream);
+
+    ASSERT_EQ(items.size(), 2);
+    ASSERT_EQ(items[0].Error(), LookupError(1));
+    ASSERT_EQ(items[1].Error().SourceLocation().Line(),
+              LookupError(1).SourceLocation().Line());
+    ASSERT_EQ(items[1].Error().Attrs().begin()->key.Name(), "key");
+  }
+
+  SIMPLE_TEST(Incremental) {
+    fallible::BatchEncoder encoder;
+    for (int i = 0; i < 10; ++i) {
+      encoder.Append(LookupError(i));
+    }
+    std::string bytes = encoder.TakeBytes();
+
+    // Byte by byte
+    fallible::BatchDecoder decoder;
+    std::vector<Status> items;
+    for (char byte : bytes) {
+      decoder.Feed({&byte, 1});
+      for (auto& item : Drain(decoder)) {
+        items.push_back(std::move(item));
+      }
+    }
+
+    ASSERT_EQ(items.size(), 10);
+    for (int i = 0; i < 10; ++i) {
+      ASSERT_EQ(*items[i].Error().Attrs().Find("key")->AsInt(), i);
+    }
+    ASSERT_TRUE(decoder.Idle());
+  }
+
+  SIMPLE_TEST(Chunks) {
+    fallible::BatchEncoder encoder;
+    fallible::BatchDecoder decoder;
+
+    // Dictionary spans chunks
+    encoder.Append(LookupError(1));
+    decoder.Feed(encoder.TakeBytes());
+    ASSERT_EQ(Drain(decoder).size(), 1);
+
+    encoder.Append(LookupError(2));
+    decoder.Feed(encoder.TakeBytes());
+    auto items = Drain(decoder);
+    ASSERT_EQ(items.size(), 1);
+    ASSERT_EQ(items[0].Error().Domain(), "Storage");
+  }
+
+  SIMPLE_TEST(Dictionary) {
+    static const size_t kErrors = 1000;
+
+    fallible::BatchEncoder encoder;
+    size_t single = 0;
+    for (size_t i = 0; i < kErrors; ++i) {
+      Error error = LookupError(static_cast<int>(i));
+      single += fallible::EncodeError(error).size();
+      encoder.Append(error);
+    }
+
+    size_t batch = encoder.TakeBytes().size();
+    ASSERT_TRUE(batch * 4 < single);
+  }
+
+  SIMPLE_TEST(Corrupted) {
+    fallible::BatchDecoder decoder;
+    decoder.Feed("\x01\x01\x7f");  // Unknown tag
+
+    auto item = decoder.Next();
+    ASSERT_TRUE(item.Failed());
+    ASSERT_EQ(item.Error().Code(), ErrorCodes::Invalid);
+
+    // Sticky
+    ASSERT_TRUE(decoder.Next().Failed());
+
+    fallible::BatchDecoder version;
+    version.Feed("\x09");
+    ASSERT_TRUE(version.Next().Failed());
+
+    // Reference to an undefined string
+    fallible::BatchDecoder dangling;
+    dangling.Feed("\x01\x04\x04\x0a\x04\x07");
+    ASSERT_TRUE(dangling.Next().Failed());
+  }
+}
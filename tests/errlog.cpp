@@ -0,0 +1,230 @@
+#include <fallible/log/file.hpp>
+#include <fallible/log/index.hpp>
+#include <fallible/result/make.hpp>
+
+#include <wheels/test/test_framework.hpp>
+
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using fallible::Error;
+using fallible::ErrorCodes;
+using fallible::ErrorLogQuery;
+
+////////////////////////////////////////////////////////////////////////////////
+
+static const uint64_t kHourNs = 3600ull * 1'000'000'000;
+
+static Error RpcTimeout(int shard) {
+  return fallible::Err(ErrorCodes::TimedOut)
+      .Domain("Rpc")
+      .Reason("Deadline exceeded")
+      .Attr("shard", shard)
+      .Done();
+}
+
+static Error StorageMiss() {
+  return fallible::Err(ErrorCodes::NotFound).Domain("Storage").Done();
+}
+
+// Removes the log and its index
+struct TempLog {
+  std::string path = "/tmp/fallible-errlog-" + std::to_string(::getpid());
+
+  ~TempLog() {
+    ::unlink(path.c_str());
+    ::unlink(fallible::ErrorLogIndexPath(path).c_str());
+  }
+};
+
+// Hour h: timeouts for shards 0..3, one storage miss
+static void WriteHours(const std::string& path, uint64_t first, uint64_t last) {
+  auto sink = fallible::ErrorLogSink::Open(path).ExpectValue();
+  for (uint64_t hour = first; hour < last; ++hour) {
+    for (int shard = 0; shard < 4; ++shard) {
+      sink->Write(RpcTimeout(shard), hour * kHourNs + shard).ExpectOk();
+    }
+    sink->Write(StorageMiss(), hour * kHourNs + 10).ExpectOk();
+  }
+}
+
+static size_t Count(const std::string& path, const ErrorLogQuery& query) {
+  return fallible::QueryErrorLog(path, query).ExpectValue().size();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+TEST_SUITE(ErrorLog) {
+  SIMPLE_TEST(Records) {
+    TempLog log;
+    WriteHours(log.path, 1, 2);
+
+    auto file = fallible::ErrorLogFile::Open(log.path).ExpectValue();
+    auto record = file.RecordAt(fallible::ErrorLogFile::Begin());
+    ASSERT_TRUE(record.has_value());
+    ASSERT_EQ(record->time_ns, kHourNs);
+
+    auto error = record->Decode().ExpectValue();
+    ASSERT_EQ(error.Code(), ErrorCodes::TimedOut);
+    ASSERT_EQ(error.Domain(), "Rpc");
+
+    size_t records = 0;
+    uint64_t offset = fallible::ErrorLogFile::Begin();
+    while (auto next = file.RecordAt(offset)) {
+      offset = fallible::ErrorLogFile::Next(*next);
+      ++records;
+    }
+    ASSERT_EQ(records, 5);
+  }
+
+  SIMPLE_TEST(FailedFlush) {
+    TempLog log;
+    auto sink = fallible::ErrorLogSink::Open(log.path).ExpectValue();
+    sink->Write(RpcTimeout(0), kHourNs).ExpectOk();
+    sink->Flush().ExpectOk();
+
+    struct stat before;
+    ASSERT_EQ(::stat(log.path.c_str(), &before), 0);
+
+    // Room for a part of the next batch only
+    struct rlimit limit;
+    ASSERT_EQ(::getrlimit(RLIMIT_FSIZE, &limit), 0);
+    struct rlimit small = limit;
+    small.rlim_cur = before.st_size + 16;
+    auto handler = std::signal(SIGXFSZ, SIG_IGN);
+    ASSERT_EQ(::setrlimit(RLIMIT_FSIZE, &small), 0);
+
+    for (int shard = 1; shard < 4; ++shard) {
+      sink->Write(RpcTimeout(shard), kHourNs + shard).ExpectOk();
+    }
+    auto status = sink->Flush();
+
+    ::setrlimit(RLIMIT_FSIZE, &limit);
+    std::signal(SIGXFSZ, handler);
+
+    ASSERT_TRUE(status.Failed());
+
+    // Torn batch is cut off
+    struct stat after;
+    ASSERT_EQ(::stat(log.path.c_str(), &after), 0);
+    ASSERT_EQ(after.st_size, before.st_size);
+
+    // Appends resume after the last complete record
+    sink->Write(StorageMiss(), kHourNs + 10).ExpectOk();
+    sink->Flush().ExpectOk();
+
+    auto file = fallible::ErrorLogFile::Open(log.path).ExpectValue();
+    std::vector<int32_t> codes;
+    uint64_t offset = fallible::ErrorLogFile::Begin();
+    while (auto record = file.RecordAt(offset)) {
+      codes.push_back(record->Decode().ExpectValue().Code());
+      offset = fallible::ErrorLogFile::Next(*record);
+    }
+    ASSERT_EQ(offset, file.End());
+    ASSERT_TRUE(codes == std::vector<int32_t>({ErrorCodes::TimedOut, ErrorCodes::NotFound}));
+  }
+
+  SIMPLE_TEST(NotALog) {
+    TempLog log;
+    ASSERT_TRUE(fallible::ErrorLogFile::Open(log.path).Failed());
+
+    FILE* file = std::fopen(log.path.c_str(), "w");
+    std::fputs("not a log", file);
+    std::fclose(file);
+
+    ASSERT_TRUE(fallible::ErrorLogFile::Open(log.path).Failed());
+    ASSERT_TRUE(fallible::BuildErrorLogIndex(log.path).Failed());
+  }
+
+  SIMPLE_TEST(Query) {
+    TempLog log;
+    WriteHours(log.path, 0, 24);
+
+    ErrorLogQuery query;
+    query.code = ErrorCodes::TimedOut;
+    query.domain = "Rpc";
+    query.attrs.push_back("shard=2");
+    query.since_ns = 20 * kHourNs;
+
+    // Full scan
+    ASSERT_EQ(Count(log.path, query), 4);
+
+    fallible::BuildErrorLogIndex(log.path).ExpectOk();
+    auto matches = fallible::QueryErrorLog(log.path, query).ExpectValue();
+    ASSERT_EQ(matches.size(), 4);
+    ASSERT_EQ(matches[0].time_ns, 20 * kHourNs + 2);
+    ASSERT_EQ(*matches[0].error.FindAttr("shard")->AsInt(), 2);
+
+    // Appended after indexing
+    WriteHours(log.path, 24, 25);
+    ASSERT_EQ(Count(log.path, query), 5);
+
+    ErrorLogQuery storage;
+    storage.domain = "Storage";
+    storage.until_ns = 2 * kHourNs;
+    ASSERT_EQ(Count(log.path, storage), 2);
+
+    ErrorLogQuery site;
+    site.site = "errlog.cpp:" + std::to_string(StorageMiss().SourceLocation().Line());
+    ASSERT_EQ(Count(log.path, site), 25);
+
+    // Base names match exactly, the same with and without the index
+    ErrorLogQuery suffix;
+    suffix.site = "log.cpp:" + std::to_string(StorageMiss().SourceLocation().Line());
+    ASSERT_EQ(Count(log.path, suffix), 0);
+
+    ErrorLogQuery key;
+    key.attrs.push_back("shard");
+    key.limit = 10;
+    ASSERT_EQ(Count(log.path, key), 10);
+
+    ErrorLogQuery none;
+    none.code = ErrorCodes::Internal;
+    ASSERT_EQ(Count(log.path, none), 0);
+  }
+
+  SIMPLE_TEST(StaleIndex) {
+    TempLog log;
+    WriteHours(log.path, 0, 2);
+    fallible::BuildErrorLogIndex(log.path).ExpectOk();
+
+    // Rotated: a new, larger log under the same path, same record layout
+    ::unlink(log.path.c_str());
+    WriteHours(log.path, 10, 15);
+
+    ErrorLogQuery query;
+    query.domain = "Storage";
+    query.since_ns = 10 * kHourNs;
+    ASSERT_EQ(Count(log.path, query), 5);
+
+    ErrorLogQuery all;
+    ASSERT_EQ(Count(log.path, all), 25);
+  }
+
+  SIMPLE_TEST(DamagedIndex) {
+    TempLog log;
+    WriteHours(log.path, 0, 4);
+    fallible::BuildErrorLogIndex(log.path).ExpectOk();
+
+    // Last posting points past the records
+    FILE* index = std::fopen(fallible::ErrorLogIndexPath(log.path).c_str(), "r+");
+    std::fseek(index, -4, SEEK_END);
+    uint32_t ordinal = 0xFFFFFFFF;
+    std::fwrite(&ordinal, sizeof(ordinal), 1, index);
+    std::fclose(index);
+
+    ErrorLogQuery query;
+    query.domain = "Storage";
+    ASSERT_EQ(Count(log.path, query), 4);
+
+    ErrorLogQuery all;
+    ASSERT_EQ(Count(log.path, all), 20);
+  }
+}
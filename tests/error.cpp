@@ -1,10 +1,27 @@
 #include <fallible/error/error.hpp>
 #include <fallible/error/codes.hpp>
 #include <fallible/error/make.hpp>
+#include <fallible/support/confined.hpp>
 
 #include <wheels/test/test_framework.hpp>
+#include <wheels/core/assert.hpp>
 
+#include "allocs.hpp"
+
+#include <fmt/compile.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <future>
 #include <iostream>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+using namespace std::chrono_literals;
 
 using fallible::Error;
 using fallible::ErrorCodes;
@@ -21,6 +38,35 @@ static Error TimedOut(wheels::SourceLocation loc = wheels::SourceLocation::Curre
       .Done();
 }
 
+// Counts renderings
+struct Shard {
+  int id;
+};
+
+static size_t shard_formats = 0;
+
+template <>
+struct fmt::formatter<Shard> {
+  constexpr auto parse(fmt::format_parse_context& ctx) {
+    return ctx.begin();
+  }
+
+  template <typename FormatContext>
+  auto format(const Shard& shard, FormatContext& ctx) const {
+    ++shard_formats;
+    return fmt::format_to(ctx.out(), "{}", shard.id);
+  }
+};
+
+struct RetryInfo {
+  std::chrono::milliseconds after;
+  int attempts;
+};
+
+struct LargePayload {
+  char data[128];
+};
+
 ////////////////////////////////////////////////////////////////////////////////
 
 TEST_SUITE(Error) {
@@ -48,4 +94,529 @@ TEST_SUITE(Error) {
 
     ASSERT_EQ(sub_error.Code(), 123);
   }
+
+  SIMPLE_TEST(CodeOnly) {
+    static_assert(sizeof(Error) == sizeof(void*));
+
+    Error error = fallible::errors::Cancelled();
+
+    ASSERT_EQ(error.Code(), ErrorCodes::Cancelled);
+    ASSERT_TRUE(error.IsCancelled());
+    ASSERT_EQ(error.Reason(), "");
+    ASSERT_TRUE(error.Attrs().empty());
+    ASSERT_TRUE(error.SubErrors().empty());
+
+    Error copy = error;
+    ASSERT_EQ(copy.Code(), ErrorCodes::Cancelled);
+  }
+
+  SIMPLE_TEST(AddAttrToCodeOnly) {
+    Error error = Err(ErrorCodes::TimedOut);
+    error.AddAttr("shard", "17");
+
+    ASSERT_EQ(error.Code(), ErrorCodes::TimedOut);
+    ASSERT_TRUE(error.Context().HasAttr("shard"));
+  }
+
+  SIMPLE_TEST(CopyAndMove) {
+    Error error = TimedOut();
+
+    Error copy = error;
+    ASSERT_EQ(copy.Reason(), "Operation timed out");
+
+    Error moved = std::move(copy);
+    ASSERT_EQ(moved.Code(), ErrorCodes::TimedOut);
+    ASSERT_EQ(error.Reason(), "Operation timed out");
+
+    moved = fallible::errors::Cancelled();
+    ASSERT_EQ(moved.Code(), ErrorCodes::Cancelled);
+  }
+
+  SIMPLE_TEST(Allocations) {
+    {
+      AllocationCounter allocs;
+      Error error = FALLIBLE_ERR(ErrorCodes::Cancelled);
+      ASSERT_EQ(allocs.Count(), 0);
+    }
+
+    // Dynamic call sites are interned on first use
+    for (size_t i = 0; i < 2; ++i) {
+      AllocationCounter allocs;
+      Error error = fallible::errors::Cancelled();
+      if (i > 0) {
+        ASSERT_EQ(allocs.Count(), 0);
+      }
+    }
+
+    for (size_t i = 0; i < 2; ++i) {
+      AllocationCounter allocs;
+      Error error = fallible::errors::Unavailable()
+                        .Domain("Rpc")
+                        .Reason("peer down")
+                        .Done();
+      if (i > 0) {
+        ASSERT_EQ(allocs.Count(), 1);
+      }
+
+      size_t count = allocs.Count();
+      Error copy = error;
+      ASSERT_EQ(allocs.Count(), count);
+    }
+  }
+
+  SIMPLE_TEST(CodeOnlyOrigin) {
+    Error error = fallible::errors::TimedOut();
+    int line = __LINE__ - 1;
+
+    ASSERT_EQ(error.SourceLocation().Line(), line);
+    ASSERT_NE(error.Site(), 0u);
+
+    // Context of a code-only error carries the origin too
+    ASSERT_EQ(error.Context().Site(), error.Site());
+    ASSERT_EQ(error.Context().SourceLocation().Line(), line);
+
+    {
+      // A view of the site, nothing is allocated
+      AllocationCounter allocs;
+      auto context = error.Context();
+      ASSERT_EQ(context.Site(), error.Site());
+      ASSERT_EQ(allocs.Count(), 0);
+    }
+
+    Error copy = error;
+    ASSERT_EQ(copy.Site(), error.Site());
+
+    // Materialized payload keeps the origin
+    copy.AddAttr("key", "value");
+    ASSERT_EQ(copy.Site(), error.Site());
+    ASSERT_EQ(copy.SourceLocation().Line(), line);
+  }
+
+  SIMPLE_TEST(StaticSite) {
+    Error error = FALLIBLE_ERR_IN("Storage", ErrorCodes::NotFound);
+    int line = __LINE__ - 1;
+
+    const auto& site = fallible::GetCallSite(error.Site());
+    ASSERT_EQ(site.line, line);
+    ASSERT_EQ(site.code, ErrorCodes::NotFound);
+    ASSERT_EQ(site.domain, "Storage");
+
+    ASSERT_EQ(error.Domain(), "Storage");
+    ASSERT_EQ(error.SourceLocation().Line(), line);
+
+    // Explicit domain wins
+    Error remote = FALLIBLE_ERR_IN("Storage", ErrorCodes::NotFound)
+                       .Domain("Remote")
+                       .Done();
+    ASSERT_EQ(remote.Domain(), "Remote");
+  }
+
+  SIMPLE_TEST(DynamicStrings) {
+    std::string domain = "Dyn";
+    domain += "amic";
+
+    Error error = Err(ErrorCodes::Internal)
+                      .Domain(domain)
+                      .Reason(std::string_view{"Reason"})
+                      .Done();
+
+    domain.clear();
+
+    ASSERT_EQ(error.Domain(), "Dynamic");
+    ASSERT_EQ(error.Reason(), "Reason");
+  }
+
+  SIMPLE_TEST(CharBuffers) {
+    char buf[16];
+    std::snprintf(buf, sizeof(buf), "shard-%d", 7);
+
+    Error error = Err(ErrorCodes::Internal)
+                      .Domain(buf)
+                      .Reason(buf)
+                      .Attr(buf, buf)
+                      .Done();
+
+    std::snprintf(buf, sizeof(buf), "overwritten");
+
+    ASSERT_EQ(error.Domain(), "shard-7");
+    ASSERT_EQ(error.Reason(), "shard-7");
+    ASSERT_EQ(*error.Attrs().Find("shard-7")->AsString(), "shard-7");
+
+    // Constant oversized buffer: the padding is not part of the string
+    static constexpr char kPadded[16] = "Padded";
+    Error padded = Err(ErrorCodes::Internal)
+                       .Domain(kPadded)
+                       .Reason(kPadded)
+                       .Done();
+    ASSERT_EQ(padded.Domain(), "Padded");
+    ASSERT_EQ(padded.Reason(), "Padded");
+  }
+
+  SIMPLE_TEST(Payload) {
+    static_assert(fallible::detail::SmallAny::IsInline<RetryInfo>());
+
+    Error error = Err(ErrorCodes::Unavailable)
+                      .Payload(RetryInfo{150ms, 3})
+                      .Done();
+
+    const RetryInfo* info = error.Payload<RetryInfo>();
+    ASSERT_TRUE(info != nullptr);
+    ASSERT_TRUE(info->after == 150ms);
+    ASSERT_EQ(info->attempts, 3);
+
+    ASSERT_TRUE(error.Payload<LargePayload>() == nullptr);
+
+    // Shared with copies
+    Error copy = error;
+    ASSERT_EQ(copy.Payload<RetryInfo>(), info);
+  }
+
+  SIMPLE_TEST(LargePayload) {
+    Error error = fallible::errors::Cancelled();
+    ASSERT_TRUE(error.Payload<LargePayload>() == nullptr);
+
+    LargePayload payload{};
+    payload.data[127] = 'x';
+    error.SetPayload(payload);
+
+    ASSERT_EQ(error.Code(), ErrorCodes::Cancelled);
+    ASSERT_EQ(error.Payload<LargePayload>()->data[127], 'x');
+  }
+
+  SIMPLE_TEST(TypedAttrs) {
+    Error error = Err(ErrorCodes::ResourceExhausted)
+                      .Attr("bytes", 4096)
+                      .Attr("retry_after", 2s)
+                      .Done();
+
+    ASSERT_TRUE(error.Attrs().Find("bytes")->AsInt() == 4096);
+    ASSERT_TRUE(error.Describe().find("retry_after = 2s") != std::string::npos);
+  }
+
+  SIMPLE_TEST(LazyReason) {
+    shard_formats = 0;
+
+    Error error = Err(ErrorCodes::Unavailable)
+                      .Reason(FMT_COMPILE("shard {} lag {}ms"), Shard{7}, 15)
+                      .Done();
+
+    ASSERT_EQ(shard_formats, 0);
+
+    ASSERT_EQ(error.Reason(), "shard 7 lag 15ms");
+    ASSERT_EQ(shard_formats, 1);
+  }
+
+  SIMPLE_TEST(LazyReasonRuntimeFormat) {
+    std::string peer = "db-3";
+
+    Error error = Err(ErrorCodes::Unavailable)
+                      .Reason("peer {} down for {}s", std::string_view{peer}, 3)
+                      .Done();
+
+    // String arguments are captured by value
+    peer = "overwritten";
+
+    ASSERT_EQ(error.Reason(), "peer db-3 down for 3s");
+    ASSERT_TRUE(error.Describe().find("peer db-3") != std::string::npos);
+  }
+
+  SIMPLE_TEST(LazyReasonAllocations) {
+    // Small arguments are captured inside the error allocation
+    for (size_t i = 0; i < 2; ++i) {
+      AllocationCounter allocs;
+      Error error = Err(ErrorCodes::Unavailable)
+                        .Reason(FMT_COMPILE("shard {} lag {}ms"), 7, 15)
+                        .Done();
+      if (i > 0) {
+        ASSERT_EQ(allocs.Count(), 1);
+      }
+    }
+  }
+
+  SIMPLE_TEST(CopyOnWrite) {
+    Error error = TimedOut();
+    Error copy = error;
+
+    copy.AddAttr("shard", 17);
+
+    ASSERT_TRUE(copy.Attrs().Find("shard") != nullptr);
+    ASSERT_TRUE(error.Attrs().empty());
+    ASSERT_EQ(copy.Reason(), error.Reason());
+
+    // Contexts share payload with the error until mutated
+    auto context = error.Context();
+    context.AddAttr("host", "db-3");
+    ASSERT_FALSE(error.Context().HasAttr("host"));
+  }
+
+  SIMPLE_TEST(UniqueInPlace) {
+    Error error = TimedOut();
+    error.AddAttr("warmup", 1);  // Interns attribute name
+
+    {
+      AllocationCounter allocs;
+      error.AddAttr("shard", 17);
+      ASSERT_EQ(allocs.Count(), 0);
+    }
+
+    Error copy = error;
+
+    {
+      AllocationCounter allocs;
+      copy.AddAttr("shard", 18);
+      ASSERT_EQ(allocs.Count(), 1);  // Single copy
+      copy.AddAttr("warmup", 2);
+      ASSERT_EQ(allocs.Count(), 1);  // Unique now
+    }
+  }
+
+  SIMPLE_TEST(CopyOnWriteStress) {
+    static const size_t kThreads = 4;
+    static const size_t kIterations = 10'000;
+
+    Error shared = Err(ErrorCodes::Unavailable)
+                       .Reason("shared")
+                       .Attr("origin", "test")
+                       .Done();
+
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < kThreads; ++t) {
+      threads.emplace_back([shared, t] {
+        for (size_t i = 0; i < kIterations; ++i) {
+          Error copy = shared;
+          copy.AddAttr("thread", t);
+          copy.AddAttr("iter", i);
+
+          auto thread = copy.Attrs().Find("thread")->AsUInt();
+          WHEELS_VERIFY(thread == t, "Foreign attribute value");
+          WHEELS_VERIFY(copy.Attrs().size() == 3, "Unexpected attributes");
+          WHEELS_VERIFY(shared.Attrs().size() == 1, "Shared error mutated");
+        }
+      });
+    }
+
+    for (auto& thread : threads) {
+      thread.join();
+    }
+
+    ASSERT_EQ(shared.Attrs().size(), 1);
+    ASSERT_EQ(shared.Reason(), "shared");
+  }
+
+  SIMPLE_TEST(ThreadConfined) {
+    Error error = fallible::errors::Ok();
+
+    {
+      fallible::ThreadConfinedScope confined;
+
+      error = Err(ErrorCodes::Unavailable)
+                  .Reason("local")
+                  .AddSubError(Err(ErrorCodes::TimedOut).Reason("sub").Done())
+                  .Done();
+
+      Error copy = error;
+      copy.AddAttr("shard", 1);
+      ASSERT_TRUE(error.Attrs().empty());
+    }
+
+    // Hand off to another thread
+    error.Share();
+
+    std::thread consumer([error] {
+      for (size_t i = 0; i < 1000; ++i) {
+        Error copy = error;
+        Error sub_error = copy.SubError();
+        WHEELS_VERIFY(sub_error.Reason() == "sub", "Unexpected sub-error");
+      }
+    });
+
+    for (size_t i = 0; i < 1000; ++i) {
+      Error copy = error;
+      ASSERT_EQ(copy.Reason(), "local");
+    }
+
+    consumer.join();
+  }
+
+  SIMPLE_TEST(Wrap) {
+    Error root = Err(ErrorCodes::TimedOut)
+                     .Domain("Rpc")
+                     .Reason("deadline exceeded")
+                     .Attr("peer", "db-3")
+                     .Payload(RetryInfo{150ms, 1})
+                     .Done();
+
+    Error wrapped = fallible::Wrap(root)
+                        .Reason("Fetch user")
+                        .Attr("user", 42)
+                        .Done();
+    int line = __LINE__ - 4;
+
+    ASSERT_EQ(wrapped.Code(), ErrorCodes::TimedOut);
+    ASSERT_EQ(wrapped.Domain(), "Rpc");
+    ASSERT_EQ(wrapped.Reason(), "Fetch user: deadline exceeded");
+    ASSERT_EQ(wrapped.SourceLocation().Line(), line);
+
+    ASSERT_TRUE(wrapped.FindAttr("user")->AsInt() == 42);
+    ASSERT_TRUE(wrapped.FindAttr("peer")->AsString() == "db-3");
+    ASSERT_TRUE(wrapped.Attrs().Find("peer") == nullptr);
+    ASSERT_TRUE(wrapped.Payload<RetryInfo>()->after == 150ms);
+
+    ASSERT_TRUE(wrapped.Cause() != nullptr);
+    ASSERT_EQ(wrapped.Cause()->Reason(), "deadline exceeded");
+
+    auto description = wrapped.Describe();
+    ASSERT_TRUE(description.find("caused by:") != std::string::npos);
+    ASSERT_TRUE(description.find("reason = 'deadline exceeded'") != std::string::npos);
+  }
+
+  SIMPLE_TEST(WrapIsCheap) {
+    Error root = TimedOut();
+
+    for (size_t i = 0; i < 2; ++i) {
+      AllocationCounter allocs;
+      Error error = root;
+      for (size_t layer = 0; layer < 10; ++layer) {
+        error = fallible::Wrap(error).Reason("Layer").Done();
+      }
+      if (i > 0) {
+        // Single allocation per frame, no copying of the tail
+        ASSERT_EQ(allocs.Count(), 10);
+      }
+    }
+  }
+
+  SIMPLE_TEST(Fingerprint) {
+    auto make = [](int shard) {
+      return Err(ErrorCodes::Unavailable)
+          .Domain("Rpc")
+          .Reason(FMT_COMPILE("shard {} is unavailable"), shard)
+          .Attr("shard", shard)
+          .Done();
+    };
+
+    // Rendered arguments and attributes are ignored
+    Error first = make(1);
+    Error second = make(2);
+    ASSERT_EQ(first.Fingerprint(), second.Fingerprint());
+    ASSERT_TRUE(first == second);
+
+    // Code, domain, site and reason template are not
+    Error other_code = Err(ErrorCodes::TimedOut).Domain("Rpc").Reason("shard {} is unavailable").Done();
+    ASSERT_TRUE(first.Fingerprint() != other_code.Fingerprint());
+    ASSERT_TRUE(first != other_code);
+
+    ASSERT_TRUE(TimedOut() == TimedOut());
+    Error other_site = TimedOut();
+    Error another_site = TimedOut();
+    ASSERT_TRUE(other_site != another_site);
+    ASSERT_TRUE(other_site.Fingerprint() != another_site.Fingerprint());
+
+    ASSERT_TRUE(fallible::Wrap(first).Done() == fallible::Wrap(second).Done());
+    ASSERT_TRUE(first != fallible::Wrap(first).Done());
+
+    std::unordered_map<Error, size_t> counts;
+    for (int shard = 0; shard < 10; ++shard) {
+      ++counts[make(shard)];
+    }
+    ASSERT_EQ(counts.size(), 1);
+    ASSERT_EQ(counts.begin()->second, 10);
+  }
+
+  SIMPLE_TEST(StaticError) {
+    static const auto kQueueFull = fallible::StaticError(
+        ErrorCodes::ResourceExhausted, "Rpc", "queue full");
+
+    {
+      AllocationCounter allocs;
+      for (size_t i = 0; i < 16; ++i) {
+        Error error = kQueueFull;
+        ASSERT_EQ(error.Code(), ErrorCodes::ResourceExhausted);
+        ASSERT_EQ(error.Domain(), "Rpc");
+      }
+      ASSERT_EQ(allocs.Count(), 0);
+    }
+
+    // Copy-on-write
+    Error copy = kQueueFull;
+    copy.AddAttr("queue", "ingest");
+    ASSERT_TRUE(copy.Attrs().Find("queue") != nullptr);
+    ASSERT_TRUE(kQueueFull.Attrs().Find("queue") == nullptr);
+
+    // Shared by threads
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < 4; ++t) {
+      threads.emplace_back([] {
+        for (size_t i = 0; i < 1024; ++i) {
+          Error error = kQueueFull;
+          error.Share();
+          WHEELS_VERIFY(error == kQueueFull, "Unexpected error");
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+
+    ASSERT_EQ(kQueueFull.Reason(), "queue full");
+  }
+
+  SIMPLE_TEST(FromErrno) {
+    auto error = Err(fallible::FromErrno{ENOENT}).Done();
+    ASSERT_EQ(error.Code(), ErrorCodes::NotFound);
+    ASSERT_EQ(error.Domain(), "generic");
+    ASSERT_EQ(error.Reason(), std::generic_category().message(ENOENT));
+
+    ASSERT_EQ(Err(fallible::FromErrno{ETIMEDOUT}).Done().Code(), ErrorCodes::TimedOut);
+    ASSERT_EQ(Err(fallible::FromErrno{EAGAIN}).Done().Code(), ErrorCodes::Unavailable);
+    ASSERT_EQ(Err(fallible::FromErrno{EWOULDBLOCK}).Done().Code(), ErrorCodes::Unavailable);
+  }
+
+  SIMPLE_TEST(ErrnoFingerprints) {
+    // Same canonical code, different values
+    auto eagain = Err(fallible::FromErrno{EAGAIN}).Done();
+    auto ebusy = Err(fallible::FromErrno{EBUSY}).Done();
+    ASSERT_NE(eagain.Fingerprint(), ebusy.Fingerprint());
+  }
+
+  SIMPLE_TEST(CanonicalErrorCodes) {
+    using fallible::CanonicalErrorCode;
+
+    ASSERT_EQ(CanonicalErrorCode(std::error_code{}), ErrorCodes::Ok);
+    ASSERT_EQ(CanonicalErrorCode(std::make_error_code(std::errc::permission_denied)),
+              ErrorCodes::Unauthorized);
+    ASSERT_EQ(CanonicalErrorCode(std::error_code(ECONNRESET, std::system_category())),
+              ErrorCodes::Disconnected);
+    ASSERT_EQ(CanonicalErrorCode(std::error_code(ENOSPC, std::generic_category())),
+              ErrorCodes::ResourceExhausted);
+    ASSERT_EQ(CanonicalErrorCode(std::error_code(100500, std::generic_category())),
+              ErrorCodes::Unknown);
+    ASSERT_EQ(CanonicalErrorCode(std::make_error_code(std::future_errc::no_state)),
+              ErrorCodes::Unknown);
+  }
+
+  SIMPLE_TEST(LazySystemMessage) {
+    struct CountingCategory : std::error_category {
+      mutable int messages = 0;
+
+      const char* name() const noexcept override {
+        return "counting";
+      }
+
+      std::string message(int value) const override {
+        ++messages;
+        return "message " + std::to_string(value);
+      }
+    };
+
+    static const CountingCategory category;
+
+    auto error = Err(std::error_code(7, category)).Done();
+    ASSERT_EQ(error.Code(), ErrorCodes::Unknown);
+    ASSERT_EQ(error.Domain(), "counting");
+    ASSERT_EQ(category.messages, 0);
+
+    ASSERT_EQ(error.Reason(), "message 7");
+    ASSERT_EQ(category.messages, 1);
+  }
 }
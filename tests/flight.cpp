@@ -0,0 +1,83 @@
+#include <fallible/telemetry/flight.hpp>
+#include <fallible/error/make.hpp>
+
+#include <wheels/test/test_framework.hpp>
+
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+using fallible::Error;
+using fallible::ErrorCodes;
+
+////////////////////////////////////////////////////////////////////////////////
+
+// The recorder is process-wide, so is this test
+TEST_SUITE(FlightRecorder) {
+  SIMPLE_TEST(RecordAndSeal) {
+    std::string path = "/tmp/fallible-flight-" + std::to_string(::getpid());
+
+    fallible::FlightRecorderOptions options;
+    options.max_threads = 4;
+    options.records_per_thread = 8;
+
+    // Does not fit into the header
+    fallible::FlightRecorderOptions huge = options;
+    huge.records_per_thread = size_t{1} << 32;
+    ASSERT_TRUE(fallible::StartFlightRecorder(path, huge).Failed());
+
+    fallible::StartFlightRecorder(path, options).ExpectOk();
+    ASSERT_TRUE(fallible::StartFlightRecorder(path).Failed());  // Recorded too
+
+    for (int i = 0; i < 12; ++i) {
+      Error error = fallible::Err(ErrorCodes::Unavailable)
+                        .Domain("Rpc")
+                        .Reason("peer {} is down", i)
+                        .Done();
+    }
+
+    {
+      auto log = fallible::ReadFlightLog(path);
+      ASSERT_TRUE(log.IsOk());
+      ASSERT_FALSE(log->sealed);
+
+      // Last records of the ring
+      ASSERT_EQ(log->records.size(), 8);
+      const auto& last = log->records.back();
+      ASSERT_EQ(last.code, ErrorCodes::Unavailable);
+      ASSERT_EQ(last.domain, "Rpc");
+      ASSERT_EQ(last.reason, "peer {} is down");
+      ASSERT_TRUE(last.file.ends_with("flight.cpp"));
+    }
+
+    fallible::detail::SealFlightRecorder(wheels::SourceLocation::Current(), "Test panic");
+
+    {
+      auto log = fallible::ReadFlightLog(path);
+      ASSERT_TRUE(log.IsOk());
+      ASSERT_TRUE(log->sealed);
+      ASSERT_EQ(log->panic_reason, "Test panic");
+      ASSERT_TRUE(fallible::Describe(*log).find("Panicked at") != std::string::npos);
+    }
+
+    ASSERT_TRUE(fallible::ReadFlightLog("/nonexistent").Failed());
+
+    {
+      // Zeroed records_per_thread, rings are not empty
+      std::string damaged = path + ".damaged";
+      std::ifstream in{path, std::ios::binary};
+      std::string bytes{std::istreambuf_iterator<char>{in}, {}};
+      std::memset(bytes.data() + 16, 0, sizeof(uint32_t));
+      std::ofstream{damaged, std::ios::binary} << bytes;
+
+      ASSERT_TRUE(fallible::ReadFlightLog(damaged).Failed());
+      ::unlink(damaged.c_str());
+    }
+
+    ::unlink(path.c_str());
+  }
+}
@@ -0,0 +1,151 @@
+#include <fallible/error/format.hpp>
+#include <fallible/error/throw.hpp>
+#include <fallible/result/format.hpp>
+#include <fallible/result/make.hpp>
+
+#include <wheels/test/test_framework.hpp>
+
+#include "allocs.hpp"
+
+#include <fmt/format.h>
+
+#include <chrono>
+#include <string>
+#include <string_view>
+
+using fallible::Error;
+using fallible::ErrorCodes;
+
+using namespace std::chrono_literals;
+
+////////////////////////////////////////////////////////////////////////////////
+
+static bool Contains(std::string_view text, std::string_view part) {
+  return text.find(part) != std::string_view::npos;
+}
+
+static std::string Json(const Error& error, size_t max_depth = fallible::kDefaultFormatDepth) {
+  fmt::memory_buffer out;
+  fallible::WriteJson(out, error, max_depth);
+  return fmt::to_string(out);
+}
+
+static std::string Logfmt(const Error& error, size_t max_depth = fallible::kDefaultFormatDepth) {
+  fmt::memory_buffer out;
+  fallible::WriteLogfmt(out, error, max_depth);
+  return fmt::to_string(out);
+}
+
+static Error Timeout() {
+  return fallible::Err(ErrorCodes::TimedOut)
+      .Domain("Rpc")
+      .Reason("Deadline {} exceeded", "\"call\"")
+      .Attr("shard", 17)
+      .Attr("elapsed", 150ms)
+      .Attr("peer", "db 3")
+      .Done();
+}
+
+// Sub-errors nested `depth` levels deep
+static Error Nested(size_t depth) {
+  Error error = fallible::Err(ErrorCodes::Aborted).Done();
+  for (size_t i = 0; i < depth; ++i) {
+    error = fallible::Err(ErrorCodes::Internal).AddSubError(error).Done();
+  }
+  return error;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+TEST_SUITE(Format) {
+  SIMPLE_TEST(Summary) {
+    Error error = fallible::Wrap(Timeout()).Domain("Storage").Reason("Read failed").Done();
+
+    auto summary = fmt::format("{}", error);
+    ASSERT_TRUE(summary.starts_with("TimedOut (Storage): Read failed at "));
+    ASSERT_TRUE(Contains(summary, "; caused by TimedOut (Rpc): Deadline \"call\" exceeded at "));
+
+    ASSERT_EQ(fmt::format("{}", fallible::errors::Cancelled().Done()).substr(0, 12), "Cancelled at");
+    ASSERT_TRUE(fmt::format("{:v}", error) == error.Describe());
+  }
+
+  SIMPLE_TEST(Json) {
+    auto json = Json(Timeout());
+
+    ASSERT_TRUE(json.starts_with(R"({"code":6,"code_name":"TimedOut","domain":"Rpc",)"));
+    ASSERT_TRUE(Contains(json, R"("reason":"Deadline \"call\" exceeded")"));
+    ASSERT_TRUE(Contains(json, R"("attrs":{"elapsed":"150ms","peer":"db 3","shard":17})"));
+    ASSERT_TRUE(Contains(json, R"("file":")"));
+    ASSERT_TRUE(json.ends_with("}"));
+    ASSERT_EQ(fmt::format("{:j}", Timeout()), json);
+
+    Error wrapped = fallible::Wrap(Timeout()).Reason("Retry").Done();
+    ASSERT_TRUE(Contains(Json(wrapped), R"(,"cause":{"code":6,)"));
+  }
+
+  SIMPLE_TEST(Logfmt) {
+    auto logfmt = Logfmt(Timeout());
+
+    ASSERT_TRUE(logfmt.starts_with(R"(code=TimedOut domain=Rpc reason="Deadline \"call\" exceeded" site=)"));
+    ASSERT_TRUE(Contains(logfmt, R"( attr.elapsed=150ms attr.peer="db 3" attr.shard=17)"));
+    ASSERT_EQ(fmt::format("{:l}", Timeout()), logfmt);
+
+    Error group = fallible::Err(ErrorCodes::Internal).AddSubError(Timeout()).Done();
+    ASSERT_TRUE(Contains(Logfmt(group), " sub.0.code=TimedOut sub.0.domain=Rpc "));
+  }
+
+  SIMPLE_TEST(DepthLimit) {
+    Error deep = Nested(5);
+
+    ASSERT_TRUE(Contains(Json(deep, 2), R"({"truncated":true})"));
+    ASSERT_FALSE(Contains(Json(deep, 5), "truncated"));
+
+    ASSERT_TRUE(Contains(Logfmt(deep, 1), " sub.0.sub.0.truncated=true"));
+
+    fmt::memory_buffer out;
+    fallible::DescribeTo(out, deep, 1);
+    ASSERT_TRUE(Contains(fmt::to_string(out), "sub-errors:\n[0]\ncode = 12"));
+    ASSERT_TRUE(Contains(fmt::to_string(out), "\n..."));
+  }
+
+  SIMPLE_TEST(UnknownCode) {
+    Error error = fallible::Err(123).Done();
+    ASSERT_TRUE(fmt::format("{}", error).starts_with("Code(123)"));
+  }
+
+  SIMPLE_TEST(Result) {
+    fallible::Result<int> ok = fallible::Ok(42);
+    ASSERT_EQ(fmt::format("{}", ok), "Ok(42)");
+    ASSERT_EQ(fmt::format("{}", fallible::Ok()), "Ok");
+
+    fallible::Result<int> failed = fallible::Fail(fallible::errors::Cancelled().Done());
+    ASSERT_TRUE(fmt::format("{}", failed).starts_with("Error(Cancelled at "));
+  }
+
+  SIMPLE_TEST(SourceLocation) {
+    fallible::SourceLocation where{"file.cpp", "F", 7};
+    ASSERT_EQ(fmt::format("{}", where), "file.cpp:7");
+  }
+
+  SIMPLE_TEST(LazyException) {
+    fallible::ErrorException exception{Timeout()};
+    ASSERT_TRUE(Contains(exception.what(), "reason = 'Deadline \"call\" exceeded'"));
+
+    fallible::ErrorException copy = exception;
+    ASSERT_EQ(copy.what(), exception.what());
+  }
+
+  SIMPLE_TEST(ExceptionOutOfMemory) {
+    fallible::ErrorException exception{Timeout()};
+
+    const char* what = nullptr;
+    {
+      AllocationFailures failures;
+      what = exception.what();
+    }
+    ASSERT_EQ(std::string_view{what}, "TimedOut");
+
+    // Rendered once memory is available again
+    ASSERT_TRUE(Contains(exception.what(), "Deadline"));
+  }
+}
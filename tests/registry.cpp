@@ -0,0 +1,107 @@
+#include <fallible/error/codes.hpp>
+#include <fallible/error/make.hpp>
+#include <fallible/context/domain.hpp>
+#include <fallible/context/make.hpp>
+
+#include <wheels/test/test_framework.hpp>
+
+using fallible::ErrorCodes;
+using fallible::Err;
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace storage {
+
+inline constexpr fallible::ErrorDomain kDomain{"Storage"};
+FALLIBLE_REGISTER_DOMAIN(kDomain);
+
+inline constexpr fallible::ErrorCode kQuotaExceeded{1001, "QuotaExceeded"};
+FALLIBLE_REGISTER_ERROR_CODE(kQuotaExceeded);
+
+}  // namespace storage
+
+namespace billing {
+
+inline constexpr fallible::ErrorDomain kDomain{"Billing"};
+inline constexpr fallible::ErrorCode kCardDeclined{1002, "CardDeclined"};
+
+}  // namespace billing
+
+// Qualified names
+FALLIBLE_REGISTER_DOMAIN(billing::kDomain);
+FALLIBLE_REGISTER_ERROR_CODE(billing::kCardDeclined);
+
+static_assert(storage::kDomain.id == fallible::DomainIdOf("Storage"));
+// What .Domain("Storage") binds to
+static_assert(fallible::ErrorDomain{"Storage"}.id == storage::kDomain.id);
+static_assert(fallible::DomainIdOf("") == 0);
+
+////////////////////////////////////////////////////////////////////////////////
+
+TEST_SUITE(Registry) {
+  SIMPLE_TEST(CanonicalCodes) {
+    ASSERT_EQ(fallible::ErrorCodeName(ErrorCodes::TimedOut), "TimedOut");
+    ASSERT_EQ(*fallible::FindErrorCode("NotFound"), ErrorCodes::NotFound);
+    ASSERT_FALSE(fallible::FindErrorCode("NoSuchCode").has_value());
+  }
+
+  SIMPLE_TEST(UnknownCodes) {
+    ASSERT_FALSE(fallible::FindErrorCodeName(ENOENT + 500).has_value());
+    ASSERT_EQ(fallible::ErrorCodeName(-7), "Code(-7)");
+
+    auto error = Err(42).Reason("Raw errno").Done();
+    ASSERT_TRUE(error.Describe().find("Code(42)") != std::string::npos);
+  }
+
+  SIMPLE_TEST(CustomCodes) {
+    ASSERT_EQ(fallible::ErrorCodeName(storage::kQuotaExceeded), "QuotaExceeded");
+    ASSERT_EQ(*fallible::FindErrorCode("QuotaExceeded"), 1001);
+
+    auto error = Err(storage::kQuotaExceeded).Reason("Daily quota").Done();
+    ASSERT_EQ(error.Code(), 1001);
+    ASSERT_TRUE(error.Describe().find("QuotaExceeded") != std::string::npos);
+  }
+
+  SIMPLE_TEST(RegisterTwice) {
+    fallible::RegisterErrorCode(storage::kQuotaExceeded);
+    fallible::RegisterDomain(storage::kDomain);
+  }
+
+  SIMPLE_TEST(DomainNames) {
+    ASSERT_EQ(*fallible::FindDomainName(storage::kDomain.id), "Storage");
+    ASSERT_EQ(*fallible::FindDomainName(billing::kDomain.id), "Billing");
+    ASSERT_EQ(fallible::ErrorCodeName(billing::kCardDeclined), "CardDeclined");
+    ASSERT_FALSE(fallible::FindDomainName(fallible::DomainIdOf("Unregistered")).has_value());
+  }
+
+  SIMPLE_TEST(DomainIds) {
+    auto declared = Err(ErrorCodes::Unavailable).Domain(storage::kDomain).Done();
+    ASSERT_EQ(declared.Domain(), "Storage");
+    ASSERT_TRUE(declared.InDomain(storage::kDomain));
+
+    // Same id whichever way the domain is set
+    auto literal = Err(ErrorCodes::Unavailable).Domain("Storage").Done();
+    auto dynamic = Err(ErrorCodes::Unavailable).Domain(std::string{"Storage"}).Done();
+    ASSERT_EQ(literal.DomainId(), storage::kDomain.id);
+    ASSERT_EQ(dynamic.DomainId(), storage::kDomain.id);
+
+    auto other = Err(ErrorCodes::Unavailable).Domain("Rpc").Done();
+    ASSERT_FALSE(other.InDomain(storage::kDomain));
+
+    ASSERT_EQ(Err(ErrorCodes::Unknown).Done().DomainId(), 0);
+  }
+
+  SIMPLE_TEST(SiteDomainIds) {
+    auto error = FALLIBLE_ERR_IN("Storage", ErrorCodes::NotFound).Done();
+    ASSERT_TRUE(error.InDomain(storage::kDomain));
+
+    auto context = FALLIBLE_CTX().Domain(storage::kDomain).Done();
+    ASSERT_EQ(context.DomainId(), storage::kDomain.id);
+  }
+
+  SIMPLE_TEST(WrappedDomainIds) {
+    auto inner = Err(ErrorCodes::TimedOut).Domain(storage::kDomain).Done();
+    auto outer = fallible::Wrap(inner).Reason("Flush").Done();
+    ASSERT_TRUE(outer.InDomain(storage::kDomain));
+  }
+}
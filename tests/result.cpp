@@ -4,6 +4,8 @@
 
 #include <wheels/test/test_framework.hpp>
 
+#include <memory>
+
 using fallible::Error;
 using fallible::ErrorCodes;
 
@@ -75,6 +77,78 @@ int TestClass::object_count_ = 0;
 
 ////////////////////////////////////////////////////////////////////////////////
 
+// Niche layout
+
+struct Handle {
+  int fd;
+};
+
+enum class Color {
+  Red,
+  Green,
+};
+
+template <>
+struct fallible::ResultNiche<Handle*> : fallible::PointerNiche<Handle> {};
+
+template <>
+struct fallible::ResultNiche<std::unique_ptr<Handle>>
+    : fallible::PointerNiche<Handle> {};
+
+static_assert(sizeof(Result<Handle*>) == sizeof(Handle*));
+static_assert(sizeof(Result<std::unique_ptr<Handle>>) == sizeof(Handle*));
+static_assert(sizeof(Result<Color>) == sizeof(Error));
+static_assert(sizeof(Result<int>) == sizeof(Error));
+static_assert(sizeof(Status) == sizeof(Error));
+
+// Not opted in
+static_assert(sizeof(Result<char*>) > sizeof(char*));
+
+// Special members
+
+static_assert(std::is_nothrow_move_constructible_v<Result<std::string>>);
+static_assert(std::is_nothrow_move_assignable_v<Result<std::string>>);
+static_assert(std::is_nothrow_copy_constructible_v<Result<int>>);
+
+static_assert(fallible::IsTriviallyRelocatable<Result<int>>::value);
+static_assert(fallible::IsTriviallyRelocatable<Result<std::unique_ptr<Handle>>>::value);
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Lightweight error type
+
+namespace parser {
+
+enum class ParseError {
+  Eof,
+  BadChar,
+};
+
+fallible::Error ToError(ParseError e) {
+  return fallible::Err(e == ParseError::Eof ? ErrorCodes::NotFound
+                                            : ErrorCodes::Invalid);
+}
+
+Result<int, ParseError> ParseDigit(std::string_view input) {
+  if (input.empty()) {
+    return Fail(ParseError::Eof);
+  }
+  if (input[0] < '0' || input[0] > '9') {
+    return Result<int, ParseError>::Fail(ParseError::BadChar);
+  }
+  return Result<int, ParseError>::Ok(input[0] - '0');
+}
+
+}  // namespace parser
+
+static_assert(sizeof(Result<int, parser::ParseError>) == 2 * sizeof(int));
+static_assert(std::is_trivially_copyable_v<Result<int, parser::ParseError>>);
+// Default E = Error: relocatable, but not trivially copyable
+static_assert(!std::is_trivially_copyable_v<Result<int>>);
+static_assert(std::is_nothrow_move_constructible_v<Result<int>>);
+
+////////////////////////////////////////////////////////////////////////////////
+
 Result<std::vector<int>> MakeVector(size_t size) {
   std::vector<int> ints;
   ints.reserve(size);
@@ -143,6 +217,15 @@ TEST_SUITE(Result) {
     //ASSERT_THROW(result.ThrowIfError(), std::system_error);
   }
 
+  SIMPLE_TEST(ToStatus) {
+    ASSERT_TRUE(fallible::ToStatus(std::error_code{}).IsOk());
+
+    auto status = fallible::ToStatus(std::make_error_code(std::errc::timed_out));
+    ASSERT_TRUE(status.Failed());
+    ASSERT_EQ(status.ErrorCode(), ErrorCodes::TimedOut);
+    ASSERT_EQ(status.Error().Domain(), "generic");
+  }
+
   SIMPLE_TEST(Ignore) {
     // No warnings here!
 
@@ -524,4 +607,145 @@ TEST_SUITE(Result) {
     ASSERT_TRUE(opt.has_value());
     ASSERT_EQ(*opt, 7);
   }
+
+  SIMPLE_TEST(NicheLayout) {
+    {
+      Handle handle{3};
+      auto result = Ok(&handle);
+      ASSERT_TRUE(result.IsOk());
+      ASSERT_EQ((*result)->fd, 3);
+
+      Result<Handle*> null = Ok<Handle*>(nullptr);
+      ASSERT_TRUE(null.IsOk());
+      ASSERT_EQ(*null, nullptr);
+
+      Result<Handle*> failed = Fail(TimedOut());
+      ASSERT_TRUE(failed.Failed());
+      ASSERT_EQ(failed.ErrorCode(), ErrorCodes::TimedOut);
+
+      failed = result;
+      ASSERT_TRUE(failed.IsOk());
+    }
+
+    {
+      auto result = Ok(std::make_unique<Handle>(Handle{7}));
+      ASSERT_EQ((*result)->fd, 7);
+
+      auto moved = std::move(result);
+      ASSERT_TRUE(moved.IsOk());
+      ASSERT_EQ((*moved)->fd, 7);
+
+      moved = Fail(fallible::errors::Cancelled());
+      ASSERT_TRUE(moved.Failed());
+      ASSERT_TRUE(moved.Error().IsCancelled());
+    }
+
+    {
+      auto result = Ok(Color::Green);
+      ASSERT_TRUE(*result == Color::Green);
+
+      Result<Color> failed = Fail(TimedOut());
+      ASSERT_TRUE(failed.Failed());
+
+      failed = Ok(Color::Red);
+      ASSERT_TRUE(failed.IsOk());
+      ASSERT_TRUE(*failed == Color::Red);
+    }
+
+    {
+      Result<int> zero = Ok(0);
+      ASSERT_TRUE(zero.IsOk());
+      ASSERT_EQ(*zero, 0);
+
+      Result<int> minus_one = Ok(-1);
+      ASSERT_TRUE(minus_one.IsOk());
+      ASSERT_EQ(*minus_one, -1);
+    }
+  }
+
+  SIMPLE_TEST(CopyAssign) {
+    Result<std::string> result = Fail(TimedOut());
+    Result<std::string> ok = Ok<std::string>("Hello");
+
+    (result = ok) = ok;
+    ASSERT_EQ(*result, "Hello");
+
+    result = MakeError();
+    ASSERT_TRUE(result.Failed());
+  }
+
+  SIMPLE_TEST(Relocate) {
+    using ResultPtr = Result<std::unique_ptr<Handle>>;
+
+    alignas(ResultPtr) std::byte from[2 * sizeof(ResultPtr)];
+    alignas(ResultPtr) std::byte to[2 * sizeof(ResultPtr)];
+
+    auto* src = reinterpret_cast<ResultPtr*>(from);
+    new (src) ResultPtr(Ok(std::make_unique<Handle>(Handle{1})));
+    new (src + 1) ResultPtr(Fail(TimedOut()));
+
+    auto* dst = reinterpret_cast<ResultPtr*>(to);
+    fallible::Relocate(src, 2, dst);
+
+    ASSERT_EQ((*dst[0])->fd, 1);
+    ASSERT_EQ(dst[1].ErrorCode(), ErrorCodes::TimedOut);
+
+    dst[0].~ResultPtr();
+    dst[1].~ResultPtr();
+  }
+
+  SIMPLE_TEST(LightweightError) {
+    using parser::ParseError;
+    using parser::ParseDigit;
+
+    {
+      auto result = ParseDigit("7").Map([](int digit) {
+        return digit * 2;
+      });
+      ASSERT_EQ(*result, 14);
+    }
+
+    {
+      auto result = ParseDigit("x");
+      ASSERT_TRUE(result.Failed());
+      ASSERT_TRUE(result.Error() == ParseError::BadChar);
+
+      auto recovered = std::move(result).Recover([](ParseError) {
+        return Result<int, ParseError>::Ok(0);
+      });
+      ASSERT_EQ(*recovered, 0);
+    }
+
+    {
+      // Widening
+      Result<int> result = ParseDigit("");
+      ASSERT_TRUE(result.Failed());
+      ASSERT_EQ(result.ErrorCode(), ErrorCodes::NotFound);
+
+      Result<int> ok = ParseDigit("3");
+      ASSERT_EQ(*ok, 3);
+    }
+
+    {
+      // Propagate
+      auto parse = [](std::string_view input) -> Result<std::string> {
+        auto digit = ParseDigit(input);
+        if (digit.Failed()) {
+          return fallible::PropagateError(digit);
+        }
+        return Ok(std::to_string(*digit));
+      };
+
+      ASSERT_EQ(*parse("5"), "5");
+      ASSERT_TRUE(parse("?").MatchErrorCode(ErrorCodes::Invalid));
+    }
+
+    {
+      // Faulty mapper with canonical error
+      auto result = ParseDigit("4").Map([](int /*digit*/) -> Result<int> {
+        return Fail(TimedOut());
+      });
+      ASSERT_EQ(result.ErrorCode(), ErrorCodes::TimedOut);
+    }
+  }
 }
@@ -0,0 +1,108 @@
+#include <fallible/context/site.hpp>
+#include <fallible/context/make.hpp>
+#include <fallible/error/make.hpp>
+
+#include <wheels/test/test_framework.hpp>
+
+#include <algorithm>
+#include <string>
+#include <string_view>
+
+using fallible::SiteId;
+using fallible::SiteInfo;
+using fallible::ErrorCodes;
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Never called, still registered at startup
+[[maybe_unused]] static fallible::Error NeverCalled() {
+  return FALLIBLE_ERR_IN("Unreachable", ErrorCodes::Internal);
+}
+
+static SiteId SameSite() {
+  return FALLIBLE_SITE("", ErrorCodes::Unknown);
+}
+
+static bool HasSite(std::string_view domain) {
+  auto sites = fallible::ListCallSites();
+  return std::any_of(sites.begin(), sites.end(), [domain](const SiteInfo& site) {
+    return site.domain == domain;
+  });
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+TEST_SUITE(Sites) {
+  SIMPLE_TEST(RegisteredAtStartup) {
+    ASSERT_TRUE(HasSite("Unreachable"));
+  }
+
+  SIMPLE_TEST(StableIds) {
+    SiteId id = SameSite();
+    ASSERT_NE(id, 0u);
+    ASSERT_EQ(SameSite(), id);
+    ASSERT_EQ(fallible::GetCallSite(id).id, id);
+  }
+
+  SIMPLE_TEST(Intern) {
+    auto here = wheels::SourceLocation::Current();
+
+    SiteId id = fallible::InternCallSite(here);
+    ASSERT_NE(id, 0u);
+    ASSERT_EQ(fallible::InternCallSite(here), id);
+
+    // Same location, dynamic strings
+    std::string file{here.File()};
+    std::string function{here.Function()};
+    ASSERT_EQ(fallible::InternCallSite(file, function, here.Line()), id);
+
+    const auto& site = fallible::GetCallSite(id);
+    ASSERT_EQ(site.line, here.Line());
+    ASSERT_EQ(site.code, fallible::CallSite::kNoCode);
+  }
+
+  SIMPLE_TEST(RemoteLocation) {
+    fallible::SourceLocation remote{std::string("remote.cpp"), "Handle", 42};
+
+    auto ctx = fallible::Ctx()
+                   .Location(remote)
+                   .Done();
+
+    auto loc = ctx.SourceLocation();
+    ASSERT_EQ(loc.File(), "remote.cpp");
+    ASSERT_EQ(loc.Function(), "Handle");
+    ASSERT_EQ(loc.Line(), 42);
+  }
+
+  SIMPLE_TEST(DynamicLocationNotInterned) {
+    size_t sites = fallible::ListCallSites().size();
+
+    for (int line = 1; line <= 3; ++line) {
+      fallible::SourceLocation where{std::string("peer.cpp"), "Serve", line};
+      auto ctx = fallible::Ctx().Location(where).Done();
+
+      ASSERT_EQ(ctx.Site(), 0u);
+      ASSERT_EQ(ctx.SourceLocation().File(), "peer.cpp");
+      ASSERT_EQ(ctx.SourceLocation().Line(), line);
+    }
+
+    ASSERT_EQ(fallible::ListCallSites().size(), sites);
+  }
+
+  SIMPLE_TEST(Unknown) {
+    const auto& site = fallible::GetCallSite(0);
+    ASSERT_EQ(site.id, 0u);
+    ASSERT_EQ(site.line, 0);
+
+    ASSERT_EQ(fallible::GetCallSite(1u << 29).id, 0u);
+  }
+
+  SIMPLE_TEST(Ctx) {
+    auto ctx = FALLIBLE_CTX().Reason("Static").Done();
+    int line = __LINE__ - 1;
+
+    ASSERT_EQ(ctx.SourceLocation().Line(), line);
+    ASSERT_EQ(fallible::GetCallSite(ctx.Site()).code,
+              fallible::CallSite::kNoCode);
+  }
+}
@@ -0,0 +1,86 @@
+#include <fallible/error/stack.hpp>
+#include <fallible/error/make.hpp>
+
+#include <wheels/test/test_framework.hpp>
+
+#include <string>
+
+using fallible::Error;
+using fallible::ErrorCodes;
+using fallible::StackTrace;
+
+////////////////////////////////////////////////////////////////////////////////
+
+__attribute__((noinline)) Error MakeInternal() {
+  return fallible::Err(ErrorCodes::Internal).Reason("Broken invariant").Done();
+}
+
+__attribute__((noinline)) Error MakeAtSite(fallible::SiteId& site) {
+  Error error = FALLIBLE_ERR(ErrorCodes::NotFound);
+  site = error.Site();
+  return error;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+TEST_SUITE(StackTrace) {
+  SIMPLE_TEST(DisabledByDefault) {
+    ASSERT_TRUE(MakeInternal().Stack().IsEmpty());
+  }
+
+  SIMPLE_TEST(ByCode) {
+    fallible::CaptureStacksForCode(ErrorCodes::Internal);
+
+    Error error = MakeInternal();
+    fallible::CaptureStacksForCode(ErrorCodes::Internal, false);
+
+    StackTrace stack = error.Stack();
+    ASSERT_FALSE(stack.IsEmpty());
+    ASSERT_TRUE(stack.Depth() > 1);
+
+    // Other codes are not affected
+    ASSERT_TRUE(fallible::Err(ErrorCodes::TimedOut).Done().Stack().IsEmpty());
+    // Disabled again
+    ASSERT_TRUE(MakeInternal().Stack().IsEmpty());
+
+    bool found = false;
+    for (const auto& frame : stack.Frames()) {
+      found |= frame.function.find("MakeInternal") != std::string::npos;
+    }
+    ASSERT_TRUE(found);
+    ASSERT_TRUE(error.Describe().find("stack trace") != std::string::npos);
+  }
+
+  SIMPLE_TEST(BySite) {
+    fallible::SiteId site = 0;
+    ASSERT_TRUE(MakeAtSite(site).Stack().IsEmpty());
+
+    fallible::CaptureStacksForSite(site);
+    Error error = MakeAtSite(site);
+    fallible::CaptureStacksForSite(site, false);
+
+    ASSERT_FALSE(error.Stack().IsEmpty());
+    ASSERT_EQ(error.Code(), ErrorCodes::NotFound);
+  }
+
+  SIMPLE_TEST(CachedSymbols) {
+    fallible::CaptureStacksForCode(ErrorCodes::Internal);
+    Error error = MakeInternal();
+    fallible::CaptureStacksForCode(ErrorCodes::Internal, false);
+
+    // Copies share symbolized frames
+    StackTrace copy = error.Stack();
+    const auto& frames = error.Stack().Frames();
+    ASSERT_EQ(&frames, &copy.Frames());
+    ASSERT_EQ(frames.size(), copy.Depth());
+  }
+
+  SIMPLE_TEST(Wrap) {
+    fallible::CaptureStacksForCode(ErrorCodes::Internal);
+    Error error = MakeInternal();
+    Error wrapped = fallible::Wrap(error).Reason("Outer").Done();
+    fallible::CaptureStacksForCode(ErrorCodes::Internal, false);
+
+    ASSERT_EQ(wrapped.Stack().Address(0), error.Stack().Address(0));
+  }
+}
@@ -0,0 +1,147 @@
+#include <fallible/telemetry/counters.hpp>
+#include <fallible/telemetry/prometheus.hpp>
+#include <fallible/result/make.hpp>
+
+#include <wheels/test/test_framework.hpp>
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using fallible::Error;
+using fallible::ErrorCodes;
+using fallible::ErrorEvent;
+using fallible::Result;
+using fallible::Status;
+
+////////////////////////////////////////////////////////////////////////////////
+
+static Status Fetch() {
+  return fallible::Fail(FALLIBLE_ERR_IN("Storage", ErrorCodes::NotFound));
+}
+
+static Status Handle() {
+  auto status = Fetch();
+  if (status.Failed()) {
+    return fallible::PropagateError(status);
+  }
+  return fallible::Ok();
+}
+
+// Enabled for the duration of a test
+struct TelemetryScope {
+  TelemetryScope() {
+    fallible::ResetErrorTelemetry();
+    fallible::EnableErrorTelemetry();
+  }
+
+  ~TelemetryScope() {
+    fallible::EnableErrorTelemetry(false);
+  }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+TEST_SUITE(Telemetry) {
+  SIMPLE_TEST(Disabled) {
+    fallible::ResetErrorTelemetry();
+
+    Handle().Ignore("Test");
+
+    auto snapshot = fallible::SnapshotErrorTelemetry();
+    ASSERT_EQ(snapshot.Total(ErrorEvent::Created), 0);
+  }
+
+  SIMPLE_TEST(Events) {
+    TelemetryScope telemetry;
+
+    for (size_t i = 0; i < 3; ++i) {
+      Handle().Ignore("Test");
+    }
+
+    auto recovered = Result<int>(Handle().Map([] {
+      return 1;
+    })).Recover([](Error) {
+      return fallible::Ok(0);
+    });
+    ASSERT_EQ(*recovered, 0);
+
+    auto snapshot = fallible::SnapshotErrorTelemetry();
+
+    ASSERT_EQ(snapshot.Total(ErrorEvent::Created), 4);
+    // PropagateError + Map
+    ASSERT_EQ(snapshot.Total(ErrorEvent::Propagated), 5);
+    ASSERT_EQ(snapshot.Total(ErrorEvent::Ignored), 3);
+    ASSERT_EQ(snapshot.Total(ErrorEvent::Recovered), 1);
+
+    ASSERT_EQ(snapshot.counters.size(), 1);
+    const auto& counter = snapshot.counters.front();
+    ASSERT_EQ(counter.code, ErrorCodes::NotFound);
+    ASSERT_EQ(counter.domain, "Storage");
+    ASSERT_EQ(fallible::GetCallSite(counter.site).function, "Fetch");
+  }
+
+  SIMPLE_TEST(StaticErrors) {
+    static const Error kQueueFull = fallible::StaticError(
+        ErrorCodes::ResourceExhausted, "Rpc", "queue full");
+
+    TelemetryScope telemetry;
+
+    for (size_t i = 0; i < 3; ++i) {
+      Status status = fallible::Fail(kQueueFull);
+      Status propagated = fallible::PropagateError(status);
+      ASSERT_TRUE(propagated.Failed());
+    }
+
+    auto snapshot = fallible::SnapshotErrorTelemetry();
+    ASSERT_EQ(snapshot.Total(ErrorEvent::Created), 3);
+    ASSERT_EQ(snapshot.Total(ErrorEvent::Propagated), 3);
+  }
+
+  SIMPLE_TEST(Threads) {
+    TelemetryScope telemetry;
+
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < 4; ++t) {
+      threads.emplace_back([] {
+        for (size_t i = 0; i < 100; ++i) {
+          Handle().Ignore("Test");
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+
+    // Shards of exited threads are kept
+    auto snapshot = fallible::SnapshotErrorTelemetry();
+    ASSERT_EQ(snapshot.Total(ErrorEvent::Created), 400);
+    ASSERT_EQ(snapshot.Total(ErrorEvent::Ignored), 400);
+  }
+
+  SIMPLE_TEST(Prometheus) {
+    TelemetryScope telemetry;
+
+    Handle().Ignore("Test");
+
+    std::string text;
+    fallible::WritePrometheus(fallible::SnapshotErrorTelemetry(), text);
+
+    ASSERT_TRUE(text.find("# TYPE fallible_errors_total counter") != std::string::npos);
+    ASSERT_TRUE(text.find("fallible_errors_total{event=\"created\",code=\"NotFound\",domain=\"Storage\",site=\"") != std::string::npos);
+    ASSERT_TRUE(text.find("event=\"ignored\"") != std::string::npos);
+
+    std::string path = "/tmp/fallible-telemetry-test.prom";
+    fallible::WritePrometheusFile(fallible::SnapshotErrorTelemetry(), path).ExpectOk();
+
+    std::ifstream file(path);
+    std::stringstream content;
+    content << file.rdbuf();
+    ASSERT_EQ(content.str(), text);
+
+    auto failed = fallible::WritePrometheusFile(fallible::SnapshotErrorTelemetry(), "/nonexistent/dir/x.prom");
+    ASSERT_TRUE(failed.Failed());
+  }
+}
@@ -0,0 +1,136 @@
+#include <fallible/error/trace.hpp>
+#include <fallible/result/make.hpp>
+
+#include <wheels/test/test_framework.hpp>
+
+#include "allocs.hpp"
+
+#include <string>
+
+using fallible::Error;
+using fallible::ErrorCodes;
+using fallible::Result;
+using fallible::Status;
+using fallible::GetReturnTrace;
+
+////////////////////////////////////////////////////////////////////////////////
+
+static Status Fail() {
+  return fallible::Fail(FALLIBLE_ERR(ErrorCodes::TimedOut));
+}
+
+static Status Middle() {
+  auto status = Fail();
+  if (!status.IsOk()) {
+    return fallible::PropagateError(status);
+  }
+  return fallible::Ok();
+}
+
+static Result<int> Top() {
+  return Middle().Map([]() {
+    return 42;
+  });
+}
+
+static Status Deep(size_t depth) {
+  if (depth == 0) {
+    return Fail();
+  }
+  auto status = Deep(depth - 1);
+  return fallible::PropagateError(status);
+}
+
+static Status DeepStatic(size_t depth) {
+  static const Error kQueueFull = fallible::StaticError(
+      ErrorCodes::ResourceExhausted, "Rpc", "queue full");
+
+  if (depth == 0) {
+    return fallible::Fail(kQueueFull);
+  }
+  auto status = DeepStatic(depth - 1);
+  return fallible::PropagateError(status);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+TEST_SUITE(ReturnTrace) {
+  SIMPLE_TEST(Hops) {
+    auto result = Top();
+    ASSERT_TRUE(result.Failed());
+
+    auto trace = GetReturnTrace(result.Error());
+    ASSERT_EQ(trace.Size(), 2);
+    ASSERT_EQ(trace.Dropped(), 0);
+    ASSERT_TRUE(std::string{trace[0].function}.find("Middle") != std::string::npos);
+    ASSERT_TRUE(std::string{trace[1].function}.find("Top") != std::string::npos);
+
+    auto site = fallible::GetCallSite(trace.Site(0));
+    ASSERT_EQ(site.line, trace[0].line);
+
+    ASSERT_TRUE(result.Error().Describe().find("return trace") != std::string::npos);
+  }
+
+  SIMPLE_TEST(Restart) {
+    auto first = Top();
+    Error second = fallible::Err(ErrorCodes::Internal).Reason("New").Done();
+
+    ASSERT_TRUE(GetReturnTrace(first.Error()).IsEmpty());
+    ASSERT_TRUE(GetReturnTrace(second).IsEmpty());
+  }
+
+  SIMPLE_TEST(Wrap) {
+    auto status = Middle();
+    Error wrapped = fallible::WrapError(status).Reason("Wrapped").Done();
+
+    auto trace = GetReturnTrace(wrapped);
+    ASSERT_EQ(trace.Size(), 2);
+    ASSERT_EQ(std::string{trace[1].file}, __FILE__);
+  }
+
+  SIMPLE_TEST(Ring) {
+    auto status = Deep(40);
+
+    auto trace = GetReturnTrace(status.Error());
+    ASSERT_EQ(trace.Size(), fallible::ReturnTrace::kCapacity);
+    ASSERT_EQ(trace.Dropped(), 40 - fallible::ReturnTrace::kCapacity);
+  }
+
+  SIMPLE_TEST(StaticErrors) {
+    // Same error word, independent failures
+    ASSERT_TRUE(DeepStatic(5).Failed());
+    auto status = DeepStatic(3);
+
+    auto trace = GetReturnTrace(status.Error());
+    ASSERT_EQ(trace.Size(), 3);
+    ASSERT_EQ(trace.Dropped(), 0);
+  }
+
+  SIMPLE_TEST(AmbiguousCodeOnly) {
+    Status first = Middle();
+    // Same code and site: the same word as `first`
+    Status second = Fail();
+    ASSERT_TRUE(first.Error() == second.Error());
+
+    // Hops of `first` can not be told apart from hops of `second`
+    Status propagated = fallible::PropagateError(first);
+    ASSERT_TRUE(GetReturnTrace(propagated.Error()).IsEmpty());
+    ASSERT_TRUE(GetReturnTrace(second.Error()).IsEmpty());
+
+    // Distinct error starts an unambiguous trace
+    Error distinct = fallible::Err(ErrorCodes::Internal).Reason("Distinct").Done();
+    auto status = Deep(2);
+    ASSERT_EQ(GetReturnTrace(status.Error()).Size(), 2);
+  }
+
+  SIMPLE_TEST(NoAllocations) {
+    ASSERT_TRUE(Deep(8).Failed());  // Warm up interned sites
+    // Equal code-only errors would make the trace ambiguous
+    Error other = fallible::Err(ErrorCodes::Internal).Reason("Other").Done();
+
+    AllocationCounter allocs;
+    auto status = Deep(8);
+    ASSERT_EQ(allocs.Count(), 0);
+    ASSERT_EQ(GetReturnTrace(status.Error()).Size(), 8);
+  }
+}
@@ -0,0 +1,172 @@
+#include <fallible/wire/codec.hpp>
+#include <fallible/error/stack.hpp>
+#include <fallible/result/make.hpp>
+#include <fallible/telemetry/counters.hpp>
+
+#include <wheels/test/test_framework.hpp>
+
+#include <chrono>
+#include <string>
+
+using fallible::Error;
+using fallible::ErrorCodes;
+using fallible::ErrorEvent;
+using fallible::SharedString;
+
+using namespace std::chrono_literals;
+
+////////////////////////////////////////////////////////////////////////////////
+
+static bool Within(std::string_view view, const SharedString& buffer) {
+  std::string_view bytes = buffer.View();
+  return view.data() >= bytes.data() &&
+         view.data() + view.size() <= bytes.data() + bytes.size();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+TEST_SUITE(Wire) {
+  SIMPLE_TEST(Roundtrip) {
+    Error error = fallible::Err(ErrorCodes::NotFound)
+                      .Domain("Storage")
+                      .Reason("Key {} not found", 42)
+                      .Attr("path", "/tmp/data")
+                      .Attr("shard", 17)
+                      .Attr("offset", 5u)
+                      .Attr("ratio", 0.5)
+                      .Attr("elapsed", 150ms)
+                      .Attr("digest", fallible::Blob{"\x0a\x1b"})
+                      .Attr("retry", true)
+                      .Done();
+
+    auto decoded = fallible::DecodeError(fallible::EncodeError(error));
+    ASSERT_TRUE(decoded.IsOk());
+
+    ASSERT_EQ(decoded->Code(), ErrorCodes::NotFound);
+    ASSERT_EQ(decoded->Domain(), "Storage");
+    ASSERT_EQ(decoded->Reason(), "Key 42 not found");
+    ASSERT_EQ(decoded->SourceLocation().Line(), error.SourceLocation().Line());
+    ASSERT_EQ(std::string{decoded->SourceLocation().File()},
+              std::string{error.SourceLocation().File()});
+
+    const auto& attrs = decoded->Attrs();
+    ASSERT_EQ(*attrs.Find("path")->AsString(), "/tmp/data");
+    ASSERT_EQ(*attrs.Find("shard")->AsInt(), 17);
+    ASSERT_EQ(*attrs.Find("offset")->AsUInt(), 5u);
+    ASSERT_EQ(*attrs.Find("ratio")->AsDouble(), 0.5);
+    ASSERT_EQ(*attrs.Find("elapsed")->AsDuration(), 150ms);
+    ASSERT_EQ(*attrs.Find("digest")->AsBlob(), "\x0a\x1b");
+    ASSERT_EQ(*attrs.Find("retry")->AsBool(), true);
+
+    // Formatted reasons keep their template
+    ASSERT_EQ(*decoded, error);
+    ASSERT_EQ(decoded->Fingerprint(), error.Fingerprint());
+    ASSERT_EQ(fallible::EncodeError(*decoded), fallible::EncodeError(error));
+  }
+
+  SIMPLE_TEST(Nested) {
+    Error cause = fallible::Err(ErrorCodes::Unavailable).Domain("Net").Done();
+    Error error = fallible::Wrap(cause).Reason("Fetch failed").Done();
+
+    Error group = fallible::Err(ErrorCodes::Internal)
+                      .AddSubError(error)
+                      .AddSubError(fallible::Err(ErrorCodes::Cancelled).Done())
+                      .Done();
+
+    auto decoded = fallible::DecodeError(fallible::EncodeError(group));
+    ASSERT_TRUE(decoded.IsOk());
+
+    auto sub_errors = decoded->SubErrors();
+    ASSERT_EQ(sub_errors.size(), 2);
+    ASSERT_EQ(sub_errors[0].Code(), ErrorCodes::Unavailable);
+    ASSERT_EQ(sub_errors[0].Reason(), "Fetch failed");
+    ASSERT_TRUE(sub_errors[0].Cause() != nullptr);
+    ASSERT_EQ(sub_errors[0].Cause()->Domain(), "Net");
+    ASSERT_EQ(sub_errors[1].Code(), ErrorCodes::Cancelled);
+
+    ASSERT_EQ(*decoded, group);
+  }
+
+  SIMPLE_TEST(ZeroCopy) {
+    Error error = fallible::Err(ErrorCodes::Invalid)
+                      .Domain("Parser")
+                      .Attr("input", "some long user input")
+                      .Done();
+
+    std::string bytes = fallible::EncodeError(error);
+    auto buffer = SharedString::Allocate(bytes.size());
+    bytes.copy(buffer.MutableData(), bytes.size());
+
+    auto decoded = fallible::DecodeError(buffer);
+    ASSERT_TRUE(decoded.IsOk());
+
+    ASSERT_TRUE(Within(*decoded->Attrs().Find("input")->AsString(), buffer));
+    ASSERT_TRUE(Within(decoded->Attrs().begin()->key.Name(), buffer));
+    ASSERT_TRUE(Within(decoded->SourceLocation().File(), buffer));
+  }
+
+  SIMPLE_TEST(RemoteSitesNotRegistered) {
+    Error error = fallible::Err(ErrorCodes::Internal).Attr("peer_only_key", 1).Done();
+    std::string bytes = fallible::EncodeError(error);
+
+    size_t sites = fallible::ListCallSites().size();
+
+    for (size_t i = 0; i < 10; ++i) {
+      auto decoded = fallible::DecodeError(bytes);
+      ASSERT_TRUE(decoded.IsOk());
+      ASSERT_EQ(decoded->Site(), 0u);
+      ASSERT_EQ(decoded->SourceLocation().Line(), error.SourceLocation().Line());
+      ASSERT_EQ(*decoded, error);
+      ASSERT_EQ(decoded->Fingerprint(), error.Fingerprint());
+    }
+
+    ASSERT_EQ(fallible::ListCallSites().size(), sites);
+  }
+
+  SIMPLE_TEST(NotLocalFailures) {
+    Error error = fallible::Err(ErrorCodes::Aborted)
+                      .Domain("Txn")
+                      .Reason("Conflict")
+                      .Done();
+    std::string bytes = fallible::EncodeError(error);
+
+    fallible::CaptureStacksForCode(ErrorCodes::Aborted);
+    fallible::ResetErrorTelemetry();
+    fallible::EnableErrorTelemetry();
+
+    auto decoded = fallible::DecodeError(bytes);
+
+    auto snapshot = fallible::SnapshotErrorTelemetry();
+    fallible::EnableErrorTelemetry(false);
+    fallible::CaptureStacksForCode(ErrorCodes::Aborted, /*enable=*/false);
+
+    ASSERT_TRUE(decoded.IsOk());
+    ASSERT_EQ(*decoded, error);
+    ASSERT_TRUE(decoded->Stack().IsEmpty());
+    ASSERT_EQ(snapshot.Total(ErrorEvent::Created), 0);
+  }
+
+  SIMPLE_TEST(Corrupted) {
+    Error error = fallible::Err(ErrorCodes::NotFound)
+                      .Domain("Storage")
+                      .Reason("Missing")
+                      .Attr("key", 7)
+                      .Done();
+
+    std::string bytes = fallible::EncodeError(error);
+
+    // Every truncation is rejected
+    for (size_t size = 0; size < bytes.size(); ++size) {
+      auto decoded = fallible::DecodeError(std::string_view{bytes}.substr(0, size));
+      ASSERT_TRUE(decoded.Failed());
+      ASSERT_EQ(decoded.Error().Code(), ErrorCodes::Invalid);
+    }
+
+    // Trailing garbage
+    ASSERT_TRUE(fallible::DecodeError(bytes + "x").Failed());
+
+    // Unknown version
+    bytes[0] = 7;
+    ASSERT_TRUE(fallible::DecodeError(bytes).Failed());
+  }
+}
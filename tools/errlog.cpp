@@ -0,0 +1,181 @@
+#include <fallible/log/index.hpp>
+
+#include <fallible/error/codes.hpp>
+
+#include <charconv>
+#include <chrono>
+#include <ctime>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+// Usage:
+//   fallible-errlog index <log>
+//   fallible-errlog query <log> [--code <name|number>] [--domain <domain>]
+//                               [--site <file:line>] [--attr <key[=value]>]...
+//                               [--since <duration>] [--until <duration>]
+//                               [--limit <n>] [--count]
+// Durations are relative to now: 90s, 15m, 1h, 2d
+
+namespace {
+
+int Usage(const char* argv0) {
+  std::cerr << "Usage:\n"
+            << "  " << argv0 << " index <log>\n"
+            << "  " << argv0 << " query <log> [--code <name|number>] [--domain <domain>]\n"
+            << "      [--site <file:line>] [--attr <key[=value]>]...\n"
+            << "      [--since <duration>] [--until <duration>] [--limit <n>] [--count]\n";
+  return 2;
+}
+
+std::optional<uint64_t> ParseNumber(std::string_view str) {
+  uint64_t value;
+  auto [end, ec] = std::from_chars(str.data(), str.data() + str.size(), value);
+  if (ec != std::errc{} || end != str.data() + str.size()) {
+    return std::nullopt;
+  }
+  return value;
+}
+
+std::optional<int32_t> ParseCode(std::string_view str) {
+  if (auto number = ParseNumber(str)) {
+    return static_cast<int32_t>(*number);
+  }
+  return fallible::FindErrorCode(str);
+}
+
+// `15m` before now, since epoch
+std::optional<uint64_t> ParseAgo(std::string_view str) {
+  if (str.empty()) {
+    return std::nullopt;
+  }
+  auto count = ParseNumber(str.substr(0, str.size() - 1));
+  if (!count) {
+    return std::nullopt;
+  }
+
+  std::chrono::seconds unit;
+  switch (str.back()) {
+    case 's':
+      unit = std::chrono::seconds{1};
+      break;
+    case 'm':
+      unit = std::chrono::minutes{1};
+      break;
+    case 'h':
+      unit = std::chrono::hours{1};
+      break;
+    case 'd':
+      unit = std::chrono::hours{24};
+      break;
+    default:
+      return std::nullopt;
+  }
+
+  auto now = std::chrono::system_clock::now().time_since_epoch();
+  auto ago = now - unit * static_cast<int64_t>(*count);
+  return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(ago).count());
+}
+
+std::string FormatTime(uint64_t time_ns) {
+  auto seconds = static_cast<std::time_t>(time_ns / 1'000'000'000);
+  std::tm tm;
+  ::gmtime_r(&seconds, &tm);
+  char buf[32];
+  std::strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%S", &tm);
+
+  char millis[8];
+  std::snprintf(millis, sizeof(millis), ".%03uZ",
+                static_cast<unsigned>(time_ns / 1'000'000 % 1000));
+  return std::string{buf} + millis;
+}
+
+int Index(const std::string& path) {
+  auto status = fallible::BuildErrorLogIndex(path);
+  if (status.Failed()) {
+    std::cerr << "Cannot index " << path << ": " << status.Error().Describe() << std::endl;
+    return 1;
+  }
+  return 0;
+}
+
+int Query(int argc, char* argv[]) {
+  std::string path = argv[2];
+  fallible::ErrorLogQuery query;
+  bool count_only = false;
+
+  for (int i = 3; i < argc; ++i) {
+    std::string_view flag = argv[i];
+    if (flag == "--count") {
+      count_only = true;
+      continue;
+    }
+    if (i + 1 == argc) {
+      return Usage(argv[0]);
+    }
+    std::string_view value = argv[++i];
+
+    if (flag == "--code") {
+      query.code = ParseCode(value);
+      if (!query.code) {
+        std::cerr << "Unknown error code: " << value << std::endl;
+        return 2;
+      }
+    } else if (flag == "--domain") {
+      query.domain = std::string{value};
+    } else if (flag == "--site") {
+      query.site = std::string{value};
+    } else if (flag == "--attr") {
+      query.attrs.emplace_back(value);
+    } else if (flag == "--since" || flag == "--until") {
+      auto time = ParseAgo(value);
+      if (!time) {
+        std::cerr << "Invalid duration: " << value << std::endl;
+        return 2;
+      }
+      (flag == "--since" ? query.since_ns : query.until_ns) = time;
+    } else if (flag == "--limit") {
+      auto limit = ParseNumber(value);
+      if (!limit) {
+        return Usage(argv[0]);
+      }
+      query.limit = *limit;
+    } else {
+      return Usage(argv[0]);
+    }
+  }
+
+  auto matches = fallible::QueryErrorLog(path, query);
+  if (matches.Failed()) {
+    std::cerr << "Cannot query " << path << ": " << matches.Error().Describe() << std::endl;
+    return 1;
+  }
+
+  if (count_only) {
+    std::cout << matches->size() << std::endl;
+    return 0;
+  }
+
+  for (const auto& match : *matches) {
+    std::cout << FormatTime(match.time_ns) << " @" << match.offset << "\n"
+              << match.error.Describe() << "\n\n";
+  }
+  return 0;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  if (argc < 3) {
+    return Usage(argv[0]);
+  }
+
+  std::string_view command = argv[1];
+  if (command == "index" && argc == 3) {
+    return Index(argv[2]);
+  }
+  if (command == "query") {
+    return Query(argc, argv);
+  }
+  return Usage(argv[0]);
+}
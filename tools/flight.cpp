@@ -0,0 +1,21 @@
+#include <fallible/telemetry/flight.hpp>
+
+#include <iostream>
+
+// Usage: fallible-flight <path>
+
+int main(int argc, char* argv[]) {
+  if (argc != 2) {
+    std::cerr << "Usage: " << argv[0] << " <flight recorder file>" << std::endl;
+    return 2;
+  }
+
+  auto log = fallible::ReadFlightLog(argv[1]);
+  if (log.Failed()) {
+    std::cerr << "Cannot decode " << argv[1] << ": " << log.Error().Describe() << std::endl;
+    return 1;
+  }
+
+  std::cout << fallible::Describe(*log);
+  return 0;
+}